@@ -35,37 +35,38 @@ ConfigurationTreeNode *
 ConfigurationTree::FindNode(const char *name)
 {
   ConfigurationTreeNode *node = &node_array[0];
-  while (true)
+  
+  // each name segment is resolved directly against the parent's children 
+  // rather than by iterating through each child in turn
+  while ((uint8_t*)node < (uint8_t*)node_array + sizeof(node_array) - sizeof(ConfigurationTreeNode))
   {
-    ConfigurationTreeNode *child = GetFirstChild(node);
-    while (child != 0)
+    ConfigurationTreeNode *child = node + 1;
+    const int8_t child_name_length = node->FindChild(name, *child);
+    if (child_name_length <= 0)
+      return 0;
+    if (name[child_name_length] == '\0')
     {
-      int8_t child_name_length = child->CompareName(name);
-      if (child_name_length > 0)
-      {
-        if (name[child_name_length] == '\0')
-        {
-          // found a match but just to be safe, clear child of match
-          // in case its not a leaf node
-          node = child;
-          child = node + 1;
-          if ((uint8_t*)node < (uint8_t*)node_array + sizeof(node_array))
-            child->Clear();
-          return node;
-        }
-        else if (name[child_name_length] == '.')
-        {
-          name += (child_name_length + 1);
-          node = child;
-          break;
-        }
-      }
-      child = GetNextChild(node);
+      // found a match but just to be safe, clear child of match
+      // in case its not a leaf node
+      if ((uint8_t*)child < (uint8_t*)node_array + sizeof(node_array) - sizeof(ConfigurationTreeNode))
+        (child + 1)->Clear();
+      return child;
     }
-    if (child == 0)
-      return 0;
+    name += (child_name_length + 1);
     node = child;
   }
+  return 0;
+}
+
+// Locates a leaf node directly by type (as used by numeric configuration handles).
+// Note: the returned node has no valid parent node.
+ConfigurationTreeNode *
+ConfigurationTree::FindLeafNode(uint8_t node_type)
+{
+  ConfigurationTreeNode *node = &node_array[1];
+  if (!node->InitializeLeafNode(node_type))
+    return 0;
+  return node;
 }
 
 ConfigurationTreeNode *
@@ -122,6 +123,41 @@ ConfigurationTree::FindNextLeafNode(const ConfigurationTreeNode *search_root_nod
 }
 
 
+// Stores the position of node in buffer and returns the length of the cursor 
+// (or 0 if the buffer is too small)
+uint8_t 
+ConfigurationTree::GetCursor(const ConfigurationTreeNode *node, uint8_t *buffer, uint8_t length) const
+{
+  uint8_t used = 0;
+  for (const ConfigurationTreeNode *level = &node_array[1]; level <= node; level++)
+  {
+    if (used + 2 > length)
+      return 0;
+    buffer[used++] = level->GetNodeType();
+    buffer[used++] = level->GetInstanceId();
+  }
+  return used;
+}
+
+// Restores the position stored in a cursor and returns the node (or 0 if 
+// the cursor is not valid)
+ConfigurationTreeNode *
+ConfigurationTree::SetCursor(const uint8_t *cursor, uint8_t length)
+{
+  if (length == 0 || (length & 1) != 0 || length > MAX_CONFIGURATION_TREE_CURSOR_LENGTH)
+    return 0;
+  ConfigurationTreeNode *node = &node_array[0];
+  for (uint8_t i = 0; i < length; i += 2)
+  {
+    if (!node->InitializeChild(cursor[i], cursor[i+1], *(node + 1)))
+      return 0;
+    node += 1;
+  }
+  if ((uint8_t*)node < (uint8_t*)node_array + sizeof(node_array) - sizeof(ConfigurationTreeNode))
+    (node + 1)->Clear();
+  return node;
+}
+
 ConfigurationTreeNode *
 ConfigurationTree::GetParentNode(const ConfigurationTreeNode *node) const
 {
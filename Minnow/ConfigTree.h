@@ -29,6 +29,9 @@
 // e.g., "devices.foo.0.bar.5.name" is 6 levels deep.
 #define MAX_CONFIGURATION_TREE_DEPTH          8
 
+// A traversal cursor holds the node type and instance id of each level
+#define MAX_CONFIGURATION_TREE_CURSOR_LENGTH  (2 * MAX_CONFIGURATION_TREE_DEPTH)
+
 //
 // Configuration Matching Tree class
 //
@@ -42,9 +45,14 @@ public:
   ConfigurationTree();
 
   ConfigurationTreeNode *FindNode(const char *name);
+  ConfigurationTreeNode *FindLeafNode(uint8_t node_type);
   ConfigurationTreeNode *FindFirstLeafNode(const ConfigurationTreeNode *search_root_node);
   ConfigurationTreeNode *FindNextLeafNode(const ConfigurationTreeNode *search_root_node);
 
+  // Cursors allow a traversal from the root node to be resumed later
+  uint8_t GetCursor(const ConfigurationTreeNode *node, uint8_t *buffer, uint8_t length) const;
+  ConfigurationTreeNode *SetCursor(const uint8_t *cursor, uint8_t length);
+
   ConfigurationTreeNode *GetRootNode() { return &node_array[0]; };
 
   ConfigurationTreeNode *GetParentNode(const ConfigurationTreeNode *node) const;
@@ -35,6 +35,7 @@
 
 #include <avr/pgmspace.h>
 #include "language.h"
+#include "ConfigTreeSchema.h"
 
 //
 // Internal Configuration Structures (defines tree structure)
@@ -50,389 +51,130 @@ struct ConfigNodeInfo
   uint8_t leaf_node_class;
   uint8_t leaf_operations; 
   uint8_t leaf_datatype; // the datatype is only needed for writable leaf nodes, or the device_type for non-leaf nodes.
+  config_accessor_type leaf_setter; // or 0 if the value is set explicitly
+  config_accessor_type leaf_getter; // or 0 if the value is read explicitly
 };
 
 typedef uint8_t (*num_children_functor_type)();
 
 
 // Initializer macro for named non-leaf nodes with named children
-#define GROUP_NODE(node_type) \
-    { node_type, name_of_##node_type, children_of_##node_type, NODE_TYPE_INVALID, \
-      (num_children_functor_type)sizeof(children_of_##node_type), LEAF_CLASS_INVALID, \
-      LEAF_OPERATIONS_INVALID, PM_DEVICE_TYPE_INVALID }
+#define GROUP_NODE(node_type, name, children) \
+    { node_type, name, children, NODE_TYPE_INVALID, \
+      (num_children_functor_type)sizeof(children), LEAF_CLASS_INVALID, \
+      LEAF_OPERATIONS_INVALID, PM_DEVICE_TYPE_INVALID, 0, 0 }
 
 // Initializer macro for unnamed non-leaf nodes with named children
-#define UNNAMED_GROUP_NODE(node_type, device_type) \
-    { node_type, 0, children_of_##node_type, NODE_TYPE_INVALID, \
-      (num_children_functor_type)sizeof(children_of_##node_type), LEAF_CLASS_INVALID, \
-      LEAF_OPERATIONS_INVALID, device_type }
+#define UNNAMED_GROUP_NODE(node_type, children, device_type) \
+    { node_type, 0, children, NODE_TYPE_INVALID, \
+      (num_children_functor_type)sizeof(children), LEAF_CLASS_INVALID, \
+      LEAF_OPERATIONS_INVALID, device_type, 0, 0 }
 
 // Initializer macro for named non-leaf nodes with instance children
-#define INSTANCE_PARENT_NODE(node_type, child_type, num_children_functor) \
-    { node_type, name_of_##node_type, 0, child_type, num_children_functor, \
-      LEAF_CLASS_INVALID, LEAF_OPERATIONS_INVALID, PM_DEVICE_TYPE_INVALID }
+#define INSTANCE_PARENT_NODE(node_type, name, child_type, num_children_functor) \
+    { node_type, name, 0, child_type, num_children_functor, \
+      LEAF_CLASS_INVALID, LEAF_OPERATIONS_INVALID, PM_DEVICE_TYPE_INVALID, 0, 0 }
 
 // Initializer macro for leaf nodes
-#define LEAF_NODE(node_type, leaf_node_class, operations, data_type) \
-    { node_type, name_of_##node_type, 0, NODE_TYPE_INVALID, 0, \
-      leaf_node_class, operations, data_type }
+#define LEAF_NODE(node_type, name, leaf_node_class, operations, data_type, setter, getter) \
+    { node_type, name, 0, NODE_TYPE_INVALID, 0, \
+      leaf_node_class, operations, data_type, setter, getter }
 
-// Configuration node names
-PROGMEM static const char pstr_PIN[] = CONFIG_STR(PIN);
-PROGMEM static const char pstr_NAME[] = CONFIG_STR(NAME);
-PROGMEM static const char pstr_TYPE[] = CONFIG_STR(TYPE);
-PROGMEM static const char pstr_USE_SOFT_PWM[] = CONFIG_STR(USE_SOFT_PWM);
+// Converts a schema accessor to the generic type (after checking its signature)
+#define LEAF_ACCESSOR(accessor_type, accessor) \
+    ((config_accessor_type)static_cast<accessor_type>(accessor))
+
+//
+// Generators for the schema lists in ConfigTreeSchema.h
+//
+
+#define SCHEMA_NAME_STRING(name) \
+    PROGMEM static const char pstr_##name[] = CONFIG_STR(name);
+
+#define SCHEMA_CHILD_TYPE(node_type, ...) \
+    node_type,
+
+#define SCHEMA_GROUP_CHILDREN(node_type, name, children) \
+    PROGMEM static const uint8_t children_of_##node_type[] = { children(SCHEMA_CHILD_TYPE) };
+
+#define SCHEMA_INSTANCE_CHILDREN(node_type, instance_node_type, name, device_type, num_devices, leaves, extended_leaves) \
+    PROGMEM static const uint8_t children_of_##instance_node_type[] = \
+        { leaves(SCHEMA_CHILD_TYPE) extended_leaves(SCHEMA_CHILD_TYPE) };
+
+#define SCHEMA_DEVICE_INSTANCE_TYPE(node_type, instance_node_type, ...) \
+    instance_node_type,
+
+#define SCHEMA_GROUP_NODE(node_type, name, children) \
+    GROUP_NODE(node_type, pstr_##name, children_of_##node_type),
+
+#define SCHEMA_INSTANCE_PARENT_NODE(node_type, instance_node_type, name, device_type, num_devices, leaves, extended_leaves) \
+    INSTANCE_PARENT_NODE(node_type, pstr_##name, instance_node_type, num_devices),
+
+#define SCHEMA_INSTANCE_NODE(node_type, instance_node_type, name, device_type, num_devices, leaves, extended_leaves) \
+    UNNAMED_GROUP_NODE(instance_node_type, children_of_##instance_node_type, device_type),
+
+#define SCHEMA_LEAF_NODE(node_type, name, leaf_class, operations, datatype, setter, getter) \
+    LEAF_NODE(node_type, pstr_##name, leaf_class, operations, LEAF_SET_DATATYPE_##datatype, \
+        LEAF_ACCESSOR(config_##datatype##_setter_type, setter), \
+        LEAF_ACCESSOR(config_##datatype##_getter_type, getter)),
+
+#define SCHEMA_DEVICE_LEAF_NODES(node_type, instance_node_type, name, device_type, num_devices, leaves, extended_leaves) \
+    leaves(SCHEMA_LEAF_NODE)
 
+#define SCHEMA_DEVICE_EXTENDED_LEAF_NODES(node_type, instance_node_type, name, device_type, num_devices, leaves, extended_leaves) \
+    extended_leaves(SCHEMA_LEAF_NODE)
+
+// Configuration node names
 PROGMEM static const char name_of_NODE_TYPE_CONFIG_ROOT[] = "";
-PROGMEM static const char name_of_NODE_TYPE_GROUP_SYSTEM[] = CONFIG_STR(SYSTEM);
-PROGMEM static const char name_of_NODE_TYPE_GROUP_DEVICES[] = CONFIG_STR(DEVICES);
-PROGMEM static const char name_of_NODE_TYPE_GROUP_STATISTICS[] = CONFIG_STR(STATS);
-PROGMEM static const char name_of_NODE_TYPE_GROUP_DEBUG[] = CONFIG_STR(DEBUG);
-
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_NAME[] = CONFIG_STR(HARDWARE_NAME);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_TYPE[] = CONFIG_STR(HARDWARE_TYPE);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_REV[] = CONFIG_STR(HARDWARE_REV);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_BOARD_IDENTITY[] = CONFIG_STR(BOARD_IDENTITY);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_BOARD_SERIAL_NUM[] = CONFIG_STR(BOARD_SERIAL_NUM);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_INPUT_SWITCHES[] = CONFIG_STR(NUM_DIGITAL_INPUTS);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_OUTPUT_SWITCHES[] = CONFIG_STR(NUM_DIGITAL_OUTPUTS);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_PWM_OUTPUTS[] = CONFIG_STR(NUM_PWM_OUTPUTS);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_TEMP_SENSORS[] = CONFIG_STR(NUM_TEMP_SENSORS);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_BUZZERS[] = CONFIG_STR(NUM_BUZZERS);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_HEATERS[] = CONFIG_STR(NUM_HEATERS);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_STEPPERS[] = CONFIG_STR(NUM_STEPPERS);
-
-PROGMEM static const char name_of_NODE_TYPE_STATS_LEAF_RX_PACKET_COUNT[] = CONFIG_STR(RX_COUNT);
-PROGMEM static const char name_of_NODE_TYPE_STATS_LEAF_RX_ERROR_COUNT[] = CONFIG_STR(RX_ERROR);
-PROGMEM static const char name_of_NODE_TYPE_STATS_LEAF_QUEUE_MEMORY[] = CONFIG_STR(QUEUE_MEMORY);
-
-PROGMEM static const char name_of_NODE_TYPE_DEBUG_LEAF_STACK_MEMORY[] = CONFIG_STR(STACK_MEMORY);
-PROGMEM static const char name_of_NODE_TYPE_DEBUG_LEAF_STACK_LOW_WATER_MARK[] = CONFIG_STR(STACK_LOW_WATER_MARK);
-
-PROGMEM static const char name_of_NODE_TYPE_OPERATION_LEAF_RESET_EEPROM[] = CONFIG_STR(RESET_EEPROM);
-
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_DEVICE_INPUT_SWITCHES[] = CONFIG_STR(DIGITAL_INPUT);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_DEVICE_OUTPUT_SWITCHES[] = CONFIG_STR(DIGITAL_OUTPUT);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_DEVICE_PWM_OUTPUTS[] = CONFIG_STR(PWM_OUTPUT);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_DEVICE_BUZZERS[] = CONFIG_STR(BUZZER);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_DEVICE_TEMP_SENSORS[] = CONFIG_STR(TEMP_SENSOR);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_DEVICE_HEATERS[] = CONFIG_STR(HEATER);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_DEVICE_STEPPERS[] = CONFIG_STR(STEPPER);
-
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_TRIGGER_LEVEL[] = CONFIG_STR(TRIGGER_LEVEL);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_ENABLE_PULLUP[] = CONFIG_STR(ENABLE_PULLUP);
-
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_INITIAL_STATE[] = CONFIG_STR(INITIAL_STATE);
-
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_TEMP_SENSOR[] = CONFIG_STR(TEMP_SENSOR);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_MAX_TEMP[] = CONFIG_STR(MAX_TEMP);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_POWER_ON_LEVEL[] = CONFIG_STR(POWER_ON_LEVEL);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_USE_BANG_BANG[] = CONFIG_STR(USE_BANG_BANG);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_USE_PID[] = CONFIG_STR(USE_PID);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_BANG_BANG_HYSTERESIS[] = CONFIG_STR(BANG_BANG_HYSTERESIS);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_PID_FUNCTIONAL_RANGE[] = CONFIG_STR(PID_RANGE);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_PID_KP[] = CONFIG_STR(PID_KP);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_PID_KI[] = CONFIG_STR(PID_KI);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_PID_KD[] = CONFIG_STR(PID_KD);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_HEATER_PID_DO_AUTOTUNE[] = CONFIG_STR(PID_DO_AUTOTUNE);
-
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_PIN[] = CONFIG_STR(ENABLE_PIN);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_INVERT[] = CONFIG_STR(ENABLE_INVERT);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_PIN[] = CONFIG_STR(DIRECTION_PIN);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_INVERT[] = CONFIG_STR(DIRECTION_INVERT);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_PIN[] = CONFIG_STR(STEP_PIN);
-PROGMEM static const char name_of_NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_INVERT[] = CONFIG_STR(STEP_INVERT);
-
-// ALIASES to generic attribute names
-#define name_of_NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_FRIENDLY_NAME pstr_NAME
-#define name_of_NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_PIN pstr_PIN
-#define name_of_NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_FRIENDLY_NAME pstr_NAME
-#define name_of_NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_PIN pstr_PIN
-#define name_of_NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_FRIENDLY_NAME pstr_NAME
-#define name_of_NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_PIN pstr_PIN
-#define name_of_NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_USE_SOFT_PWM pstr_USE_SOFT_PWM
-#define name_of_NODE_TYPE_CONFIG_LEAF_BUZZER_FRIENDLY_NAME pstr_NAME
-#define name_of_NODE_TYPE_CONFIG_LEAF_BUZZER_PIN pstr_PIN
-#define name_of_NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_FRIENDLY_NAME pstr_NAME
-#define name_of_NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_PIN pstr_PIN
-#define name_of_NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_TYPE pstr_TYPE
-#define name_of_NODE_TYPE_CONFIG_LEAF_HEATER_FRIENDLY_NAME pstr_NAME
-#define name_of_NODE_TYPE_CONFIG_LEAF_HEATER_PIN pstr_PIN
-#define name_of_NODE_TYPE_CONFIG_LEAF_HEATER_USE_SOFT_PWM pstr_USE_SOFT_PWM
-#define name_of_NODE_TYPE_CONFIG_LEAF_STEPPER_FRIENDLY_NAME pstr_NAME
+CONFIG_SCHEMA_NAMES(SCHEMA_NAME_STRING)
 
 // Arrays of named children
 PROGMEM static const uint8_t children_of_NODE_TYPE_CONFIG_ROOT[] = 
 {
-  NODE_TYPE_GROUP_SYSTEM,
-  NODE_TYPE_GROUP_DEVICES,
-  NODE_TYPE_GROUP_STATISTICS,
-  NODE_TYPE_GROUP_DEBUG
+  CONFIG_SCHEMA_GROUPS(SCHEMA_CHILD_TYPE)
 };
+CONFIG_SCHEMA_GROUPS(SCHEMA_GROUP_CHILDREN)
+CONFIG_SCHEMA_DEVICES(SCHEMA_INSTANCE_CHILDREN)
 
-PROGMEM static const uint8_t children_of_NODE_TYPE_GROUP_SYSTEM[] = 
-{
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_NAME,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_TYPE,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_REV,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_BOARD_IDENTITY,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_BOARD_SERIAL_NUM,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_INPUT_SWITCHES,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_OUTPUT_SWITCHES,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_PWM_OUTPUTS,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_BUZZERS,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_TEMP_SENSORS,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_HEATERS,
-  NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_STEPPERS,
-  NODE_TYPE_OPERATION_LEAF_RESET_EEPROM
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_GROUP_DEVICES[] = 
-{
-  NODE_TYPE_CONFIG_DEVICE_INPUT_SWITCHES,
-  NODE_TYPE_CONFIG_DEVICE_OUTPUT_SWITCHES,
-  NODE_TYPE_CONFIG_DEVICE_PWM_OUTPUTS,
-  NODE_TYPE_CONFIG_DEVICE_BUZZERS,
-  NODE_TYPE_CONFIG_DEVICE_TEMP_SENSORS,
-  NODE_TYPE_CONFIG_DEVICE_HEATERS,
-  NODE_TYPE_CONFIG_DEVICE_STEPPERS
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_GROUP_STATISTICS[] = 
-{
-  NODE_TYPE_STATS_LEAF_RX_PACKET_COUNT,
-  NODE_TYPE_STATS_LEAF_RX_ERROR_COUNT,
-  NODE_TYPE_STATS_LEAF_QUEUE_MEMORY
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_GROUP_DEBUG[] = 
-{
-  NODE_TYPE_DEBUG_LEAF_STACK_MEMORY,
-  NODE_TYPE_DEBUG_LEAF_STACK_LOW_WATER_MARK
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_CONFIG_DEVICE_INSTANCE_INPUT_SWITCH[] = 
-{
-  NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_FRIENDLY_NAME,
-  NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_PIN,
-  NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_TRIGGER_LEVEL,
-  NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_ENABLE_PULLUP
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_CONFIG_DEVICE_INSTANCE_OUTPUT_SWITCH[] = 
-{
-  NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_FRIENDLY_NAME,
-  NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_PIN,
-  NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_INITIAL_STATE
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_CONFIG_DEVICE_INSTANCE_PWM_OUTPUT[] = 
+// Device instance node types (for finding the device which contains a leaf)
+PROGMEM static const uint8_t device_instance_node_types[] = 
 {
-  NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_FRIENDLY_NAME,
-  NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_PIN,
-  NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_USE_SOFT_PWM
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_CONFIG_DEVICE_INSTANCE_BUZZER[] = 
-{
-  NODE_TYPE_CONFIG_LEAF_BUZZER_FRIENDLY_NAME,
-  NODE_TYPE_CONFIG_LEAF_BUZZER_PIN
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_CONFIG_DEVICE_INSTANCE_TEMP_SENSOR[] = 
-{
-  NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_FRIENDLY_NAME,
-  NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_PIN,
-  NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_TYPE,
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_CONFIG_DEVICE_INSTANCE_HEATER[] = 
-{
-  NODE_TYPE_CONFIG_LEAF_HEATER_FRIENDLY_NAME,
-  NODE_TYPE_CONFIG_LEAF_HEATER_PIN,
-  NODE_TYPE_CONFIG_LEAF_HEATER_TEMP_SENSOR,
-  NODE_TYPE_CONFIG_LEAF_HEATER_MAX_TEMP,
-  NODE_TYPE_CONFIG_LEAF_HEATER_POWER_ON_LEVEL,
-  NODE_TYPE_CONFIG_LEAF_HEATER_USE_SOFT_PWM,
-  NODE_TYPE_CONFIG_LEAF_HEATER_USE_BANG_BANG,
-  NODE_TYPE_CONFIG_LEAF_HEATER_USE_PID,
-  NODE_TYPE_CONFIG_LEAF_HEATER_BANG_BANG_HYSTERESIS,
-  NODE_TYPE_CONFIG_LEAF_HEATER_PID_FUNCTIONAL_RANGE,
-  NODE_TYPE_CONFIG_LEAF_HEATER_PID_KP,
-  NODE_TYPE_CONFIG_LEAF_HEATER_PID_KI,
-  NODE_TYPE_CONFIG_LEAF_HEATER_PID_KD,
-  NODE_TYPE_CONFIG_LEAF_HEATER_PID_DO_AUTOTUNE,  
-};
-PROGMEM static const uint8_t children_of_NODE_TYPE_CONFIG_DEVICE_INSTANCE_STEPPER[] = 
-{
-  NODE_TYPE_CONFIG_LEAF_STEPPER_FRIENDLY_NAME,
-  NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_PIN,
-  NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_INVERT,
-  NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_PIN,
-  NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_INVERT,
-  NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_PIN,
-  NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_INVERT
+  CONFIG_SCHEMA_DEVICES(SCHEMA_DEVICE_INSTANCE_TYPE)
 };
+
 //
 // Configuration Tree Definition
 //
+// Note: entries must be kept in ascending node_type order as 
+// FindNodeInfoIndex() uses a binary search.
+//
 PROGMEM static const ConfigNodeInfo node_info_array[] = 
 {
   //
   // Config Related Nodes
   //
 
-  GROUP_NODE(NODE_TYPE_CONFIG_ROOT),
+  GROUP_NODE(NODE_TYPE_CONFIG_ROOT, name_of_NODE_TYPE_CONFIG_ROOT, children_of_NODE_TYPE_CONFIG_ROOT),
 
   // First level groups
-  GROUP_NODE(NODE_TYPE_GROUP_SYSTEM),
-  GROUP_NODE(NODE_TYPE_GROUP_DEVICES),
-  GROUP_NODE(NODE_TYPE_GROUP_STATISTICS),
-  GROUP_NODE(NODE_TYPE_GROUP_DEBUG),
+  CONFIG_SCHEMA_GROUPS(SCHEMA_GROUP_NODE)
     
   // Device Type Nodes
-  INSTANCE_PARENT_NODE(NODE_TYPE_CONFIG_DEVICE_INPUT_SWITCHES, 
-      NODE_TYPE_CONFIG_DEVICE_INSTANCE_INPUT_SWITCH, 
-      Device_InputSwitch::GetNumDevices), 
-  INSTANCE_PARENT_NODE(NODE_TYPE_CONFIG_DEVICE_OUTPUT_SWITCHES,
-      NODE_TYPE_CONFIG_DEVICE_INSTANCE_OUTPUT_SWITCH, 
-      Device_OutputSwitch::GetNumDevices), 
-  INSTANCE_PARENT_NODE(NODE_TYPE_CONFIG_DEVICE_PWM_OUTPUTS,
-      NODE_TYPE_CONFIG_DEVICE_INSTANCE_PWM_OUTPUT, 
-      Device_PwmOutput::GetNumDevices), 
-  INSTANCE_PARENT_NODE(NODE_TYPE_CONFIG_DEVICE_BUZZERS,
-      NODE_TYPE_CONFIG_DEVICE_INSTANCE_BUZZER, 
-      Device_Buzzer::GetNumDevices), 
-  INSTANCE_PARENT_NODE(NODE_TYPE_CONFIG_DEVICE_TEMP_SENSORS,
-      NODE_TYPE_CONFIG_DEVICE_INSTANCE_TEMP_SENSOR, 
-      Device_TemperatureSensor::GetNumDevices), 
-  INSTANCE_PARENT_NODE(NODE_TYPE_CONFIG_DEVICE_HEATERS,
-      NODE_TYPE_CONFIG_DEVICE_INSTANCE_HEATER, 
-      Device_Heater::GetNumDevices), 
-  INSTANCE_PARENT_NODE(NODE_TYPE_CONFIG_DEVICE_STEPPERS,
-      NODE_TYPE_CONFIG_DEVICE_INSTANCE_STEPPER, 
-      Device_Stepper::GetNumDevices), 
+  CONFIG_SCHEMA_DEVICES(SCHEMA_INSTANCE_PARENT_NODE)
     
   // Device Type Instance Nodes
-  UNNAMED_GROUP_NODE(NODE_TYPE_CONFIG_DEVICE_INSTANCE_INPUT_SWITCH, PM_DEVICE_TYPE_SWITCH_INPUT),
-  UNNAMED_GROUP_NODE(NODE_TYPE_CONFIG_DEVICE_INSTANCE_OUTPUT_SWITCH, PM_DEVICE_TYPE_SWITCH_OUTPUT),
-  UNNAMED_GROUP_NODE(NODE_TYPE_CONFIG_DEVICE_INSTANCE_PWM_OUTPUT, PM_DEVICE_TYPE_PWM_OUTPUT),
-  UNNAMED_GROUP_NODE(NODE_TYPE_CONFIG_DEVICE_INSTANCE_BUZZER, PM_DEVICE_TYPE_BUZZER),
-  UNNAMED_GROUP_NODE(NODE_TYPE_CONFIG_DEVICE_INSTANCE_TEMP_SENSOR, PM_DEVICE_TYPE_TEMP_SENSOR),
-  UNNAMED_GROUP_NODE(NODE_TYPE_CONFIG_DEVICE_INSTANCE_HEATER, PM_DEVICE_TYPE_HEATER),
-  UNNAMED_GROUP_NODE(NODE_TYPE_CONFIG_DEVICE_INSTANCE_STEPPER, PM_DEVICE_TYPE_STEPPER),
+  CONFIG_SCHEMA_DEVICES(SCHEMA_INSTANCE_NODE)
     
   // Device related leaf nodes
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_FRIENDLY_NAME,
-      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_TRIGGER_LEVEL,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_ENABLE_PULLUP,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_FRIENDLY_NAME,
-      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_INITIAL_STATE,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_FRIENDLY_NAME,
-      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_USE_SOFT_PWM,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_BUZZER_FRIENDLY_NAME,
-      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_BUZZER_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_FRIENDLY_NAME,
-      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_TYPE,  
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_INT16),
-      
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_FRIENDLY_NAME,
-      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_POWER_ON_LEVEL,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_USE_SOFT_PWM,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_USE_BANG_BANG,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_USE_PID,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_TEMP_SENSOR,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_MAX_TEMP,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_INT16),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_BANG_BANG_HYSTERESIS,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_PID_FUNCTIONAL_RANGE,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_PID_KP,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_FLOAT),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_PID_KI,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_FLOAT),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_PID_KD,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_FLOAT),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_HEATER_PID_DO_AUTOTUNE,
-      FIRMWARE_CONFIG_TYPE_OPERATION, FIRMWARE_CONFIG_OPS_WRITEABLE, LEAF_SET_DATATYPE_STRING),
+  CONFIG_SCHEMA_DEVICES(SCHEMA_DEVICE_LEAF_NODES)
+  CONFIG_SCHEMA_DEVICES(SCHEMA_DEVICE_EXTENDED_LEAF_NODES)
       
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_STEPPER_FRIENDLY_NAME,
-      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_INVERT,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_INVERT,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_PIN,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_INVERT,
-      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_BOOL),
-      
-  // System config related leaf nodes
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_NAME,
-    FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_TYPE,
-    FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_REV,
-    FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_BOARD_IDENTITY,
-    FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_BOARD_SERIAL_NUM,
-    FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_STRING),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_INPUT_SWITCHES,
-    FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_OUTPUT_SWITCHES,
-    FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_PWM_OUTPUTS,
-    FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_BUZZERS,
-    FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_HEATERS,
-    FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_TEMP_SENSORS,
-    FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-  LEAF_NODE(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_STEPPERS,
-    FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, LEAF_SET_DATATYPE_UINT8),
-
-    // Statistics related leaf nodes
-  LEAF_NODE(NODE_TYPE_STATS_LEAF_RX_PACKET_COUNT,
-    FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, LEAF_SET_DATATYPE_INVALID),
-  LEAF_NODE(NODE_TYPE_STATS_LEAF_RX_ERROR_COUNT,
-    FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, LEAF_SET_DATATYPE_INVALID),
-  LEAF_NODE(NODE_TYPE_STATS_LEAF_QUEUE_MEMORY,
-    FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, LEAF_SET_DATATYPE_INVALID),
-  LEAF_NODE(NODE_TYPE_DEBUG_LEAF_STACK_MEMORY,
-    FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, LEAF_SET_DATATYPE_INVALID),
-  LEAF_NODE(NODE_TYPE_DEBUG_LEAF_STACK_LOW_WATER_MARK,
-    FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, LEAF_SET_DATATYPE_INVALID),
-    
-  // Operation nodes
-  LEAF_NODE(NODE_TYPE_OPERATION_LEAF_RESET_EEPROM,
-    FIRMWARE_CONFIG_TYPE_OPERATION, FIRMWARE_CONFIG_OPS_WRITEABLE, LEAF_SET_DATATYPE_STRING)
-    
-  // Diagnostics related leaf nodes
-    
+  // System config related leaf nodes (and operation nodes)
+  CONFIG_SCHEMA_SYSTEM_LEAVES(SCHEMA_LEAF_NODE)
+
+  // Statistics related leaf nodes
+  CONFIG_SCHEMA_STATISTICS_LEAVES(SCHEMA_LEAF_NODE)
+  CONFIG_SCHEMA_DEBUG_LEAVES(SCHEMA_LEAF_NODE)
 };
 
 //
@@ -553,6 +295,69 @@ ConfigurationTreeNode::GetLeafSetDataType() const
     return false;
   return pgm_read_byte(&node_info_array[node_info_index].leaf_datatype);
 }
+
+// Returns the function which directly sets the value of this leaf node
+// (or 0 if the value must be set explicitly)
+config_accessor_type 
+ConfigurationTreeNode::GetLeafSetter() const
+{
+  if (node_info_index == INVALID_NODE_INFO_INDEX)
+    return 0;
+  if (sizeof(node_info_array[node_info_index].leaf_setter) == 2)
+    return (config_accessor_type)pgm_read_word(&node_info_array[node_info_index].leaf_setter);
+  else
+    return (config_accessor_type)pgm_read_dword(&node_info_array[node_info_index].leaf_setter);
+}
+
+// Returns the function which directly reads the value of this leaf node
+// (or 0 if the value must be read explicitly)
+config_accessor_type 
+ConfigurationTreeNode::GetLeafGetter() const
+{
+  if (node_info_index == INVALID_NODE_INFO_INDEX)
+    return 0;
+  if (sizeof(node_info_array[node_info_index].leaf_getter) == 2)
+    return (config_accessor_type)pgm_read_word(&node_info_array[node_info_index].leaf_getter);
+  else
+    return (config_accessor_type)pgm_read_dword(&node_info_array[node_info_index].leaf_getter);
+}
+
+// Returns the device type of the device instance node which contains 
+// this leaf node (or PM_DEVICE_TYPE_INVALID if it is not a device attribute)
+uint8_t 
+ConfigurationTreeNode::GetLeafDeviceType() const
+{
+  for (uint8_t i=0; i<sizeof(device_instance_node_types); i++)
+  {
+    const uint8_t index = FindNodeInfoIndex(pgm_read_byte(&device_instance_node_types[i]));
+    if (index == INVALID_NODE_INFO_INDEX)
+      continue;
+    const ConfigNodeInfo *node_info = &node_info_array[index];
+    const uint8_t *named_child_types = (sizeof(node_info->named_child_types) == 2) ?
+          (const uint8_t*)pgm_read_word(&node_info->named_child_types) :
+          (const uint8_t*)pgm_read_dword(&node_info->named_child_types);
+    // the functor pointer is acually storing a raw value in this case
+    const uint8_t num_children = (sizeof(num_children_functor_type) == 2) ?
+          (uint8_t)pgm_read_word(&node_info->num_children) :
+          (uint8_t)pgm_read_dword(&node_info->num_children);
+          
+    // binary search (the leaves of each device are in ascending node type order)
+    uint8_t low = 0;
+    uint8_t high = num_children;
+    while (low < high)
+    {
+      const uint8_t mid = (low + high) / 2;
+      const uint8_t child_type = pgm_read_byte(&named_child_types[mid]);
+      if (child_type == node_type)
+        return pgm_read_byte(&node_info->leaf_datatype);
+      if (child_type < node_type)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+  }
+  return PM_DEVICE_TYPE_INVALID;
+}
   
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -579,12 +384,127 @@ ConfigurationTreeNode::SetAsRootNode()
 uint8_t 
 ConfigurationTreeNode::FindNodeInfoIndex(uint8_t type) const
 {
-  for (uint8_t i=0; i<sizeof(node_info_array)/sizeof(node_info_array[0]); i++)
-    if (pgm_read_byte(&node_info_array[i].node_type) == type)
-      return i;
+  // binary search (node_info_array is sorted by node type)
+  uint8_t low = 0;
+  uint8_t high = sizeof(node_info_array)/sizeof(node_info_array[0]);
+  while (low < high)
+  {
+    const uint8_t mid = (low + high) / 2;
+    const uint8_t mid_type = pgm_read_byte(&node_info_array[mid].node_type);
+    if (mid_type == type)
+      return mid;
+    if (mid_type < type)
+      low = mid + 1;
+    else
+      high = mid;
+  }
   return INVALID_NODE_INFO_INDEX;
 }
 
+bool 
+ConfigurationTreeNode::InitializeLeafNode(uint8_t type)
+{
+  Clear();
+  node_type = type;
+  node_info_index = FindNodeInfoIndex(type);
+  if (IsLeafNode())
+    return true;
+  Clear();
+  return false;
+}
+
+// Locates the child matching the first name segment of str.
+// Returns the length of the matched segment or -1 if there is no match.
+int8_t 
+ConfigurationTreeNode::FindChild(const char *str, ConfigurationTreeNode &child) const
+{
+  child.Clear();
+  if (node_info_index == INVALID_NODE_INFO_INDEX || IsLeafNode())
+    return -1;
+  const ConfigNodeInfo *node_info = &node_info_array[node_info_index];
+  const uint8_t instance_child_type = pgm_read_byte(&node_info->instance_child_type);
+  const num_children_functor_type num_children_functor = (sizeof(num_children_functor_type) == 2) ?
+            (num_children_functor_type)pgm_read_word(&node_info->num_children) :
+            (num_children_functor_type)pgm_read_dword(&node_info->num_children);
+
+  if (instance_child_type != NODE_TYPE_INVALID)
+  {
+    // instance names are the (canonical) instance number so just parse it
+    uint16_t instance_id = 0;
+    int8_t cnt = 0;
+    char ch;
+    while ((ch = str[cnt]) >= '0' && ch <= '9' && cnt < 3)
+    {
+      instance_id = (instance_id * 10) + (ch - '0');
+      cnt += 1;
+    }
+    if (cnt == 0 || (ch != '\0' && ch != '.') || (cnt > 1 && str[0] == '0')
+        || instance_id >= num_children_functor())
+      return -1;
+    child.node_type = instance_child_type;
+    child.node_info_index = FindNodeInfoIndex(instance_child_type);
+    child.instance_id = instance_id;
+    return cnt;
+  }
+
+  const uint8_t *named_child_types = (sizeof(node_info->named_child_types) == 2) ?
+        (const uint8_t*)pgm_read_word(&node_info->named_child_types) :
+        (const uint8_t*)pgm_read_dword(&node_info->named_child_types);
+  // the functor pointer is acually storing a raw value in this case
+  const uint8_t num_children = (uint8_t)(uint32_t)num_children_functor; 
+  for (uint8_t i=0; i<num_children; i++)
+  {
+    child.node_type = pgm_read_byte(&named_child_types[i]);
+    child.node_info_index = FindNodeInfoIndex(child.node_type);
+    const int8_t length = child.CompareName(str);
+    if (length > 0)
+      return length;
+  }
+  child.Clear();
+  return -1;
+}
+
+// Initializes child as the given child of this node (as used when resuming a 
+// traversal). Returns false if there is no such child.
+bool 
+ConfigurationTreeNode::InitializeChild(uint8_t type, uint8_t instance, ConfigurationTreeNode &child) const
+{
+  child.Clear();
+  if (node_info_index == INVALID_NODE_INFO_INDEX || IsLeafNode())
+    return false;
+  const ConfigNodeInfo *node_info = &node_info_array[node_info_index];
+  const uint8_t instance_child_type = pgm_read_byte(&node_info->instance_child_type);
+  const num_children_functor_type num_children_functor = (sizeof(num_children_functor_type) == 2) ?
+            (num_children_functor_type)pgm_read_word(&node_info->num_children) :
+            (num_children_functor_type)pgm_read_dword(&node_info->num_children);
+
+  if (instance_child_type != NODE_TYPE_INVALID)
+  {
+    if (type != instance_child_type || instance >= num_children_functor())
+      return false;
+  }
+  else
+  {
+    const uint8_t *named_child_types = (sizeof(node_info->named_child_types) == 2) ?
+          (const uint8_t*)pgm_read_word(&node_info->named_child_types) :
+          (const uint8_t*)pgm_read_dword(&node_info->named_child_types);
+    // the functor pointer is acually storing a raw value in this case
+    const uint8_t num_children = (uint8_t)(uint32_t)num_children_functor; 
+    uint8_t i;
+    for (i=0; i<num_children; i++)
+    {
+      if (pgm_read_byte(&named_child_types[i]) == type)
+        break;
+    }
+    if (i == num_children || instance != INVALID_INSTANCE_ID)
+      return false;
+  }
+  child.node_type = type;
+  child.node_info_index = FindNodeInfoIndex(type);
+  child.instance_id = instance;
+  return true;
+}
+
 
 bool 
 ConfigurationTreeNode::InitializeNextChild(ConfigurationTreeNode &child) const
@@ -22,6 +22,29 @@
  
 #include <stdint.h>
 
+//
+// Direct accessors of leaf node values (see ConfigTreeSchema.h).
+// Setters return APP_ERROR_TYPE_SUCCESS or an error code. Datatypes 
+// without an accessor type must be handled explicitly.
+//
+typedef void (*config_accessor_type)();
+
+typedef uint8_t (*config_UINT8_setter_type)(uint8_t device_number, uint8_t value);
+typedef uint8_t (*config_INT16_setter_type)(uint8_t device_number, int16_t value);
+typedef uint8_t (*config_BOOL_setter_type)(uint8_t device_number, bool value);
+typedef uint8_t (*config_FLOAT_setter_type)(uint8_t device_number, float value);
+
+typedef uint8_t (*config_UINT8_getter_type)(uint8_t device_number);
+typedef int16_t (*config_INT16_getter_type)(uint8_t device_number);
+typedef bool (*config_BOOL_getter_type)(uint8_t device_number);
+typedef float (*config_FLOAT_getter_type)(uint8_t device_number); // NAN if there is no value
+
+// (only NO_ACCESSOR can be converted to these types)
+typedef config_accessor_type config_STRING_setter_type;
+typedef config_accessor_type config_STRING_getter_type;
+typedef config_accessor_type config_INVALID_setter_type;
+typedef config_accessor_type config_INVALID_getter_type;
+
 //
 // Configuration Tree Node class
 //
@@ -32,7 +55,7 @@ class ConfigurationTreeNode
 {
 public:
 
-// internal node types
+// internal node types (the tree structure is declared in ConfigTreeSchema.h)
 #define NODE_TYPE_INVALID               0
 #define NODE_TYPE_CONFIG_ROOT            1
 
@@ -104,6 +127,27 @@ public:
 #define NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_PIN            95
 #define NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_INVERT         96
 
+// extended device attributes
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_OVERSAMPLING    100
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_FILTER_MEDIAN   101
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_FILTER_TIME_CONSTANT 102
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_BETA 103
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_R25  104
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_SH_A 105
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_SH_B 106
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_SH_C 107
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_PULLUP_RESISTANCE 108
+#define NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_SERIES_RESISTANCE 109
+#define NODE_TYPE_CONFIG_LEAF_HEATER_RUNAWAY_PERIOD       110
+#define NODE_TYPE_CONFIG_LEAF_HEATER_RUNAWAY_RISE         111
+#define NODE_TYPE_CONFIG_LEAF_HEATER_RUNAWAY_DEVIATION    112
+#define NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_STATE   113
+#define NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_CYCLE   114
+#define NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_KP      115
+#define NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_KI      116
+#define NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_KD      117
+#define NODE_TYPE_CONFIG_LEAF_HEATER_POWER_PRIORITY       118
+
 // System configuration   
 #define NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_NAME        180
 #define NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_TYPE        181
@@ -117,6 +161,8 @@ public:
 #define NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_TEMP_SENSORS     190
 #define NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_HEATERS          191
 #define NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_STEPPERS         192
+#define NODE_TYPE_CONFIG_LEAF_SYSTEM_QUEUE_STATUS_TRAILER 193
+#define NODE_TYPE_CONFIG_LEAF_SYSTEM_HEATER_POWER_BUDGET  194
 
 // System operations
 
@@ -167,6 +213,9 @@ public:
   uint8_t GetLeafClass() const;
   uint8_t GetLeafOperations() const;
   uint8_t GetLeafSetDataType() const;
+  uint8_t GetLeafDeviceType() const;
+  config_accessor_type GetLeafSetter() const;
+  config_accessor_type GetLeafGetter() const;
   
 private:
 
@@ -175,6 +224,9 @@ private:
   ConfigurationTreeNode() { Clear(); }
 
   bool InitializeNextChild(ConfigurationTreeNode &child) const;
+  int8_t FindChild(const char *str, ConfigurationTreeNode &child) const;
+  bool InitializeChild(uint8_t type, uint8_t instance, ConfigurationTreeNode &child) const;
+  bool InitializeLeafNode(uint8_t type);
 
   void SetAsRootNode(); 
   void Clear();
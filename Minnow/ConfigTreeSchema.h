@@ -0,0 +1,394 @@
+/*
+ Minnow Pacemaker client firmware.
+    
+ Copyright (C) 2013 Robert Fairlie-Cuninghame
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Declarative schema of the configuration tree.
+//
+// The node names, child lists and leaf node properties in ConfigTreeNode.cpp
+// are all generated from the lists below, so adding a configuration leaf only
+// requires adding its node type (in ConfigTreeNode.h) and a single entry here.
+//
+// Each list is expanded with a caller supplied macro. Leaf entries have
+// the form:
+//
+//   LEAF(node_type, name, leaf_class, operations, datatype, setter, getter)
+//
+// where name is a key of CONFIG_SCHEMA_NAMES, datatype is the suffix of a
+// LEAF_SET_DATATYPE_xxx define and setter/getter are the functions which
+// directly access the value (or NO_ACCESSOR if the leaf is handled explicitly
+// in firmware_configuration.cpp). The accessor signatures are checked at
+// compile time against the config_xxx_setter_type/config_xxx_getter_type
+// typedefs in ConfigTreeNode.h.
+//
+// Note: entries must be kept in ascending node_type order as the leaves
+// are listed in this order in node_info_array (which is binary searched)
+// and the node types also determine the snapshot record order.
+//
+
+#ifndef CONFIG_TREE_SCHEMA_H
+#define CONFIG_TREE_SCHEMA_H
+
+#define NO_ACCESSOR 0
+
+// Names used by configuration nodes (each name is only stored once)
+#define CONFIG_SCHEMA_NAMES(CONFIG_NAME) \
+  CONFIG_NAME(SYSTEM) CONFIG_NAME(DEVICES) CONFIG_NAME(STATS) CONFIG_NAME(DEBUG) \
+  CONFIG_NAME(DIGITAL_INPUT) CONFIG_NAME(DIGITAL_OUTPUT) CONFIG_NAME(PWM_OUTPUT) CONFIG_NAME(BUZZER) \
+  CONFIG_NAME(TEMP_SENSOR) CONFIG_NAME(HEATER) CONFIG_NAME(STEPPER) \
+  CONFIG_NAME(NAME) CONFIG_NAME(PIN) CONFIG_NAME(TYPE) CONFIG_NAME(USE_SOFT_PWM) \
+  CONFIG_NAME(TRIGGER_LEVEL) CONFIG_NAME(ENABLE_PULLUP) CONFIG_NAME(INITIAL_STATE) \
+  CONFIG_NAME(MAX_TEMP) CONFIG_NAME(POWER_ON_LEVEL) CONFIG_NAME(USE_BANG_BANG) CONFIG_NAME(USE_PID) \
+  CONFIG_NAME(BANG_BANG_HYSTERESIS) CONFIG_NAME(PID_RANGE) CONFIG_NAME(PID_KP) CONFIG_NAME(PID_KI) CONFIG_NAME(PID_KD) \
+  CONFIG_NAME(PID_DO_AUTOTUNE) \
+  CONFIG_NAME(ENABLE_PIN) CONFIG_NAME(ENABLE_INVERT) CONFIG_NAME(DIRECTION_PIN) CONFIG_NAME(DIRECTION_INVERT) \
+  CONFIG_NAME(STEP_PIN) CONFIG_NAME(STEP_INVERT) CONFIG_NAME(OVERSAMPLING) \
+  CONFIG_NAME(FILTER_MEDIAN) CONFIG_NAME(FILTER_TIME_CONSTANT) \
+  CONFIG_NAME(THERMISTOR_BETA) CONFIG_NAME(THERMISTOR_R25) CONFIG_NAME(THERMISTOR_SH_A) \
+  CONFIG_NAME(THERMISTOR_SH_B) CONFIG_NAME(THERMISTOR_SH_C) \
+  CONFIG_NAME(PULLUP_RESISTANCE) CONFIG_NAME(SERIES_RESISTANCE) \
+  CONFIG_NAME(RUNAWAY_PERIOD) CONFIG_NAME(RUNAWAY_RISE) CONFIG_NAME(RUNAWAY_DEVIATION) \
+  CONFIG_NAME(PID_AUTOTUNE_STATE) CONFIG_NAME(PID_AUTOTUNE_CYCLE) \
+  CONFIG_NAME(PID_AUTOTUNE_KP) CONFIG_NAME(PID_AUTOTUNE_KI) CONFIG_NAME(PID_AUTOTUNE_KD) \
+  CONFIG_NAME(POWER_PRIORITY) CONFIG_NAME(HEATER_POWER_BUDGET) \
+  CONFIG_NAME(HARDWARE_NAME) CONFIG_NAME(HARDWARE_TYPE) CONFIG_NAME(HARDWARE_REV) \
+  CONFIG_NAME(BOARD_IDENTITY) CONFIG_NAME(BOARD_SERIAL_NUM) \
+  CONFIG_NAME(NUM_DIGITAL_INPUTS) CONFIG_NAME(NUM_DIGITAL_OUTPUTS) CONFIG_NAME(NUM_PWM_OUTPUTS) \
+  CONFIG_NAME(NUM_BUZZERS) CONFIG_NAME(NUM_TEMP_SENSORS) CONFIG_NAME(NUM_HEATERS) CONFIG_NAME(NUM_STEPPERS) \
+  CONFIG_NAME(QUEUE_STATUS_TRAILER) CONFIG_NAME(RESET_EEPROM) \
+  CONFIG_NAME(RX_COUNT) CONFIG_NAME(RX_ERROR) CONFIG_NAME(QUEUE_MEMORY) \
+  CONFIG_NAME(STACK_MEMORY) CONFIG_NAME(STACK_LOW_WATER_MARK)
+
+//
+// Top level groups
+//
+// GROUP(node_type, name, children)
+//
+#define CONFIG_SCHEMA_GROUPS(GROUP) \
+  GROUP(NODE_TYPE_GROUP_SYSTEM, SYSTEM, CONFIG_SCHEMA_SYSTEM_LEAVES) \
+  GROUP(NODE_TYPE_GROUP_DEVICES, DEVICES, CONFIG_SCHEMA_DEVICES) \
+  GROUP(NODE_TYPE_GROUP_STATISTICS, STATS, CONFIG_SCHEMA_STATISTICS_LEAVES) \
+  GROUP(NODE_TYPE_GROUP_DEBUG, DEBUG, CONFIG_SCHEMA_DEBUG_LEAVES)
+
+//
+// Device types
+//
+// DEVICE(node_type, instance_node_type, name, device_type, num_devices, leaves, 
+//     extended_leaves)
+//
+// The extended leaves are device attributes which were added after the 
+// original range of attribute node types (60-99) was allocated. These use node 
+// types from 100 upwards and are placed after all of the original attributes.
+//
+#define CONFIG_SCHEMA_DEVICES(DEVICE) \
+  DEVICE(NODE_TYPE_CONFIG_DEVICE_INPUT_SWITCHES, NODE_TYPE_CONFIG_DEVICE_INSTANCE_INPUT_SWITCH, \
+      DIGITAL_INPUT, PM_DEVICE_TYPE_SWITCH_INPUT, Device_InputSwitch::GetNumDevices, \
+      CONFIG_SCHEMA_INPUT_SWITCH_LEAVES, CONFIG_SCHEMA_NO_LEAVES) \
+  DEVICE(NODE_TYPE_CONFIG_DEVICE_OUTPUT_SWITCHES, NODE_TYPE_CONFIG_DEVICE_INSTANCE_OUTPUT_SWITCH, \
+      DIGITAL_OUTPUT, PM_DEVICE_TYPE_SWITCH_OUTPUT, Device_OutputSwitch::GetNumDevices, \
+      CONFIG_SCHEMA_OUTPUT_SWITCH_LEAVES, CONFIG_SCHEMA_NO_LEAVES) \
+  DEVICE(NODE_TYPE_CONFIG_DEVICE_PWM_OUTPUTS, NODE_TYPE_CONFIG_DEVICE_INSTANCE_PWM_OUTPUT, \
+      PWM_OUTPUT, PM_DEVICE_TYPE_PWM_OUTPUT, Device_PwmOutput::GetNumDevices, \
+      CONFIG_SCHEMA_PWM_OUTPUT_LEAVES, CONFIG_SCHEMA_NO_LEAVES) \
+  DEVICE(NODE_TYPE_CONFIG_DEVICE_BUZZERS, NODE_TYPE_CONFIG_DEVICE_INSTANCE_BUZZER, \
+      BUZZER, PM_DEVICE_TYPE_BUZZER, Device_Buzzer::GetNumDevices, \
+      CONFIG_SCHEMA_BUZZER_LEAVES, CONFIG_SCHEMA_NO_LEAVES) \
+  DEVICE(NODE_TYPE_CONFIG_DEVICE_TEMP_SENSORS, NODE_TYPE_CONFIG_DEVICE_INSTANCE_TEMP_SENSOR, \
+      TEMP_SENSOR, PM_DEVICE_TYPE_TEMP_SENSOR, Device_TemperatureSensor::GetNumDevices, \
+      CONFIG_SCHEMA_TEMP_SENSOR_LEAVES, CONFIG_SCHEMA_TEMP_SENSOR_EXTENDED_LEAVES) \
+  DEVICE(NODE_TYPE_CONFIG_DEVICE_HEATERS, NODE_TYPE_CONFIG_DEVICE_INSTANCE_HEATER, \
+      HEATER, PM_DEVICE_TYPE_HEATER, Device_Heater::GetNumDevices, \
+      CONFIG_SCHEMA_HEATER_LEAVES, CONFIG_SCHEMA_HEATER_EXTENDED_LEAVES) \
+  DEVICE(NODE_TYPE_CONFIG_DEVICE_STEPPERS, NODE_TYPE_CONFIG_DEVICE_INSTANCE_STEPPER, \
+      STEPPER, PM_DEVICE_TYPE_STEPPER, Device_Stepper::GetNumDevices, \
+      CONFIG_SCHEMA_STEPPER_LEAVES, CONFIG_SCHEMA_NO_LEAVES)
+
+//
+// Device attributes
+//
+
+#define CONFIG_SCHEMA_NO_LEAVES(LEAF)
+
+#define CONFIG_SCHEMA_INPUT_SWITCH_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_FRIENDLY_NAME, NAME, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_PIN, PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_InputSwitch::GetPin) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_TRIGGER_LEVEL, TRIGGER_LEVEL, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      Device_InputSwitch::SetTriggerLevel, Device_InputSwitch::GetTriggerLevel) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_ENABLE_PULLUP, ENABLE_PULLUP, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      Device_InputSwitch::SetEnablePullup, Device_InputSwitch::GetEnablePullup)
+
+#define CONFIG_SCHEMA_OUTPUT_SWITCH_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_FRIENDLY_NAME, NAME, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_PIN, PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_OutputSwitch::GetPin) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_INITIAL_STATE, INITIAL_STATE, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR)
+
+#define CONFIG_SCHEMA_PWM_OUTPUT_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_FRIENDLY_NAME, NAME, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_PIN, PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_PwmOutput::GetPin) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_USE_SOFT_PWM, USE_SOFT_PWM, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      Device_PwmOutput::EnableSoftPwm, Device_PwmOutput::GetSoftPwmState)
+
+#define CONFIG_SCHEMA_BUZZER_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_BUZZER_FRIENDLY_NAME, NAME, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_BUZZER_PIN, PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_Buzzer::GetPin)
+
+#define CONFIG_SCHEMA_TEMP_SENSOR_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_FRIENDLY_NAME, NAME, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_PIN, PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_TemperatureSensor::GetPin) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_TYPE, TYPE, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, INT16, \
+      Device_TemperatureSensor::SetType, NO_ACCESSOR)
+
+#define CONFIG_SCHEMA_TEMP_SENSOR_EXTENDED_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_OVERSAMPLING, OVERSAMPLING, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_TemperatureSensor::SetOversampling, Device_TemperatureSensor::GetOversampling) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_FILTER_MEDIAN, FILTER_MEDIAN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_TemperatureSensor::SetFilterMedian, Device_TemperatureSensor::GetFilterMedian) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_FILTER_TIME_CONSTANT, FILTER_TIME_CONSTANT, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_TemperatureSensor::SetFilterTimeConstant, Device_TemperatureSensor::GetFilterTimeConstant) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_BETA, THERMISTOR_BETA, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_TemperatureSensor::SetThermistorBeta, \
+      Device_TemperatureSensor::GetThermistorBeta) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_R25, THERMISTOR_R25, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_TemperatureSensor::SetThermistorR25, \
+      Device_TemperatureSensor::GetThermistorR25) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_SH_A, THERMISTOR_SH_A, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_TemperatureSensor::SetThermistorShA, \
+      Device_TemperatureSensor::GetThermistorShA) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_SH_B, THERMISTOR_SH_B, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_TemperatureSensor::SetThermistorShB, \
+      Device_TemperatureSensor::GetThermistorShB) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_THERMISTOR_SH_C, THERMISTOR_SH_C, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_TemperatureSensor::SetThermistorShC, \
+      Device_TemperatureSensor::GetThermistorShC) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_PULLUP_RESISTANCE, PULLUP_RESISTANCE, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_TemperatureSensor::SetPullupResistance, \
+      Device_TemperatureSensor::GetPullupResistance) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_SERIES_RESISTANCE, SERIES_RESISTANCE, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_TemperatureSensor::SetSeriesResistance, \
+      Device_TemperatureSensor::GetSeriesResistance)
+
+// Note: the PID getters are not used directly as the PID parameters only
+// exist while the heater is in PID mode.
+#define CONFIG_SCHEMA_HEATER_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_FRIENDLY_NAME, NAME, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PIN, PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_Heater::GetHeaterPin) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_TEMP_SENSOR, TEMP_SENSOR, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_Heater::SetTempSensor, Device_Heater::GetTempSensor) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_MAX_TEMP, MAX_TEMP, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, INT16, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_POWER_ON_LEVEL, POWER_ON_LEVEL, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_Heater::SetPowerOnLevel, Device_Heater::GetPowerOnLevel) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_USE_SOFT_PWM, USE_SOFT_PWM, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      Device_Heater::EnableSoftPwm, Device_Heater::GetSoftPwmState) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_USE_BANG_BANG, USE_BANG_BANG, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_USE_PID, USE_PID, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_BANG_BANG_HYSTERESIS, BANG_BANG_HYSTERESIS, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_Heater::SetBangBangHysteresis, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_FUNCTIONAL_RANGE, PID_RANGE, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_Heater::SetPidFunctionalRange, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_KP, PID_KP, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_Heater::SetPidDefaultKp, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_KI, PID_KI, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_Heater::SetPidDefaultKi, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_KD, PID_KD, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, FLOAT, \
+      Device_Heater::SetPidDefaultKd, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_DO_AUTOTUNE, PID_DO_AUTOTUNE, \
+      FIRMWARE_CONFIG_TYPE_OPERATION, FIRMWARE_CONFIG_OPS_WRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR)
+
+#define CONFIG_SCHEMA_HEATER_EXTENDED_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_RUNAWAY_PERIOD, RUNAWAY_PERIOD, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_Heater::SetRunawayPeriod, Device_Heater::GetRunawayPeriod) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_RUNAWAY_RISE, RUNAWAY_RISE, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_Heater::SetRunawayRise, Device_Heater::GetRunawayRise) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_RUNAWAY_DEVIATION, RUNAWAY_DEVIATION, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_Heater::SetRunawayDeviation, Device_Heater::GetRunawayDeviation) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_STATE, PID_AUTOTUNE_STATE, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, INVALID, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_CYCLE, PID_AUTOTUNE_CYCLE, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, UINT8, \
+      NO_ACCESSOR, Device_Heater::GetPidAutotuneCycle) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_KP, PID_AUTOTUNE_KP, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, FLOAT, \
+      NO_ACCESSOR, Device_Heater::GetPidAutotuneKp) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_KI, PID_AUTOTUNE_KI, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, FLOAT, \
+      NO_ACCESSOR, Device_Heater::GetPidAutotuneKi) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_KD, PID_AUTOTUNE_KD, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, FLOAT, \
+      NO_ACCESSOR, Device_Heater::GetPidAutotuneKd) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_HEATER_POWER_PRIORITY, POWER_PRIORITY, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      Device_Heater::SetPowerPriority, Device_Heater::GetPowerPriority)
+
+#define CONFIG_SCHEMA_STEPPER_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_STEPPER_FRIENDLY_NAME, NAME, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_PIN, ENABLE_PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_Stepper::GetEnablePin) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_INVERT, ENABLE_INVERT, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      Device_Stepper::SetEnableInvert, Device_Stepper::GetEnableInvert) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_PIN, DIRECTION_PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_Stepper::GetDirectionPin) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_INVERT, DIRECTION_INVERT, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      Device_Stepper::SetDirectionInvert, Device_Stepper::GetDirectionInvert) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_PIN, STEP_PIN, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, Device_Stepper::GetStepPin) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_INVERT, STEP_INVERT, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      Device_Stepper::SetStepInvert, Device_Stepper::GetStepInvert)
+
+//
+// System configuration and operations
+//
+// Note: pins are set via setPin() so that pin conflicts are checked and the
+// system leaves are not device attributes so have no direct accessors.
+//
+#define CONFIG_SCHEMA_SYSTEM_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_NAME, HARDWARE_NAME, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_TYPE, HARDWARE_TYPE, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_HARDWARE_REV, HARDWARE_REV, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_BOARD_IDENTITY, BOARD_IDENTITY, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_BOARD_SERIAL_NUM, BOARD_SERIAL_NUM, \
+      FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_INPUT_SWITCHES, NUM_DIGITAL_INPUTS, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_OUTPUT_SWITCHES, NUM_DIGITAL_OUTPUTS, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_PWM_OUTPUTS, NUM_PWM_OUTPUTS, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_BUZZERS, NUM_BUZZERS, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_TEMP_SENSORS, NUM_TEMP_SENSORS, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_HEATERS, NUM_HEATERS, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_STEPPERS, NUM_STEPPERS, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, UINT8, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_QUEUE_STATUS_TRAILER, QUEUE_STATUS_TRAILER, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, BOOL, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_CONFIG_LEAF_SYSTEM_HEATER_POWER_BUDGET, HEATER_POWER_BUDGET, \
+      FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG, LEAF_OPERATIONS_READWRITEABLE, INT16, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_OPERATION_LEAF_RESET_EEPROM, RESET_EEPROM, \
+      FIRMWARE_CONFIG_TYPE_OPERATION, FIRMWARE_CONFIG_OPS_WRITEABLE, STRING, \
+      NO_ACCESSOR, NO_ACCESSOR)
+
+//
+// Statistics and debug
+//
+#define CONFIG_SCHEMA_STATISTICS_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_STATS_LEAF_RX_PACKET_COUNT, RX_COUNT, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, INVALID, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_STATS_LEAF_RX_ERROR_COUNT, RX_ERROR, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, INVALID, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_STATS_LEAF_QUEUE_MEMORY, QUEUE_MEMORY, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, INVALID, \
+      NO_ACCESSOR, NO_ACCESSOR)
+
+#define CONFIG_SCHEMA_DEBUG_LEAVES(LEAF) \
+  LEAF(NODE_TYPE_DEBUG_LEAF_STACK_MEMORY, STACK_MEMORY, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, INVALID, \
+      NO_ACCESSOR, NO_ACCESSOR) \
+  LEAF(NODE_TYPE_DEBUG_LEAF_STACK_LOW_WATER_MARK, STACK_LOW_WATER_MARK, \
+      FIRMWARE_CONFIG_TYPE_STATUS, FIRMWARE_CONFIG_OPS_READABLE, INVALID, \
+      NO_ACCESSOR, NO_ACCESSOR)
+
+#endif
@@ -22,6 +22,7 @@
 #include "temperature_ISR.h"
 #include "response.h"
 #include "initial_pin_state.h"
+#include "events.h"
 
 extern uint8_t checkAnalogOrDigitalPin(uint8_t pin);
 
@@ -29,6 +30,9 @@ uint8_t Device_Heater::num_heaters = 0;
 
 Device_Heater::HeaterInfo *Device_Heater::heater_info_array;
 
+int16_t Device_Heater::power_budget = 0;
+uint8_t *Device_Heater::power_priority_order;
+
 uint8_t Device_Heater::soft_pwm_device_bitmask;
 SoftPwmState *Device_Heater::soft_pwm_state;
 
@@ -50,7 +54,7 @@ uint8_t Device_Heater::Init(uint8_t num_devices)
     return PARAM_APP_ERROR_TYPE_FAILED;
   }
 
-  uint8_t *memory = (uint8_t*)malloc(num_devices * sizeof(HeaterInfo));
+  uint8_t *memory = (uint8_t*)malloc(num_devices * (sizeof(HeaterInfo) + sizeof(*power_priority_order)));
   if (memory == 0)
   {
     generate_response_msg_addPGM(PMSG(MSG_ERR_INSUFFICIENT_MEMORY));
@@ -58,6 +62,7 @@ uint8_t Device_Heater::Init(uint8_t num_devices)
   }
 
   heater_info_array = (HeaterInfo *) memory;
+  power_priority_order = memory + num_devices * sizeof(HeaterInfo);
      
   for (i=0; i<num_devices; i++)
   {
@@ -68,7 +73,18 @@ uint8_t Device_Heater::Init(uint8_t num_devices)
     heater_info_array[i].max_temp = SENSOR_TEMPERATURE_INVALID;
     heater_info_array[i].target_temp = SENSOR_TEMPERATURE_INVALID;
     heater_info_array[i].power_on_level = DEFAULT_HEATER_POWER_ON_LEVEL;
+    heater_info_array[i].power = 0;
+    heater_info_array[i].requested_power = 0;
+    heater_info_array[i].power_priority = DEFAULT_HEATER_POWER_PRIORITY;
     heater_info_array[i].is_heating = false;
+    heater_info_array[i].raw_thresholds_stale = true;
+    heater_info_array[i].runaway_period = DEFAULT_HEATER_RUNAWAY_PERIOD;
+    heater_info_array[i].runaway_rise = DEFAULT_HEATER_RUNAWAY_RISE;
+    heater_info_array[i].runaway_deviation = DEFAULT_HEATER_RUNAWAY_DEVIATION;
+    heater_info_array[i].runaway_state = HEATER_RUNAWAY_STATE_START;
+    heater_info_array[i].autotune_state = HEATER_AUTOTUNE_STATE_IDLE;
+    heater_info_array[i].autotune = 0;
+    power_priority_order[i] = i;
   }
   
   soft_pwm_state = 0;
@@ -109,15 +125,18 @@ uint8_t Device_Heater::SetTempSensor(uint8_t heater_device_number, uint8_t senso
   if (sensor_device_number >= Device_TemperatureSensor::GetNumDevices())
     return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
 
+  heater_info_array[heater_device_number].temp_sensor = sensor_device_number;
+  heater_info_array[heater_device_number].raw_thresholds_stale = true;
+
   if (PID_dT == 0.0)
   {
-    // calculate sampling period of the temperature sensor routine
-    // (if there are more than 8 temperature sensors, it takes
-    // more than 8ms to read them all)
-    PID_dT = (float)(OVERSAMPLENR * min(8, Device_TemperatureSensor::GetNumDevices())) / (F_CPU / 64.0 / 256.0);
+    // sampling period of the temperature sensor routine
+    UpdateSamplingPeriod();
   }    
-  
-  heater_info_array[heater_device_number].temp_sensor = sensor_device_number;
+  else
+  {
+    UpdatePidDerivedConfig(&heater_info_array[heater_device_number]);
+  }
   return APP_ERROR_TYPE_SUCCESS;
 }
 
@@ -170,6 +189,7 @@ uint8_t Device_Heater::SetControlMode(uint8_t device_number, uint8_t mode)
   }
     
   heater_info_array[device_number].control_mode = mode;
+  heater_info_array[device_number].raw_thresholds_stale = true;
   return APP_ERROR_TYPE_SUCCESS;
 }
 
@@ -221,15 +241,96 @@ uint8_t Device_Heater::EnableSoftPwm(uint8_t device_number, bool enable)
   return APP_ERROR_TYPE_SUCCESS;
 }
 
-uint8_t Device_Heater::SetMaxTemperature(uint8_t device_number, float temp)
+uint8_t Device_Heater::SetMaxTemperature(uint8_t device_number, int16_t temp)
 {
   if (device_number >= num_heaters)
     return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
   
-  if (temp <= 0)
+  if (temp <= 0 || temp > MAX_TEMPERATURE_DEGREES)
     return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
   
-  heater_info_array[device_number].max_temp = temp;
+  heater_info_array[device_number].max_temp = DEGREES_TO_TEMPERATURE(temp);
+  heater_info_array[device_number].raw_thresholds_stale = true;
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_Heater::SetPowerBudget(int16_t budget)
+{
+  if (budget < 0)
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  
+  power_budget = budget;
+  if (budget == 0)
+  {
+    // restore any heaters which were being limited
+    for (uint8_t i = 0; i < num_heaters; i++)
+    {
+      HeaterInfo *heater_info = &heater_info_array[i];
+      CRITICAL_SECTION_START;
+      if (heater_info->power != heater_info->requested_power)
+        WriteHeaterPower(heater_info, heater_info->requested_power);
+      CRITICAL_SECTION_END;
+    }
+  }
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_Heater::SetPowerPriority(uint8_t device_number, uint8_t priority)
+{
+  if (device_number >= num_heaters)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
+  
+  heater_info_array[device_number].power_priority = priority;
+  
+  // insertion sort by descending priority then ascending device number
+  for (uint8_t i = 0; i < num_heaters; i++)
+  {
+    const uint8_t device = i;
+    uint8_t j = i;
+    while (j > 0)
+    {
+      const uint8_t prev_device = power_priority_order[j - 1];
+      if (heater_info_array[prev_device].power_priority >= heater_info_array[device].power_priority)
+        break;
+      power_priority_order[j] = prev_device;
+      j -= 1;
+    }
+    power_priority_order[j] = device;
+  }
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_Heater::SetRunawayPeriod(uint8_t device_number, uint8_t period)
+{
+  if (device_number >= num_heaters)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
+  
+  heater_info_array[device_number].runaway_period = period;
+  heater_info_array[device_number].runaway_state = HEATER_RUNAWAY_STATE_START;
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_Heater::SetRunawayRise(uint8_t device_number, uint8_t temp_rise)
+{
+  if (device_number >= num_heaters)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
+  
+  heater_info_array[device_number].runaway_rise = temp_rise;
+  heater_info_array[device_number].runaway_state = HEATER_RUNAWAY_STATE_START;
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_Heater::SetRunawayDeviation(uint8_t device_number, uint8_t temp_range)
+{
+  if (device_number >= num_heaters)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
+  
+  if (temp_range == 0)
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  
+  heater_info_array[device_number].runaway_deviation = temp_range;
+  heater_info_array[device_number].runaway_state = HEATER_RUNAWAY_STATE_START;
+  heater_info_array[device_number].raw_thresholds_stale = true;
   return APP_ERROR_TYPE_SUCCESS;
 }
 
@@ -243,6 +344,7 @@ uint8_t Device_Heater::SetBangBangHysteresis(uint8_t device_number, uint8_t temp
     return PARAM_APP_ERROR_TYPE_INCORRECT_MODE;
     
   heater_info->control_info.bangbang.hysteresis = temp_range;
+  heater_info->raw_thresholds_stale = true;
   return APP_ERROR_TYPE_SUCCESS;
 }
 
@@ -282,7 +384,7 @@ uint8_t Device_Heater::SetPidDefaultKi(uint8_t device_number, float value)
   if (heater_info->control_mode != HEATER_CONTROL_MODE_PID)
     return PARAM_APP_ERROR_TYPE_INCORRECT_MODE;
     
-  heater_info->control_info.pid->Ki = value * PID_dT;
+  heater_info->control_info.pid->Ki = value;
   UpdatePidDerivedConfig(heater_info);
   return APP_ERROR_TYPE_SUCCESS;
 }
@@ -296,13 +398,13 @@ uint8_t Device_Heater::SetPidDefaultKd(uint8_t device_number, float value)
   if (heater_info->control_mode != HEATER_CONTROL_MODE_PID)
     return PARAM_APP_ERROR_TYPE_INCORRECT_MODE;
     
-  heater_info->control_info.pid->Kd = value / PID_dT;
+  heater_info->control_info.pid->Kd = value;
   UpdatePidDerivedConfig(heater_info);
   return APP_ERROR_TYPE_SUCCESS;
 }
 
 
-uint8_t Device_Heater::ValidateTargetTemperature(uint8_t device_number, float temp)
+uint8_t Device_Heater::ValidateTargetTemperature(uint8_t device_number, temperature_t temp)
 {
   if (device_number >= num_heaters
       || heater_info_array[device_number].heater_pin == 0xFF)
@@ -332,15 +434,24 @@ void Device_Heater::UpdateHeaters()
   HeaterInfo *heater_info = heater_info_array;
   for (uint8_t i=0; i<num_heaters; i++)
   {
-    float target_temp = heater_info->target_temp;
-    if (target_temp != SENSOR_TEMPERATURE_INVALID)
+    CRITICAL_SECTION_START;
+    const temperature_t target_temp = heater_info->target_temp;
+    CRITICAL_SECTION_END;
+    if (heater_info->autotune_state == HEATER_AUTOTUNE_STATE_RUNNING)
+    {
+      StepPidAutotune(heater_info);
+    }
+    else if (target_temp != SENSOR_TEMPERATURE_INVALID)
     {
+      if (heater_info->raw_thresholds_stale)
+        UpdateRawThresholds(heater_info);
+        
       // Check if temperature is within the correct range
-      float current_temp = Device_TemperatureSensor::ReadCurrentTemperature(heater_info->temp_sensor);
-      if (current_temp > heater_info->max_temp || current_temp == SENSOR_TEMPERATURE_INVALID)
+      const uint16_t current_key = Device_TemperatureSensor::ReadCurrentRawKey(heater_info->temp_sensor);
+      if (current_key >= heater_info->max_temp_key || current_key < heater_info->min_valid_key)
       {
-        // TODO handle heater error.
-        if (current_temp == SENSOR_TEMPERATURE_INVALID)
+        raise_event(PARAM_EVENT_TYPE_HEATER_FAULT, i);
+        if (current_key < heater_info->min_valid_key)
           ERROR("Heater Read Error: ");
         else
           ERROR("Heater overtemp Error: ");
@@ -348,19 +459,26 @@ void Device_Heater::UpdateHeaters()
         heater_info->target_temp = SENSOR_TEMPERATURE_INVALID;
         SetHeaterPower(heater_info, 0);
       }
+      else if (heater_info->runaway_period != 0 && CheckThermalRunaway(heater_info, current_key))
+      {
+        raise_event(PARAM_EVENT_TYPE_HEATER_FAULT, i);
+        ERROR("Heater thermal runaway Error: ");
+        ERRORLN((int)i);
+        emergency_stop(PARAM_STOPPED_CAUSE_THERMAL_ERROR); // turns off all heaters
+      }
       else if (heater_info->control_mode == HEATER_CONTROL_MODE_BANG_BANG)
       {
         // Bang Bang Mode
         if (heater_info->is_heating)
         {
-          if (current_temp > target_temp + heater_info->control_info.bangbang.hysteresis)
+          if (current_key >= heater_info->heat_off_key)
           {
             SetHeaterPower(heater_info, 0);
           }
         }
         else 
         {
-          if (current_temp < target_temp - heater_info->control_info.bangbang.hysteresis)
+          if (current_key < heater_info->heat_on_key)
           {
             SetHeaterPower(heater_info, heater_info->power_on_level);
           }
@@ -372,53 +490,68 @@ void Device_Heater::UpdateHeaters()
         PidInfo *pid_info = heater_info->control_info.pid;
         uint8_t pid_power;
         
-        float pid_error = target_temp - current_temp;
-        if (pid_error > pid_info->functional_range)
+        const temperature_t current_temp = Device_TemperatureSensor::ReadCurrentTemperature(heater_info->temp_sensor);
+        const int16_t functional_range = (int16_t)pid_info->functional_range << TEMPERATURE_FRACTION_BITS;
+        const int16_t pid_error = target_temp - current_temp;
+        if (pid_error > functional_range)
         {
           pid_power = heater_info->power_on_level;
-          pid_info->state_iState = 0.0; // reset PID state
+          pid_info->state_iState = 0; // reset PID state
         }
-        else if(pid_error < -(pid_info->functional_range)) 
+        else if(pid_error < -functional_range) 
         {
           pid_power = 0;
-          pid_info->state_iState = 0.0; // reset PID state
+          pid_info->state_iState = 0; // reset PID state
         }
         else 
         {
           // update and constrain iState
-          pid_info->state_iState += pid_error;
+          pid_info->state_iState += pid_info->Ki_fixed * pid_error;
           if (pid_info->state_iState > pid_info->iState_max)
             pid_info->state_iState = pid_info->iState_max;
-          else if (pid_info->state_iState < 0.0)
-            pid_info->state_iState = 0.0;
+          else if (pid_info->state_iState < 0)
+            pid_info->state_iState = 0;
             
-          pid_info->state_dTerm = ((current_temp - pid_info->last_temp) * pid_info->KdK2) 
-                                    + (pid_info->advanced_K1 * pid_info->state_dTerm);
-
-          float pTerm = pid_info->Kp * pid_error;
-          float iTerm = pid_info->Ki * pid_info->state_iState;
-          float pid_output = pTerm + iTerm - pid_info->state_dTerm;
+          int16_t temp_change = current_temp - pid_info->last_temp;
+          if (temp_change > PID_MAX_TEMPERATURE_CHANGE)
+            temp_change = PID_MAX_TEMPERATURE_CHANGE;
+          else if (temp_change < -PID_MAX_TEMPERATURE_CHANGE)
+            temp_change = -PID_MAX_TEMPERATURE_CHANGE;
+          
+          // dTerm = KdK2 * change + K1 * dTerm (the K1 product drops the dTerm's 8 least 
+          // significant bits, i.e. ~1/16 of a power level, to stay within 32 bits)
+          int32_t dTerm = pid_info->KdK2_fixed * temp_change 
+                            + (((pid_info->state_dTerm >> 8) * pid_info->K1_fixed) >> 8);
+          if (dTerm > PID_MAX_DTERM)
+            dTerm = PID_MAX_DTERM;
+          else if (dTerm < -PID_MAX_DTERM)
+            dTerm = -PID_MAX_DTERM;
+          pid_info->state_dTerm = dTerm;
+
+          const int32_t pTerm = pid_info->Kp_fixed * pid_error;
+          const int32_t iTerm = pid_info->state_iState >> (PID_INTEGRAL_FRACTION_BITS - PID_OUTPUT_FRACTION_BITS);
+          const int32_t pid_output = (pTerm + iTerm - dTerm) >> PID_OUTPUT_FRACTION_BITS;
           
-          if (pid_output >= (float)pid_info->advanced_max_pid_power_level)
+          if (pid_output >= pid_info->advanced_max_pid_power_level)
             pid_power = pid_info->advanced_max_pid_power_level;
-          else if (pid_output <= 0.0)
+          else if (pid_output <= 0)
             pid_power = 0;
           else 
             pid_power = (uint8_t)pid_output;
 
           #ifdef PID_DEBUG
           DEBUG(" PIDDEBUG ");
-          DEBUG(e);
+          DEBUG((int)i);
           DEBUG(": Input ");
-          DEBUG(current_temp);
+          DEBUG(TEMPERATURE_TO_DEGREES(current_temp));
           DEBUG(" Output ");
           DEBUG(pid_output);
           DEBUG(" pTerm ");
-          DEBUG(pTerm);
+          DEBUG(pTerm >> PID_OUTPUT_FRACTION_BITS);
           DEBUG(" iTerm ");
-          DEBUG(iTerm);
+          DEBUG(iTerm >> PID_OUTPUT_FRACTION_BITS);
           DEBUG(" dTerm ");
-          DEBUG(pid_info->state_dTerm);  
+          DEBUG(dTerm >> PID_OUTPUT_FRACTION_BITS);  
           #endif //PID_DEBUG
         }
         pid_info->last_temp = current_temp; 
@@ -427,6 +560,182 @@ void Device_Heater::UpdateHeaters()
     }
     heater_info += 1;
   }
+  
+  if (power_budget != 0)
+    ApplyPowerBudget();
+}
+
+// Gives each heater its requested power (or what is left of the budget) in priority order
+void Device_Heater::ApplyPowerBudget()
+{
+  int16_t remaining_budget = power_budget;
+  for (uint8_t i = 0; i < num_heaters; i++)
+  {
+    HeaterInfo *heater_info = &heater_info_array[power_priority_order[i]];
+    if (heater_info->heater_pin == 0xFF)
+      continue;
+    
+    // the requested power can be set to 0 from an ISR (e.g., on an emergency stop)
+    CRITICAL_SECTION_START;
+    uint8_t power = heater_info->requested_power;
+    if (power > remaining_budget)
+      power = remaining_budget;
+    if (power != heater_info->power)
+      WriteHeaterPower(heater_info, power);
+    CRITICAL_SECTION_END;
+    remaining_budget -= power;
+  }
+}
+
+void Device_Heater::UpdateRawThresholds(HeaterInfo *heater_info)
+{
+  const uint8_t sensor = heater_info->temp_sensor;
+  
+  // the target temperature can be changed from the movement interrupt, so the flag
+  // is cleared before the target is copied (a later change then marks it stale again)
+  CRITICAL_SECTION_START;
+  heater_info->raw_thresholds_stale = false;
+  const temperature_t target_temp = heater_info->target_temp;
+  CRITICAL_SECTION_END;
+  
+  // a condition of temp > X is checked as key >= TemperatureToRawKey(X + 1)
+  heater_info->min_valid_key = Device_TemperatureSensor::TemperatureToRawKey(sensor, 1);
+  heater_info->max_temp_key = Device_TemperatureSensor::TemperatureToRawKey(sensor, heater_info->max_temp + 1);
+  if (heater_info->control_mode == HEATER_CONTROL_MODE_BANG_BANG)
+  {
+    const int16_t hysteresis = (int16_t)heater_info->control_info.bangbang.hysteresis << TEMPERATURE_FRACTION_BITS;
+    heater_info->heat_on_key = Device_TemperatureSensor::TemperatureToRawKey(sensor, target_temp - hysteresis);
+    heater_info->heat_off_key = Device_TemperatureSensor::TemperatureToRawKey(sensor, target_temp + hysteresis + 1);
+  }
+  const int16_t deviation = (int16_t)heater_info->runaway_deviation << TEMPERATURE_FRACTION_BITS;
+  heater_info->runaway_low_key = Device_TemperatureSensor::TemperatureToRawKey(sensor, target_temp - deviation);
+}
+
+// Returns true if the heater has failed to heat as expected. While heating, the 
+// temperature has to rise by runaway_rise degrees in each runaway_period (which catches a 
+// heater or sensor which has become detached or a failed heater). Once within 
+// runaway_deviation of the target, the temperature may not stay below that band for 
+// longer than runaway_period (which catches the same failures once at temperature).
+// A heater held back by the power budget is still supervised, but only needs to rise 
+// in proportion to the power it was actually given.
+bool Device_Heater::CheckThermalRunaway(HeaterInfo *heater_info, uint16_t current_key)
+{
+  const uint32_t now = millis();
+  const bool in_band = (current_key >= heater_info->runaway_low_key);
+  
+  heater_info->runaway_power_sum += heater_info->power;
+  heater_info->runaway_requested_sum += heater_info->requested_power;
+  
+  switch (heater_info->runaway_state)
+  {
+  case HEATER_RUNAWAY_STATE_START:
+    if (in_band)
+    {
+      heater_info->runaway_state = HEATER_RUNAWAY_STATE_STABLE;
+      heater_info->runaway_watch_time = now;
+    }
+    else
+    {
+      heater_info->runaway_state = HEATER_RUNAWAY_STATE_HEATING;
+      StartRunawayWatch(heater_info, now);
+    }
+    break;
+    
+  case HEATER_RUNAWAY_STATE_HEATING:
+    if (in_band)
+    {
+      heater_info->runaway_state = HEATER_RUNAWAY_STATE_STABLE;
+      heater_info->runaway_watch_time = now;
+    }
+    else 
+    {
+      return CheckRunawayRise(heater_info, now);
+    }
+    break;
+    
+  default: // HEATER_RUNAWAY_STATE_STABLE
+    if (in_band)
+    {
+      heater_info->runaway_watch_time = now;
+      heater_info->runaway_power_sum = heater_info->runaway_requested_sum = 0;
+    }
+    else if (now - heater_info->runaway_watch_time >= (uint32_t)heater_info->runaway_period * 1000)
+    {
+      if (heater_info->runaway_power_sum >= heater_info->runaway_requested_sum)
+        return true;
+      // the heater was held back while it fell out of the band, so it has to heat back 
+      // up at the rate allowed by its power instead
+      heater_info->runaway_state = HEATER_RUNAWAY_STATE_HEATING;
+      StartRunawayWatch(heater_info, now);
+    }
+    break;
+  }
+  return false;
+}
+
+// Starts a heating watch period from the current temperature
+void Device_Heater::StartRunawayWatch(HeaterInfo *heater_info, uint32_t now)
+{
+  heater_info->runaway_watch_temp = ReadCurrentTemperature(heater_info->device_number);
+  heater_info->runaway_watch_time = now;
+  heater_info->runaway_power_sum = heater_info->runaway_requested_sum = 0;
+}
+
+// Returns true if a heating watch period is over and the temperature has not risen by 
+// runaway_rise (scaled by the fraction of the requested power which was output)
+bool Device_Heater::CheckRunawayRise(HeaterInfo *heater_info, uint32_t now)
+{
+  if (now - heater_info->runaway_watch_time < (uint32_t)heater_info->runaway_period * 1000)
+    return false;
+    
+  // only converted once per period
+  const temperature_t current_temp = ReadCurrentTemperature(heater_info->device_number);
+  int16_t rise = (int16_t)heater_info->runaway_rise << TEMPERATURE_FRACTION_BITS;
+  uint32_t power_sum = heater_info->runaway_power_sum;
+  uint32_t requested_sum = heater_info->runaway_requested_sum;
+  if (power_sum < requested_sum)
+  {
+    // keep the sums small enough for the fraction to be calculated in 32 bits
+    while (requested_sum > 0xFFFFFF)
+    {
+      power_sum >>= 1;
+      requested_sum >>= 1;
+    }
+    rise = ((int32_t)rise * (int16_t)((power_sum << 8) / requested_sum)) >> 8;
+  }
+  // (a heater given no power in the period is not expected to rise)
+  if (rise > 0 && current_temp - heater_info->runaway_watch_temp < rise)
+    return true;
+  
+  heater_info->runaway_watch_temp = current_temp;
+  heater_info->runaway_watch_time = now;
+  heater_info->runaway_power_sum = heater_info->runaway_requested_sum = 0;
+  return false;
+}
+
+void Device_Heater::InvalidateRawThresholds()
+{
+  for (uint8_t i = 0; i < num_heaters; i++)
+    heater_info_array[i].raw_thresholds_stale = true;
+}
+
+void Device_Heater::UpdateSamplingPeriod()
+{
+  PID_dT = Device_TemperatureSensor::GetSamplingPeriod();
+    
+  // the fixed point gains are per sample so need to be recalculated
+  for (uint8_t i=0; i<num_heaters; i++)
+    UpdatePidDerivedConfig(&heater_info_array[i]);
+}
+
+static int32_t to_fixed_pid_gain(float value, float scale)
+{
+  const float fixed_value = value * scale + 0.5;
+  if (fixed_value >= PID_MAX_FIXED_GAIN)
+    return PID_MAX_FIXED_GAIN;
+  if (fixed_value <= 0.0)
+    return 0;
+  return (int32_t)fixed_value;
 }
 
 void Device_Heater::UpdatePidDerivedConfig(HeaterInfo *heater_info)
@@ -435,152 +744,216 @@ void Device_Heater::UpdatePidDerivedConfig(HeaterInfo *heater_info)
     return;
   PidInfo *pid_info = heater_info->control_info.pid;
   
-  pid_info->iState_max = pid_info->advanced_max_pid_power_level / pid_info->Ki;  
-  pid_info->KdK2 = pid_info->Kd * (1.0 - pid_info->advanced_K1);  
+  // gains are converted to output units per temperature unit 
+  const float output_scale = (float)(1L << PID_OUTPUT_FRACTION_BITS) / TEMPERATURE_ONE_DEGREE;
+  const float integral_scale = (float)(1L << PID_INTEGRAL_FRACTION_BITS) / TEMPERATURE_ONE_DEGREE;
+  
+  pid_info->Kp_fixed = to_fixed_pid_gain(pid_info->Kp, output_scale);
+  if (PID_dT != 0.0)
+  {
+    pid_info->Ki_fixed = to_fixed_pid_gain(pid_info->Ki * PID_dT, integral_scale);
+    pid_info->KdK2_fixed = to_fixed_pid_gain(pid_info->Kd * (1.0 - pid_info->advanced_K1) / PID_dT, output_scale);
+  }
+  else
+  {
+    // no sampling period until the heater's sensor is configured
+    pid_info->Ki_fixed = 0;
+    pid_info->KdK2_fixed = 0;
+  }
+  const float K1 = pid_info->advanced_K1 * 65536.0 + 0.5;
+  pid_info->K1_fixed = (K1 >= 65535.0) ? 0xFFFF : ((K1 <= 0.0) ? 0 : (uint16_t)K1);
+  pid_info->iState_max = (int32_t)pid_info->advanced_max_pid_power_level << PID_INTEGRAL_FRACTION_BITS;  
   
-  InitializePidState(heater_info);
+  if (heater_info->temp_sensor != 0xFF)
+    InitializePidState(heater_info);
 }
 
 //
 // Copied largely unchanged from Marlin
 //
-void Device_Heater::DoPidAutotune(uint8_t device_number, float temp, int ncycles)
-{
-  float input = 0.0;
-  int cycles = 0;
-  bool heating = true;
-
-  unsigned long temp_millis = millis();
-  unsigned long t1=temp_millis;
-  unsigned long t2=temp_millis;
-  long t_high = 0;
-  long t_low = 0;
-
-  long bias, d;
-  float Ku, Tu;
-  float Kp, Ki, Kd;
-  float max = 0;
-  float min = 10000;
-  uint8_t p;
-  uint8_t i;
+uint8_t Device_Heater::StartPidAutotune(uint8_t device_number, temperature_t temp, uint8_t ncycles)
+{
+  if (device_number >= num_heaters)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
 
-  extern volatile bool temp_meas_ready;
+  HeaterInfo *heater_info = &heater_info_array[device_number];
+  AutotuneInfo *autotune = heater_info->autotune;
+  if (autotune == 0)
+  {
+    if ((autotune = (AutotuneInfo *)malloc(sizeof(AutotuneInfo))) == 0)
+    {
+      generate_response_msg_addPGM(PMSG(MSG_ERR_INSUFFICIENT_MEMORY));
+      return PARAM_APP_ERROR_TYPE_FAILED;
+    }
+    heater_info->autotune = autotune;
+  }
+  
+  // the autotune controls the heater instead of the target temperature
+  SetTargetTemperature(device_number, SENSOR_TEMPERATURE_INVALID);
+  
+  const uint32_t now = millis();
+  autotune->target_temp = temp;
+  autotune->ncycles = ncycles;
+  autotune->cycles = 0;
+  autotune->heating = true;
+  autotune->bias = autotune->d = autotune->power = heater_info->power_on_level;
+  autotune->max_temp = 0;
+  autotune->min_temp = DEGREES_TO_TEMPERATURE(MAX_TEMPERATURE_DEGREES);
+  autotune->t1 = autotune->t2 = now;
+  autotune->t_high = autotune->t_low = 0;
+  autotune->Kp = autotune->Ki = autotune->Kd = NAN;
+  
+  DEBUGPGM("PID Autotune start: ");
+  DEBUGLN((int)device_number);
   
-  DEBUGLNPGM("PID Autotune start");
+  SetHeaterPower(heater_info, autotune->power);
+  StartRunawayWatch(heater_info, now);
+  heater_info->autotune_state = HEATER_AUTOTUNE_STATE_RUNNING;
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_Heater::GetPidAutotuneCycle(uint8_t device_number)
+{
+  const AutotuneInfo *autotune = heater_info_array[device_number].autotune;
+  return (autotune != 0) ? autotune->cycles : 0;
+}
+
+float Device_Heater::GetPidAutotuneKp(uint8_t device_number)
+{
+  const AutotuneInfo *autotune = heater_info_array[device_number].autotune;
+  return (autotune != 0) ? autotune->Kp : NAN;
+}
+
+float Device_Heater::GetPidAutotuneKi(uint8_t device_number)
+{
+  const AutotuneInfo *autotune = heater_info_array[device_number].autotune;
+  return (autotune != 0) ? autotune->Ki : NAN;
+}
+
+float Device_Heater::GetPidAutotuneKd(uint8_t device_number)
+{
+  const AutotuneInfo *autotune = heater_info_array[device_number].autotune;
+  return (autotune != 0) ? autotune->Kd : NAN;
+}
+
+// Relay (bang bang around the target) autotune, called once per temperature sample.
+// Each cycle the bias and amplitude of the power swing are adjusted so that the heating
+// and cooling phases are balanced and from the third cycle the ultimate gain and period 
+// of the oscillation give the classic Ziegler-Nichols PID values.
+void Device_Heater::StepPidAutotune(HeaterInfo *heater_info)
+{
+  AutotuneInfo *autotune = heater_info->autotune;
+  const uint8_t device_number = heater_info->device_number;
   
-  // switch off all heaters during auto-tune
-  for (i=0; i<Device_Heater::GetNumDevices(); i++)
+  if (heater_info->raw_thresholds_stale)
+    UpdateRawThresholds(heater_info);
+  const uint16_t current_key = Device_TemperatureSensor::ReadCurrentRawKey(heater_info->temp_sensor);
+  if (current_key >= heater_info->max_temp_key || current_key < heater_info->min_valid_key)
   {
-    if (Device_Heater::IsInUse(i))
-      Device_Heater::SetHeaterPower(&heater_info_array[device_number], 0);
+    raise_event(PARAM_EVENT_TYPE_HEATER_FAULT, device_number);
+    ERRORLNPGM("PID Autotune failed! Heater fault");
+    FinishPidAutotune(heater_info, HEATER_AUTOTUNE_STATE_FAILED);
+    return;
   }
-
-  HeaterInfo *heater_info = &heater_info_array[device_number];
   
-  bias = d = p = heater_info->power_on_level;
-  SetHeaterPower(heater_info, p);
+  const uint32_t now = millis();
+  const temperature_t input = ReadCurrentTemperature(device_number);
+  const temperature_t temp = autotune->target_temp;
 
-  for(;;) 
+  // the heating phases are supervised in the same way as a heater heating to its target
+  if (autotune->heating && heater_info->runaway_period != 0)
   {
-    if(temp_meas_ready == true) 
-    { // temp sample ready
-      Device_TemperatureSensor::UpdateTemperatureSensors();
-
-      input = Device_Heater::ReadCurrentTemperature(device_number);
-
-      max=max(max,input);
-      min=min(min,input);
-      if(heating == true && input > temp) 
-      {
-        if(millis() - t2 > 5000) 
-        { 
-          heating=false;
-          p = bias - d;
-          SetHeaterPower(heater_info, p);
-          t1=millis();
-          t_high=t1 - t2;
-          max=temp;
-        }
-      }
-      if(heating == false && input < temp) 
-      {
-        if(millis() - t1 > 5000) {
-          heating=true;
-          t2=millis();
-          t_low=t2 - t1;
-          if(cycles > 0) {
-            bias += (d*(t_high - t_low))/(t_low + t_high);
-            bias = constrain(bias, 20 ,heater_info->power_on_level-20);
-            if (bias > heater_info->power_on_level/2) 
-              d = heater_info->power_on_level - 1 - bias;
-            else 
-              d = bias;
-
-            DEBUGPGM(" bias: "); DEBUG_F(bias, DEC);
-            DEBUGPGM(" d: "); DEBUG_F(d, DEC);
-            DEBUGPGM(" min: "); DEBUG(min);
-            DEBUGPGM(" max: "); DEBUGLN(max);
-            
-            if(cycles > 2) 
-            {
-              Ku = (4.0*d)/(3.14159*(max-min)/2.0);
-              Tu = ((float)(t_low + t_high)/1000.0);
-              DEBUGPGM(" Ku: "); DEBUG(Ku);
-              DEBUGPGM(" Tu: "); DEBUGLN(Tu);
-              Kp = 0.6*Ku;
-              Ki = 2*Kp/Tu;
-              Kd = Kp*Tu/8;
-              DEBUGLNPGM(" Clasic PID ");
-              DEBUGPGM(" Kp: "); DEBUGLN(Kp);
-              DEBUGPGM(" Ki: "); DEBUGLN(Ki);
-              DEBUGPGM(" Kd: "); DEBUGLN(Kd);
-              /*
-              Kp = 0.33*Ku;
-              Ki = Kp/Tu;
-              Kd = Kp*Tu/3;
-              DEBUGLNPGM(" Some overshoot ")
-              DEBUGPGM(" Kp: "); DEBUGLN(Kp);
-              DEBUGPGM(" Ki: "); DEBUGLN(Ki);
-              DEBUGPGM(" Kd: "); DEBUGLN(Kd);
-              Kp = 0.2*Ku;
-              Ki = 2*Kp/Tu;
-              Kd = Kp*Tu/3;
-              DEBUGLNPGM(" No overshoot ")
-              DEBUGPGM(" Kp: "); DEBUGLN(Kp);
-              DEBUGPGM(" Ki: "); DEBUGLN(Ki);
-              DEBUGPGM(" Kd: "); DEBUGLN(Kd);
-              */
-            }
-          }
-          p = bias + d;
-          SetHeaterPower(heater_info, p);
-          cycles++;
-          min=temp;
-        }
-      } 
-    }
-    if(input > (temp + 20)) 
+    heater_info->runaway_power_sum += heater_info->power;
+    heater_info->runaway_requested_sum += heater_info->requested_power;
+    if (input <= temp && CheckRunawayRise(heater_info, now))
     {
-      ERRORLNPGM("PID Autotune failed! Temperature too high");
+      raise_event(PARAM_EVENT_TYPE_HEATER_FAULT, device_number);
+      ERRORLNPGM("PID Autotune failed! Heater thermal runaway");
+      FinishPidAutotune(heater_info, HEATER_AUTOTUNE_STATE_FAILED);
+      emergency_stop(PARAM_STOPPED_CAUSE_THERMAL_ERROR); // turns off all heaters
       return;
     }
-    if(millis() - temp_millis > 2000) 
-    {
-      DEBUGLNPGM("ok T:");
-      DEBUG(input);   
-      DEBUGPGM(" @:");
-      DEBUGLN(p);       
-      temp_millis = millis();
-    }
-    if(((millis() - t1) + (millis() - t2)) > (10L*60L*1000L*2L)) 
-    {
-      ERRORLNPGM("PID Autotune failed! timeout");
-      return;
+  }
+
+  autotune->max_temp = max(autotune->max_temp, input);
+  autotune->min_temp = min(autotune->min_temp, input);
+  if (autotune->heating && input > temp) 
+  {
+    if (now - autotune->t2 > 5000) 
+    { 
+      autotune->heating = false;
+      autotune->power = autotune->bias - autotune->d;
+      SetHeaterPower(heater_info, autotune->power);
+      autotune->t1 = now;
+      autotune->t_high = autotune->t1 - autotune->t2;
+      autotune->max_temp = temp;
     }
-    if(cycles > ncycles) 
+  }
+  if (!autotune->heating && input < temp) 
+  {
+    if (now - autotune->t1 > 5000) 
     {
-      DEBUGLNPGM("PID Autotune finished! Record the last Kp, Ki and Kd constants");
-      return;
+      autotune->heating = true;
+      autotune->t2 = now;
+      StartRunawayWatch(heater_info, now);
+      autotune->t_low = autotune->t2 - autotune->t1;
+      if (autotune->cycles > 0) 
+      {
+        const int16_t power_on_level = heater_info->power_on_level;
+        int32_t bias = autotune->bias + ((int32_t)autotune->d * (autotune->t_high - autotune->t_low)) 
+                                          / (autotune->t_low + autotune->t_high);
+        bias = constrain(bias, 20, power_on_level - 20);
+        autotune->bias = bias;
+        if (bias > power_on_level/2) 
+          autotune->d = power_on_level - 1 - bias;
+        else 
+          autotune->d = bias;
+
+        DEBUGPGM(" bias: "); DEBUG_F(autotune->bias, DEC);
+        DEBUGPGM(" d: "); DEBUG_F(autotune->d, DEC);
+        DEBUGPGM(" min: "); DEBUG(TEMPERATURE_TO_DEGREES(autotune->min_temp));
+        DEBUGPGM(" max: "); DEBUGLN(TEMPERATURE_TO_DEGREES(autotune->max_temp));
+        
+        if (autotune->cycles > 2) 
+        {
+          const float Ku = (4.0*autotune->d)/(3.14159*TEMPERATURE_TO_DEGREES(autotune->max_temp - autotune->min_temp)/2.0);
+          const float Tu = ((float)(autotune->t_low + autotune->t_high)/1000.0);
+          DEBUGPGM(" Ku: "); DEBUG(Ku);
+          DEBUGPGM(" Tu: "); DEBUGLN(Tu);
+          autotune->Kp = 0.6*Ku;
+          autotune->Ki = 2*autotune->Kp/Tu;
+          autotune->Kd = autotune->Kp*Tu/8;
+          DEBUGLNPGM(" Clasic PID ");
+          DEBUGPGM(" Kp: "); DEBUGLN(autotune->Kp);
+          DEBUGPGM(" Ki: "); DEBUGLN(autotune->Ki);
+          DEBUGPGM(" Kd: "); DEBUGLN(autotune->Kd);
+        }
+      }
+      autotune->power = autotune->bias + autotune->d;
+      SetHeaterPower(heater_info, autotune->power);
+      autotune->cycles += 1;
+      autotune->min_temp = temp;
     }
+  } 
+  if (input > (temp + DEGREES_TO_TEMPERATURE(20))) 
+  {
+    ERRORLNPGM("PID Autotune failed! Temperature too high");
+    FinishPidAutotune(heater_info, HEATER_AUTOTUNE_STATE_FAILED);
+  }
+  else if (((now - autotune->t1) + (now - autotune->t2)) > (10L*60L*1000L*2L)) 
+  {
+    ERRORLNPGM("PID Autotune failed! timeout");
+    FinishPidAutotune(heater_info, HEATER_AUTOTUNE_STATE_FAILED);
+  }
+  else if (autotune->cycles > autotune->ncycles) 
+  {
+    DEBUGLNPGM("PID Autotune finished!");
+    FinishPidAutotune(heater_info, HEATER_AUTOTUNE_STATE_DONE);
   }
 }
+
+void Device_Heater::FinishPidAutotune(HeaterInfo *heater_info, uint8_t state)
+{
+  SetHeaterPower(heater_info, 0);
+  heater_info->autotune_state = state;
+}
@@ -32,8 +32,10 @@
 // Interfaces for Heaters devices.
 //
 // Notes: It is expected that features such as redundant temperature sensors
-// and temperature watch periods to detect sensor or heater failures can be
-// implemented in the host as they do not require tight real time co-ordination. 
+// can be implemented in the host as they do not require tight real time 
+// co-ordination. Thermal runaway supervision (a heater which fails to raise the
+// temperature or a temperature which falls away from the target) is done here
+// so that a fault is caught even when the host is slow or has gone away.
 //
 class Device_Heater
 {
@@ -46,11 +48,33 @@ public:
 
 #define DEFAULT_HEATER_POWER_ON_LEVEL            255 // == full current
 
+#define DEFAULT_HEATER_POWER_PRIORITY            0
+
 // Supported Control Modes
 #define HEATER_CONTROL_MODE_INVALID       0
 #define HEATER_CONTROL_MODE_PID           1
 #define HEATER_CONTROL_MODE_BANG_BANG     2
 
+// Thermal runaway supervision defaults: while heating the temperature must rise by 
+// DEFAULT_HEATER_RUNAWAY_RISE degrees every DEFAULT_HEATER_RUNAWAY_PERIOD seconds and
+// once near the target it may not stay more than DEFAULT_HEATER_RUNAWAY_DEVIATION 
+// degrees below the target for longer than the period. A period of 0 disables it.
+#define DEFAULT_HEATER_RUNAWAY_PERIOD            60 // seconds
+#define DEFAULT_HEATER_RUNAWAY_RISE              2  // degrees C
+#define DEFAULT_HEATER_RUNAWAY_DEVIATION         15 // degrees C
+
+// Thermal runaway supervision states
+#define HEATER_RUNAWAY_STATE_START        0 // target changed, state decided on next update
+#define HEATER_RUNAWAY_STATE_HEATING      1 // temperature must rise runaway_rise each period
+#define HEATER_RUNAWAY_STATE_STABLE       2 // temperature may not stay below the deviation band
+
+// PID autotune states
+#define HEATER_AUTOTUNE_STATE_IDLE        0 // never run on this heater
+#define HEATER_AUTOTUNE_STATE_RUNNING     1
+#define HEATER_AUTOTUNE_STATE_DONE        2 // results available
+#define HEATER_AUTOTUNE_STATE_FAILED      3
+#define HEATER_AUTOTUNE_STATE_ABORTED     4 // target temperature set or stopped while running
+
   static uint8_t Init(uint8_t num_pwm_devices);
   
   FORCE_INLINE static uint8_t GetNumDevices()
@@ -80,11 +104,16 @@ public:
     return heater_info_array[device_number].control_mode;
   }
   
-  FORCE_INLINE static float GetMaxTemperature(uint8_t device_number)
+  FORCE_INLINE static temperature_t GetMaxTemperature(uint8_t device_number)
   {
     return heater_info_array[device_number].max_temp;
   }
   
+  FORCE_INLINE static uint8_t GetPowerOnLevel(uint8_t device_number)
+  {
+    return heater_info_array[device_number].power_on_level;
+  }
+  
   FORCE_INLINE static bool GetSoftPwmState(uint8_t device_number)
   {
     if (device_number < sizeof(soft_pwm_device_bitmask)*8)
@@ -93,12 +122,32 @@ public:
       return false;
   }
 
-  FORCE_INLINE static float GetTargetTemperature(uint8_t device_number)
+  FORCE_INLINE static uint8_t GetHeaterPower(uint8_t device_number)
+  {
+    return heater_info_array[device_number].power;
+  }
+  
+  FORCE_INLINE static uint8_t GetRunawayPeriod(uint8_t device_number)
+  {
+    return heater_info_array[device_number].runaway_period;
+  }
+  
+  FORCE_INLINE static uint8_t GetRunawayRise(uint8_t device_number)
+  {
+    return heater_info_array[device_number].runaway_rise;
+  }
+  
+  FORCE_INLINE static uint8_t GetRunawayDeviation(uint8_t device_number)
+  {
+    return heater_info_array[device_number].runaway_deviation;
+  }
+  
+  FORCE_INLINE static temperature_t GetTargetTemperature(uint8_t device_number)
   {
     return heater_info_array[device_number].target_temp;
   }
   
-  FORCE_INLINE static float ReadCurrentTemperature(uint8_t device_number)
+  FORCE_INLINE static temperature_t ReadCurrentTemperature(uint8_t device_number)
   {
     return Device_TemperatureSensor::ReadCurrentTemperature(heater_info_array[device_number].temp_sensor);
   }
@@ -107,7 +156,7 @@ public:
   static uint8_t SetHeaterPin(uint8_t device_number, uint8_t heater_pin);
   static uint8_t SetTempSensor(uint8_t heater_device_number, uint8_t sensor_device_number);
   static uint8_t SetControlMode(uint8_t device_number, uint8_t mode);
-  static uint8_t SetMaxTemperature(uint8_t device_number, float temp);
+  static uint8_t SetMaxTemperature(uint8_t device_number, int16_t temp); // in degrees C
 
   // This sets the pwm power level used when the heater is on.
   // Setting this to anything other than 255 enables a form of PWM (soft or hard)
@@ -115,6 +164,26 @@ public:
   static uint8_t SetPowerOnLevel(uint8_t device_number, uint8_t level);
   static uint8_t EnableSoftPwm(uint8_t device_number, bool enable);
 
+  // Heater power budget. When set, the sum of the power levels (0-255 each) of all 
+  // heaters is limited to the budget with the heaters being given their requested power
+  // in order of priority (highest first, then by device number). A limited heater is 
+  // driven with PWM. A budget of 0 means no limit.
+  FORCE_INLINE static int16_t GetPowerBudget()
+  {
+    return power_budget;
+  }
+  FORCE_INLINE static uint8_t GetPowerPriority(uint8_t device_number)
+  {
+    return heater_info_array[device_number].power_priority;
+  }
+  static uint8_t SetPowerBudget(int16_t budget);
+  static uint8_t SetPowerPriority(uint8_t device_number, uint8_t priority);
+
+  // Thermal runaway supervision parameters
+  static uint8_t SetRunawayPeriod(uint8_t device_number, uint8_t period); // in seconds (0 = disabled)
+  static uint8_t SetRunawayRise(uint8_t device_number, uint8_t temp_rise); // in degrees C
+  static uint8_t SetRunawayDeviation(uint8_t device_number, uint8_t temp_range); // in degrees C
+
   // Bang Bang Mode Specific Config Parameters
   FORCE_INLINE static uint8_t GetBangBangHysteresis(uint8_t device_number)
   {
@@ -135,14 +204,11 @@ public:
   }
   FORCE_INLINE static float GetPidDefaultKi(uint8_t device_number)
   {
-    if (PID_dT != 0.0)
-      return heater_info_array[device_number].control_info.pid->Ki / PID_dT;
-    else
-      return 0.0;
+    return heater_info_array[device_number].control_info.pid->Ki;
   }
   FORCE_INLINE static float GetPidDefaultKd(uint8_t device_number)
   {
-    return heater_info_array[device_number].control_info.pid->Kd * PID_dT;
+    return heater_info_array[device_number].control_info.pid->Kd;
   }
   
   static uint8_t SetPidFunctionalRange(uint8_t device_number, uint8_t value); // in degrees C
@@ -151,11 +217,21 @@ public:
   static uint8_t SetPidDefaultKd(uint8_t device_number, float value);
   // TODO add advanced PID parameters  
   
-  static void DoPidAutotune(uint8_t device_number, float temp, int ncycles);
+  // PID autotune runs in the background (stepped by UpdateHeaters) so several heaters
+  // can be tuned at once. The results are kept until the next autotune of the heater.
+  static uint8_t StartPidAutotune(uint8_t device_number, temperature_t temp, uint8_t ncycles);
+  FORCE_INLINE static uint8_t GetPidAutotuneState(uint8_t device_number)
+  {
+    return heater_info_array[device_number].autotune_state;
+  }
+  static uint8_t GetPidAutotuneCycle(uint8_t device_number);
+  static float GetPidAutotuneKp(uint8_t device_number); // NAN until available
+  static float GetPidAutotuneKi(uint8_t device_number);
+  static float GetPidAutotuneKd(uint8_t device_number);
   
-  static uint8_t ValidateTargetTemperature(uint8_t device_number, float temp);
+  static uint8_t ValidateTargetTemperature(uint8_t device_number, temperature_t temp);
 
-  FORCE_INLINE static void SetTargetTemperature(uint8_t device_number, float temp)
+  FORCE_INLINE static void SetTargetTemperature(uint8_t device_number, temperature_t temp)
   {
     // this assumes that ValidateTargetTemperature has already been called
     HeaterInfo *heater_info = &heater_info_array[device_number];
@@ -166,9 +242,18 @@ public:
           && temp != SENSOR_TEMPERATURE_INVALID)
       InitializePidState(heater_info);
     heater_info->target_temp = temp;
+    heater_info->raw_thresholds_stale = true; // recalculated by UpdateHeaters (not from an ISR)
+    heater_info->runaway_state = HEATER_RUNAWAY_STATE_START;
+    if (heater_info->autotune_state == HEATER_AUTOTUNE_STATE_RUNNING)
+      heater_info->autotune_state = HEATER_AUTOTUNE_STATE_ABORTED;
   }
   
   static void UpdateHeaters();
+  
+  // called when the temperature sensor sampling period changes
+  static void UpdateSamplingPeriod();
+  // called when a temperature sensor's raw value to temperature mapping changes
+  static void InvalidateRawThresholds();
 private:
 
   friend void updateSoftPwm();
@@ -192,13 +277,24 @@ private:
     #define DEFAULT_PID_K1                0.95
     #define DEFAULT_MAX_PID_POWER_LEVEL   255 // == full current
     #define DEFAULT_INTEGRAL_DRIVE_MAX    255
+    
+    // The PID is calculated in fixed point. The output (and the P & D terms) have 
+    // PID_OUTPUT_FRACTION_BITS fraction bits while the integral term is accumulated 
+    // with PID_INTEGRAL_FRACTION_BITS so that the small per-sample gain keeps its precision.
+    // The gains are limited to PID_MAX_FIXED_GAIN and the D term to PID_MAX_DTERM so 
+    // that none of the 32-bit intermediate values can overflow.
+    #define PID_OUTPUT_FRACTION_BITS      12
+    #define PID_INTEGRAL_FRACTION_BITS    20
+    #define PID_MAX_FIXED_GAIN            (1L << 18) // Kp, Kd * (1 - K1) / dT <= 1024, Ki * dT <= 4
+    #define PID_MAX_DTERM                 (1L << 22) // i.e., 1024 power levels
+    #define PID_MAX_TEMPERATURE_CHANGE    DEGREES_TO_TEMPERATURE(255)
   
     // If the temperature difference between the target temperature and the actual temperature
     // is more than this value then the PID will be shut off and the heater will be set to 0 or 
     // power_on_level.
     uint8_t functional_range;  // (default = 10degsC)
 
-    // Primary PID configuration values.
+    // Primary PID configuration values (Ki is per second, Kd is in seconds).
     float Kp;
     float Ki;
     float Kd;
@@ -212,19 +308,44 @@ private:
     uint8_t advanced_integral_drive_max; // limit for the integral term (default = 255)
     
     // 
-    // Derived Configuration
+    // Derived Configuration (fixed point, per temperature unit & per sample)
     //
     
-    float KdK2; // == Kd * (1 - K1)
-    float iState_max; // == advanced_integral_drive_max / Ki
+    int32_t Kp_fixed; // == Kp
+    int32_t Ki_fixed; // == Ki * dT
+    int32_t KdK2_fixed; // == Kd * (1 - K1) / dT
+    uint16_t K1_fixed; // == K1 (0.16 fixed point)
+    int32_t iState_max; // == advanced_max_pid_power_level (integral term units)
     
     // 
     // State 
     //
     
-    float state_iState;
-    float state_dTerm;
-    float last_temp;
+    int32_t state_iState; // integral term (i.e., sum of Ki * error)
+    int32_t state_dTerm;
+    temperature_t last_temp;
+  };
+  
+  struct AutotuneInfo
+  {
+    temperature_t target_temp;
+    uint8_t ncycles;
+    uint8_t cycles;
+    bool heating;
+    uint8_t power;
+    int16_t bias;
+    int16_t d;
+    temperature_t max_temp;
+    temperature_t min_temp;
+    uint32_t t1; // start of the last cooling phase (in millis)
+    uint32_t t2; // start of the last heating phase (in millis)
+    int32_t t_high;
+    int32_t t_low;
+    
+    // results (NAN until at least three cycles have completed)
+    float Kp;
+    float Ki;
+    float Kd;
   };
   
   struct HeaterInfo
@@ -232,11 +353,36 @@ private:
     uint8_t device_number;
     uint8_t heater_pin;
     uint8_t temp_sensor;
-    float max_temp;
+    temperature_t max_temp;
     uint8_t power_on_level;
     uint8_t control_mode;
-    float target_temp;
+    temperature_t target_temp;
+    uint8_t power; // power being output (after the power budget is applied)
+    uint8_t requested_power;
+    uint8_t power_priority;
     bool is_heating;
+    
+    // target_temp, max_temp & the bang bang thresholds as sensor raw keys (so that 
+    // the checks which don't need a temperature are made without a conversion)
+    bool raw_thresholds_stale;
+    uint16_t min_valid_key; // below 0 degrees C is treated as a sensor fault
+    uint16_t max_temp_key; // keys at or above this are over max_temp
+    uint16_t heat_on_key; // bang bang: turn on below this key
+    uint16_t heat_off_key; // bang bang: turn off at or above this key
+    
+    // thermal runaway supervision
+    uint8_t runaway_period; // in seconds (0 = disabled)
+    uint8_t runaway_rise; // in degrees C
+    uint8_t runaway_deviation; // in degrees C
+    uint8_t runaway_state;
+    uint16_t runaway_low_key; // keys below this are more than runaway_deviation below target
+    temperature_t runaway_watch_temp; // heating: temperature at the start of the period
+    uint32_t runaway_watch_time; // start of the current period (in millis)
+    uint32_t runaway_power_sum; // power output over the period (to scale the required rise)
+    uint32_t runaway_requested_sum; // power requested over the period
+    
+    uint8_t autotune_state;
+    AutotuneInfo *autotune; // allocated on first autotune
     union 
     {
       BangBangInfo bangbang;
@@ -245,32 +391,51 @@ private:
   };
   
   FORCE_INLINE static void SetHeaterPower(HeaterInfo *heater_info, uint8_t power)
+  {
+    heater_info->requested_power = power;
+    heater_info->is_heating = (power > 0);
+    // with a power budget, increases are made by ApplyPowerBudget (decreases always fit)
+    if (power_budget == 0 || power <= heater_info->power)
+      WriteHeaterPower(heater_info, power);
+  }
+  
+  FORCE_INLINE static void WriteHeaterPower(HeaterInfo *heater_info, uint8_t power)
   {
     uint8_t device_number = heater_info->device_number;
 #if TRACE_HEATER
-    DEBUG("SetHeater("); DEBUG((int)device_number); DEBUG("): "); DEBUG((int)power); DEBUG("/"); DEBUGLN((int)Device_TemperatureSensor::ReadCurrentTemperature(heater_info->temp_sensor));
+    DEBUG("SetHeater("); DEBUG((int)device_number); DEBUG("): "); DEBUG((int)power); DEBUG("/"); DEBUGLN(Device_TemperatureSensor::ReadCurrentTemperature(heater_info->temp_sensor) >> TEMPERATURE_FRACTION_BITS);
 #endif    
     if ((soft_pwm_device_bitmask & (1<<device_number)) == 0)
       analogWrite(heater_info->heater_pin, power);
     else
       soft_pwm_state->SetPower(device_number, power);
-    heater_info->is_heating = (power > 0);
+    heater_info->power = power;
   }
   
   FORCE_INLINE static void InitializePidState(HeaterInfo *heater_info)
   {
     // initialize PID state ready for use
     PidInfo *pid_info = heater_info->control_info.pid;
-    pid_info->state_iState = 0.0;
-    pid_info->state_dTerm = 0.0;
+    pid_info->state_iState = 0;
+    pid_info->state_dTerm = 0;
     pid_info->last_temp = Device_TemperatureSensor::ReadCurrentTemperature(heater_info->temp_sensor);
   }
   
   static void UpdatePidDerivedConfig(HeaterInfo *heater_info);
+  static void UpdateRawThresholds(HeaterInfo *heater_info);
+  static bool CheckThermalRunaway(HeaterInfo *heater_info, uint16_t current_key);
+  static void StartRunawayWatch(HeaterInfo *heater_info, uint32_t now);
+  static bool CheckRunawayRise(HeaterInfo *heater_info, uint32_t now);
+  static void ApplyPowerBudget();
+  static void StepPidAutotune(HeaterInfo *heater_info);
+  static void FinishPidAutotune(HeaterInfo *heater_info, uint8_t state);
   
   static uint8_t num_heaters;
   static HeaterInfo *heater_info_array;
   
+  static int16_t power_budget; // 0 = no limit
+  static uint8_t *power_priority_order; // device numbers in the order power is allocated
+  
   // additional state to support soft pwm 
   static uint8_t soft_pwm_device_bitmask; // soft pwm is only supported on first 8 heaters
   static SoftPwmState *soft_pwm_state; // allocated on first use
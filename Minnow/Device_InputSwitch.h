@@ -48,7 +48,7 @@ public:
     return input_switch_pins[device_number];
   }
   
-  FORCE_INLINE static uint8_t GetTriggerLevel(uint8_t device_number)
+  FORCE_INLINE static bool GetTriggerLevel(uint8_t device_number)
   {
     return input_switch_info[device_number].trigger_level;
   }
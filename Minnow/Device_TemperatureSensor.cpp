@@ -20,6 +20,7 @@
 #include "Minnow.h"
  
 #include "Device_TemperatureSensor.h"
+#include "Device_Heater.h"
 #include "response.h"
 
 #include "thermistortables.h"
@@ -27,7 +28,9 @@
 // Most of the Device_TemperatureSensor statics are placed in the movement.cpp compilation unit to 
 // allow potentiall better optimization in the ISR
 
-float *Device_TemperatureSensor::temperature_sensor_current_temps;
+uint16_t *Device_TemperatureSensor::temperature_sensor_current_raw_values;
+Device_TemperatureSensor::FilterInfo *Device_TemperatureSensor::temperature_sensor_filter_info;
+Device_TemperatureSensor::ParametricThermistor **Device_TemperatureSensor::temperature_sensor_parametric;
 
 extern volatile bool temp_meas_ready;
 
@@ -41,30 +44,78 @@ extern volatile bool temp_meas_ready;
 #define THERMOCOUPLE_RAW_HI_TEMP (16383-ADC_OCSC_FAULT_MARGIN) // this is opposite to a thermistor
 #define THERMOCOUPLE_RAW_LO_TEMP (0+ADC_OCSC_FAULT_MARGIN)
 
-FORCE_INLINE static float convert_raw_temp_value(int8_t type, uint16_t raw_value)
+// thermistor readings are inverted to give raw keys (note: the valid raw range is symmetrical)
+#define THERMISTOR_RAW_KEY_MASK (RAW_KEY_LIMIT - 1)
+
+#define MAX_TEMP_SENSOR_OVERSAMPLING_SHIFT 6 // 64 samples of 1023 still fit in 16 bits
+
+// The ADC runs with a prescaler of 128 and takes 13 ADC clocks per free-running conversion
+#define ADC_CONVERSION_TIME (13.0 * 128.0 / F_CPU)
+
+// AD595 output is 10mV/degree C, i.e., (5V / 1024 / 10mV) degrees per ADC count and the raw 
+// value is the sum of OVERSAMPLENR counts (in 16.16 fixed point temperature units per raw unit)
+#define AD595_TEMPERATURE_SCALE ((int32_t)(500.0 / 1024.0 / OVERSAMPLENR * TEMPERATURE_ONE_DEGREE \
+                                    * TEMP_SENSOR_AD595_GAIN * 65536.0 + 0.5))
+
+#define THERMISTOR_TABLE_CASE(_N) \
+    case _N: segments = TT_SEGMENTS(_N); index = TT_INDEX(_N); \
+      last_segment = NUM_ARRAY_ELEMENTS(TT_SEGMENTS(_N)) - 1; break;
+
+FORCE_INLINE static temperature_t convert_raw_temp_value(int8_t type, uint16_t raw_value)
 {
   if (type >= FIRST_THERMISTOR_SENSOR_TYPE && type <= LAST_THERMISTOR_SENSOR_TYPE)
   {
-    const int16_t (*tt)[2];
-    uint8_t tt_len;
+    const ThermistorSegment *segments;
+    const uint8_t *index;
+    uint8_t last_segment;
     
     switch (type)
     {
-    case 1:  tt = TT_NAME(1); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(1)); break;
-    case 2:  tt = TT_NAME(2); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(2)); break;
-    case 3:  tt = TT_NAME(3); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(3)); break;
-    case 4:  tt = TT_NAME(4); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(4)); break;
-    case 5:  tt = TT_NAME(5); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(5)); break;
-    case 6:  tt = TT_NAME(6); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(6)); break;
-    case 7:  tt = TT_NAME(7); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(7)); break;
-    case 8:  tt = TT_NAME(8); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(8)); break;
-    case 9:  tt = TT_NAME(9); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(9)); break;
-    case 10:  tt = TT_NAME(10); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(10)); break;
-    case 51:  tt = TT_NAME(51); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(51)); break;
-    case 52:  tt = TT_NAME(52); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(52)); break;
-    case 55:  tt = TT_NAME(55); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(55)); break;
-    case 60:  tt = TT_NAME(60); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(60)); break;
-    case 71:  tt = TT_NAME(71); tt_len = NUM_ARRAY_ELEMENTS(TT_NAME(71)); break;
+#if ENABLE_THERMISTOR_TYPE_1
+    THERMISTOR_TABLE_CASE(1)
+#endif
+#if ENABLE_THERMISTOR_TYPE_2
+    THERMISTOR_TABLE_CASE(2)
+#endif
+#if ENABLE_THERMISTOR_TYPE_3
+    THERMISTOR_TABLE_CASE(3)
+#endif
+#if ENABLE_THERMISTOR_TYPE_4
+    THERMISTOR_TABLE_CASE(4)
+#endif
+#if ENABLE_THERMISTOR_TYPE_5
+    THERMISTOR_TABLE_CASE(5)
+#endif
+#if ENABLE_THERMISTOR_TYPE_6
+    THERMISTOR_TABLE_CASE(6)
+#endif
+#if ENABLE_THERMISTOR_TYPE_7
+    THERMISTOR_TABLE_CASE(7)
+#endif
+#if ENABLE_THERMISTOR_TYPE_8
+    THERMISTOR_TABLE_CASE(8)
+#endif
+#if ENABLE_THERMISTOR_TYPE_9
+    THERMISTOR_TABLE_CASE(9)
+#endif
+#if ENABLE_THERMISTOR_TYPE_10
+    THERMISTOR_TABLE_CASE(10)
+#endif
+#if ENABLE_THERMISTOR_TYPE_51
+    THERMISTOR_TABLE_CASE(51)
+#endif
+#if ENABLE_THERMISTOR_TYPE_52
+    THERMISTOR_TABLE_CASE(52)
+#endif
+#if ENABLE_THERMISTOR_TYPE_55
+    THERMISTOR_TABLE_CASE(55)
+#endif
+#if ENABLE_THERMISTOR_TYPE_60
+    THERMISTOR_TABLE_CASE(60)
+#endif
+#if ENABLE_THERMISTOR_TYPE_71
+    THERMISTOR_TABLE_CASE(71)
+#endif
     default:
       return SENSOR_TEMPERATURE_INVALID;
     }
@@ -73,36 +124,26 @@ FORCE_INLINE static float convert_raw_temp_value(int8_t type, uint16_t raw_value
     if (raw_value < THERMISTOR_RAW_HI_TEMP || raw_value > THERMISTOR_RAW_LO_TEMP) 
       return SENSOR_TEMPERATURE_INVALID;
     
-    #define PGM_RD_W(x)   (int16_t)pgm_read_word(&x)
-    // Derived from RepRap FiveD extruder::getTemperature()
-    // For hot end temperature measurement.
-
-    float celsius;
-    uint8_t i;
-
-    for (i=1; i<tt_len; i++)
-    {
-      if (PGM_RD_W(tt[i][0]) > (int16_t)raw_value)
-      {
-        celsius = PGM_RD_W(tt[i-1][1]) + 
-          (raw_value - PGM_RD_W(tt[i-1][0])) * 
-          (float)(PGM_RD_W(tt[i][1]) - PGM_RD_W(tt[i-1][1])) /
-          (float)(PGM_RD_W(tt[i][0]) - PGM_RD_W(tt[i-1][0]));
-        return celsius;
-      }
-    }
-
-    // Overflow: Set to last value in the table
-    celsius = PGM_RD_W(tt[i-1][1]);
-    return celsius;
+    // the index gives the segment containing the start of this raw value's index cell,
+    // so at most a few segment boundaries can lie between it and raw_value
+    uint8_t i = pgm_read_byte(&index[raw_value >> THERMISTOR_INDEX_SHIFT]);
+    while (i < last_segment && (int16_t)pgm_read_word(&segments[i+1].raw) <= (int16_t)raw_value)
+      i++;
+    
+    const ThermistorSegment *segment = &segments[i];
+    const int16_t offset = (int16_t)raw_value - (int16_t)pgm_read_word(&segment->raw);
+    const int32_t celsius = ((int32_t)(int16_t)pgm_read_word(&segment->temp) << 16) 
+                + (int32_t)pgm_read_dword(&segment->slope) * offset;
+    // round from 16.16 degrees to 1/16 degree units
+    return (temperature_t)((celsius + (1L << (15 - TEMPERATURE_FRACTION_BITS))) >> (16 - TEMPERATURE_FRACTION_BITS));
   }
   else if (type == -1) // AD595 thermocouple
   {
     if (raw_value > THERMOCOUPLE_RAW_HI_TEMP || raw_value < THERMOCOUPLE_RAW_LO_TEMP)
       return SENSOR_TEMPERATURE_INVALID;
 
-    return ((raw_value * ((5.0 * 100.0) / 1024.0) / OVERSAMPLENR) * TEMP_SENSOR_AD595_GAIN) 
-                + TEMP_SENSOR_AD595_OFFSET;
+    return (temperature_t)((raw_value * AD595_TEMPERATURE_SCALE + (1L << 15)) >> 16) 
+                + DEGREES_TO_TEMPERATURE(TEMP_SENSOR_AD595_OFFSET);
   }
   else
   {
@@ -110,6 +151,49 @@ FORCE_INLINE static float convert_raw_temp_value(int8_t type, uint16_t raw_value
   }
 }
 
+temperature_t Device_TemperatureSensor::ConvertParametricRawValue(
+    const ParametricThermistor *thermistor, uint16_t raw_value)
+{
+  const ParametricTable *table = thermistor->table;
+  if (table == 0 || raw_value < THERMISTOR_RAW_HI_TEMP || raw_value > THERMISTOR_RAW_LO_TEMP) 
+    return SENSOR_TEMPERATURE_INVALID;
+  
+  // same approach as the built-in tables (readings hotter than the first segment extrapolate it)
+  uint8_t i = table->index[raw_value >> PARAMETRIC_THERMISTOR_INDEX_SHIFT];
+  while (i < table->last_segment && table->segments[i+1].raw <= raw_value)
+    i++;
+  
+  const ParametricSegment *segment = &table->segments[i];
+  const int32_t temp = segment->temp 
+      + ((segment->slope * ((int16_t)raw_value - (int16_t)segment->raw) + (1L << 15)) >> 16);
+  if (temp > DEGREES_TO_TEMPERATURE(MAX_TEMPERATURE_DEGREES))
+    return DEGREES_TO_TEMPERATURE(MAX_TEMPERATURE_DEGREES);
+  return temp;
+}
+
+// calculates the temperature (in degrees C) of a parametric thermistor for a raw value
+float Device_TemperatureSensor::ParametricThermistorTemperature(
+    const ParametricThermistor *thermistor, uint16_t raw_value)
+{
+  // the raw value is the voltage across the thermistor and series resistor (in oversampled counts)
+  const float resistance = thermistor->pullup_resistance * raw_value 
+      / (float)(RAW_KEY_LIMIT - raw_value) - thermistor->series_resistance;
+  if (resistance <= 0.0)
+    return MAX_TEMPERATURE_DEGREES;
+  
+  const float ln_resistance = log(resistance);
+  float inverse_kelvin;
+  if (thermistor->sh_b != 0.0)
+  {
+    inverse_kelvin = thermistor->sh_a + thermistor->sh_b * ln_resistance 
+        + thermistor->sh_c * ln_resistance * ln_resistance * ln_resistance;
+  }
+  else
+  {
+    inverse_kelvin = 1.0 / 298.15 + (ln_resistance - log(thermistor->r25)) / thermistor->beta;
+  }
+  return 1.0 / inverse_kelvin - 273.15;
+}
 
 uint8_t Device_TemperatureSensor::Init(uint8_t num_devices)
 {
@@ -122,8 +206,10 @@ uint8_t Device_TemperatureSensor::Init(uint8_t num_devices)
   }
 
   uint8_t *memory = (uint8_t *)malloc(num_devices *
-      (sizeof(*temperature_sensor_pins) + sizeof(*temperature_sensor_types) 
-              + sizeof(*temperature_sensor_current_temps)
+      (sizeof(*temperature_sensor_filter_info) + sizeof(*temperature_sensor_parametric)
+              + sizeof(*temperature_sensor_pins) + sizeof(*temperature_sensor_types) 
+              + sizeof(*temperature_sensor_oversampling)
+              + sizeof(*temperature_sensor_current_raw_values)
               + sizeof(*temperature_sensor_isr_raw_values) + sizeof(*temperature_sensor_raw_values)));
 
   if (memory == 0)
@@ -132,30 +218,35 @@ uint8_t Device_TemperatureSensor::Init(uint8_t num_devices)
     return PARAM_APP_ERROR_TYPE_FAILED;
   }
 
-  temperature_sensor_pins = memory;
+  temperature_sensor_filter_info = (FilterInfo *)memory;
+  temperature_sensor_parametric = (ParametricThermistor **)(temperature_sensor_filter_info + num_devices);
+  temperature_sensor_pins = (uint8_t *)(temperature_sensor_parametric + num_devices);
   temperature_sensor_types = (int8_t *)(temperature_sensor_pins + num_devices);
-  temperature_sensor_isr_raw_values = (uint16_t *)(temperature_sensor_types + num_devices);
+  temperature_sensor_oversampling = (uint8_t *)(temperature_sensor_types + num_devices);
+  temperature_sensor_isr_raw_values = (uint16_t *)(temperature_sensor_oversampling + num_devices);
   temperature_sensor_raw_values = temperature_sensor_isr_raw_values + num_devices;
-  temperature_sensor_current_temps = (float *)(temperature_sensor_raw_values + num_devices);
+  temperature_sensor_current_raw_values = temperature_sensor_raw_values + num_devices;
   
   memset(temperature_sensor_pins, 0xFF, num_devices * sizeof(*temperature_sensor_pins));
   memset(temperature_sensor_types, TEMP_SENSOR_TYPE_INVALID, num_devices * sizeof(*temperature_sensor_types));
+  memset(temperature_sensor_oversampling, OVERSAMPLENR_SHIFT, num_devices * sizeof(*temperature_sensor_oversampling));
   memset(temperature_sensor_raw_values, 0, num_devices * sizeof(*temperature_sensor_raw_values));
   memset(temperature_sensor_isr_raw_values, 0, num_devices * sizeof(*temperature_sensor_isr_raw_values));
+  memset(temperature_sensor_current_raw_values, 0, num_devices * sizeof(*temperature_sensor_current_raw_values));
+  memset(temperature_sensor_filter_info, 0, num_devices * sizeof(*temperature_sensor_filter_info));
+  memset(temperature_sensor_parametric, 0, num_devices * sizeof(*temperature_sensor_parametric));
+  for (uint8_t i = 0; i < num_devices; i++)
+    temperature_sensor_filter_info[i].median_window = 1;
 
-  for (int8_t i=0; i<num_devices; i++)
-  {
-    temperature_sensor_current_temps[i] = SENSOR_TEMPERATURE_INVALID;
-  }
-
-  // Set analog inputs
-  ADCSRA = 1<<ADEN | 1<<ADSC | 1<<ADIF | 0x07;
+  num_temperature_sensors = num_devices;
+  
+  // Set analog inputs - the ADC is left free-running and the ADC interrupt 
+  // steps through the sensors (see updateTemperatureSensorRawValues)
   DIDR0 = 0;
   #ifdef DIDR2
     DIDR2 = 0;
   #endif
-  
-  num_temperature_sensors = num_devices;
+  ADCSRA = 1<<ADEN | 1<<ADSC | 1<<ADATE | 1<<ADIE | 1<<ADIF | 0x07;
   
   return APP_ERROR_TYPE_SUCCESS;
 }
@@ -178,10 +269,20 @@ uint8_t Device_TemperatureSensor::SetType(uint8_t device_number, int16_t type)
   if (type == 0)
   {
     temperature_sensor_types[device_number] = type;
+    Device_Heater::InvalidateRawThresholds();
     return APP_ERROR_TYPE_SUCCESS;
   }
   
-  if (type >= FIRST_THERMISTOR_SENSOR_TYPE && type <= LAST_THERMISTOR_SENSOR_TYPE)
+  if (type == TEMP_SENSOR_TYPE_PARAMETRIC_THERMISTOR)
+  {
+    ParametricThermistor *thermistor = GetParametricThermistor(device_number);
+    if (thermistor == 0)
+      return PARAM_APP_ERROR_TYPE_FAILED;
+    const uint8_t retval = BuildParametricTable(thermistor);
+    if (retval != APP_ERROR_TYPE_SUCCESS)
+      return retval;
+  }
+  else if (type >= FIRST_THERMISTOR_SENSOR_TYPE && type <= LAST_THERMISTOR_SENSOR_TYPE)
   {
     // for now, do conversion as simple way of checking type validity
     if (convert_raw_temp_value(type, THERMISTOR_RAW_HI_TEMP) == SENSOR_TEMPERATURE_INVALID)
@@ -230,20 +331,456 @@ uint8_t Device_TemperatureSensor::SetType(uint8_t device_number, int16_t type)
   }
   
   temperature_sensor_types[device_number] = type;
+  Device_Heater::InvalidateRawThresholds();
 
   return APP_ERROR_TYPE_SUCCESS;
 }
 
+uint8_t Device_TemperatureSensor::SetOversampling(uint8_t device_number, uint8_t count)
+{
+  if (device_number >= num_temperature_sensors)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
+  
+  uint8_t shift = 0;
+  while ((1 << shift) < count && shift < MAX_TEMP_SENSOR_OVERSAMPLING_SHIFT)
+    shift++;
+  
+  if (count != (1 << shift))
+  {
+    generate_response_msg_addPGM(PMSG(MSG_ERR_UNKNOWN_VALUE));
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  }
+  
+  temperature_sensor_oversampling[device_number] = shift;
+  
+  Device_Heater::UpdateSamplingPeriod();
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_TemperatureSensor::SetFilterMedian(uint8_t device_number, uint8_t window)
+{
+  if (device_number >= num_temperature_sensors)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
+  
+  if (window == 0 || window > MAX_TEMP_SENSOR_MEDIAN_WINDOW || (window & 1) == 0)
+  {
+    generate_response_msg_addPGM(PMSG(MSG_ERR_UNKNOWN_VALUE));
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  }
+  
+  FilterInfo *filter_info = &temperature_sensor_filter_info[device_number];
+  filter_info->median_window = window;
+  filter_info->median_primed = false;
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_TemperatureSensor::SetFilterTimeConstant(uint8_t device_number, uint8_t readings)
+{
+  if (device_number >= num_temperature_sensors)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
+  
+  uint8_t shift = 0;
+  while ((1 << shift) < readings && shift < MAX_TEMP_SENSOR_TIME_CONSTANT_SHIFT)
+    shift++;
+  
+  if (readings != (1 << shift))
+  {
+    generate_response_msg_addPGM(PMSG(MSG_ERR_UNKNOWN_VALUE));
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  }
+  
+  FilterInfo *filter_info = &temperature_sensor_filter_info[device_number];
+  filter_info->time_constant_shift = shift;
+  filter_info->low_pass_primed = false;
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+uint8_t Device_TemperatureSensor::SetThermistorBeta(uint8_t device_number, float value)
+{
+  if (value <= 0.0)
+  {
+    generate_response_msg_addPGM(PMSG(MSG_ERR_UNKNOWN_VALUE));
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  }
+  return UpdateParametricThermistor(device_number, &ParametricThermistor::beta, value);
+}
+
+uint8_t Device_TemperatureSensor::SetThermistorR25(uint8_t device_number, float value)
+{
+  if (value <= 0.0)
+  {
+    generate_response_msg_addPGM(PMSG(MSG_ERR_UNKNOWN_VALUE));
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  }
+  return UpdateParametricThermistor(device_number, &ParametricThermistor::r25, value);
+}
+
+uint8_t Device_TemperatureSensor::SetThermistorShA(uint8_t device_number, float value)
+{
+  return UpdateParametricThermistor(device_number, &ParametricThermistor::sh_a, value);
+}
+
+uint8_t Device_TemperatureSensor::SetThermistorShB(uint8_t device_number, float value)
+{
+  return UpdateParametricThermistor(device_number, &ParametricThermistor::sh_b, value);
+}
+
+uint8_t Device_TemperatureSensor::SetThermistorShC(uint8_t device_number, float value)
+{
+  return UpdateParametricThermistor(device_number, &ParametricThermistor::sh_c, value);
+}
+
+uint8_t Device_TemperatureSensor::SetPullupResistance(uint8_t device_number, float value)
+{
+  if (value <= 0.0)
+  {
+    generate_response_msg_addPGM(PMSG(MSG_ERR_UNKNOWN_VALUE));
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  }
+  return UpdateParametricThermistor(device_number, &ParametricThermistor::pullup_resistance, value);
+}
+
+uint8_t Device_TemperatureSensor::SetSeriesResistance(uint8_t device_number, float value)
+{
+  if (value < 0.0)
+  {
+    generate_response_msg_addPGM(PMSG(MSG_ERR_UNKNOWN_VALUE));
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  }
+  return UpdateParametricThermistor(device_number, &ParametricThermistor::series_resistance, value);
+}
+
+Device_TemperatureSensor::ParametricThermistor *Device_TemperatureSensor::GetParametricThermistor(uint8_t device_number)
+{
+  ParametricThermistor *thermistor = temperature_sensor_parametric[device_number];
+  if (thermistor == 0)
+  {
+    thermistor = (ParametricThermistor *)malloc(sizeof(ParametricThermistor));
+    if (thermistor == 0)
+    {
+      generate_response_msg_addPGM(PMSG(MSG_ERR_INSUFFICIENT_MEMORY));
+      return 0;
+    }
+    // defaults are a common 100k beta 3950 thermistor with a 4.7k pullup
+    thermistor->beta = 3950.0;
+    thermistor->r25 = 100000.0;
+    thermistor->sh_a = 0.0;
+    thermistor->sh_b = 0.0;
+    thermistor->sh_c = 0.0;
+    thermistor->pullup_resistance = 4700.0;
+    thermistor->series_resistance = 0.0;
+    thermistor->table = 0;
+    temperature_sensor_parametric[device_number] = thermistor;
+  }
+  return thermistor;
+}
+
+uint8_t Device_TemperatureSensor::UpdateParametricThermistor(uint8_t device_number, 
+                    float ParametricThermistor::*parameter, float value)
+{
+  if (device_number >= num_temperature_sensors)
+    return PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER;
+  
+  ParametricThermistor *thermistor = GetParametricThermistor(device_number);
+  if (thermistor == 0)
+    return PARAM_APP_ERROR_TYPE_FAILED;
+  
+  const float old_value = thermistor->*parameter;
+  thermistor->*parameter = value;
+  
+  // the table is only built once the sensor is a parametric thermistor (see SetType)
+  if (temperature_sensor_types[device_number] == TEMP_SENSOR_TYPE_PARAMETRIC_THERMISTOR)
+  {
+    // the existing table is kept if the new one cannot be built
+    const uint8_t retval = BuildParametricTable(thermistor);
+    if (retval != APP_ERROR_TYPE_SUCCESS)
+    {
+      thermistor->*parameter = old_value;
+      return retval;
+    }
+    Device_Heater::InvalidateRawThresholds();
+  }
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+//
+// Builds the segment table of a parametric thermistor. Starting from the coldest valid reading, 
+// each segment is made as long as possible while the error at its midpoint stays within 
+// PARAMETRIC_SEGMENT_TOLERANCE. This needs a few hundred evaluations of the model so it 
+// is only done at configuration time.
+//
+// Returns PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE if the parameters don't give a 
+// sensible (ie. monotonic) conversion (in which case the existing table is kept).
+//
+#define PARAMETRIC_SEGMENT_TOLERANCE 0.25 // degrees C
+#define PARAMETRIC_MIN_SEGMENT_LENGTH OVERSAMPLENR
+
+uint8_t Device_TemperatureSensor::BuildParametricTable(ParametricThermistor *thermistor)
+{
+  ParametricTable *table = (ParametricTable *)malloc(sizeof(ParametricTable));
+  if (table == 0)
+  {
+    generate_response_msg_addPGM(PMSG(MSG_ERR_INSUFFICIENT_MEMORY));
+    return PARAM_APP_ERROR_TYPE_FAILED;
+  }
+  if (!FillParametricTable(thermistor, table))
+  {
+    free(table);
+    generate_response_msg_addPGM(PMSG(MSG_ERR_UNKNOWN_VALUE));
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  }
+  
+  // the pointer is swapped atomically (an interrupt never sees a partly built table)
+  CRITICAL_SECTION_START;
+  ParametricTable *old_table = thermistor->table;
+  thermistor->table = table;
+  CRITICAL_SECTION_END;
+  free(old_table);
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+bool Device_TemperatureSensor::FillParametricTable(const ParametricThermistor *thermistor, 
+                    ParametricTable *table)
+{
+  // find the hottest end of the table (ie. the first raw value at or below the maximum temperature)
+  uint16_t first_raw = THERMISTOR_RAW_HI_TEMP;
+  uint16_t last_raw = THERMISTOR_RAW_LO_TEMP;
+  uint16_t hi = last_raw;
+  while (first_raw < hi)
+  {
+    const uint16_t mid = (first_raw + hi) / 2;
+    if (ParametricThermistorTemperature(thermistor, mid) <= PARAMETRIC_THERMISTOR_MAX_TEMP)
+      hi = mid;
+    else
+      first_raw = mid + 1;
+  }
+  
+  // the segments are found from the cold end so they are placed at the end of the 
+  // array to start with
+  ParametricSegment *segments = table->segments;
+  uint8_t count = 0;
+  uint16_t raw = last_raw;
+  float temp = ParametricThermistorTemperature(thermistor, raw);
+  while (true)
+  {
+    ParametricSegment *segment = &segments[PARAMETRIC_THERMISTOR_MAX_SEGMENTS - 1 - count];
+    segment->raw = raw;
+    segment->temp = (temperature_t)lround(temp * TEMPERATURE_ONE_DEGREE);
+    count++;
+    if (raw <= first_raw)
+      break;
+    
+    uint16_t length = min(PARAMETRIC_MIN_SEGMENT_LENGTH, raw - first_raw);
+    float next_temp = ParametricThermistorTemperature(thermistor, raw - length);
+    if (count == PARAMETRIC_THERMISTOR_MAX_SEGMENTS - 1)
+    {
+      // out of segments, the last one covers the rest of the range
+      length = raw - first_raw;
+      next_temp = ParametricThermistorTemperature(thermistor, first_raw);
+    }
+    else
+    {
+      // double the length while the midpoint error is acceptable then bisect the failed length
+      uint16_t failed_length = 0;
+      while (length < raw - first_raw)
+      {
+        const uint16_t try_length = min(2 * length, raw - first_raw);
+        const float try_temp = ParametricThermistorTemperature(thermistor, raw - try_length);
+        const float mid_temp = ParametricThermistorTemperature(thermistor, raw - try_length / 2);
+        if (fabs((temp + try_temp) / 2 - mid_temp) > PARAMETRIC_SEGMENT_TOLERANCE)
+        {
+          failed_length = try_length;
+          break;
+        }
+        length = try_length;
+        next_temp = try_temp;
+      }
+      while (failed_length - length > PARAMETRIC_MIN_SEGMENT_LENGTH)
+      {
+        const uint16_t try_length = (length + failed_length) / 2;
+        const float try_temp = ParametricThermistorTemperature(thermistor, raw - try_length);
+        const float mid_temp = ParametricThermistorTemperature(thermistor, raw - try_length / 2);
+        if (fabs((temp + try_temp) / 2 - mid_temp) > PARAMETRIC_SEGMENT_TOLERANCE)
+        {
+          failed_length = try_length;
+        }
+        else
+        {
+          length = try_length;
+          next_temp = try_temp;
+        }
+      }
+    }
+    
+    // temperatures must increase as the raw value decreases (this also rejects NaNs)
+    if (!(next_temp > temp) || next_temp > MAX_TEMPERATURE_DEGREES || temp < -273.0)
+      return false;
+    
+    // the slope is between the rounded temperatures so that the conversion stays monotonic
+    // (the rise is limited so that the 16.16 fixed point calculation cannot overflow)
+    const int32_t temp_rise = lround(next_temp * TEMPERATURE_ONE_DEGREE) - segment->temp;
+    if (temp_rise > INT16_MAX)
+      return false;
+    segment = &segments[PARAMETRIC_THERMISTOR_MAX_SEGMENTS - 1 - count];
+    segment->slope = -(((int32_t)temp_rise * 65536 + length / 2) / length);
+    raw -= length;
+    temp = next_temp;
+  }
+  
+  if (count < 2)
+    return false;
+  
+  // move the segments to the start of the array (in raw value order)
+  memmove(segments, &segments[PARAMETRIC_THERMISTOR_MAX_SEGMENTS - count], count * sizeof(*segments));
+  segments[count - 1].slope = 0;
+  table->last_segment = count - 1;
+  
+  // limit the first segment's slope so extrapolating it down to a raw value of 0 can't overflow
+  const int32_t max_slope = INT32_MAX / ((int32_t)segments[0].raw + 1) / 2;
+  if (segments[0].slope < -max_slope)
+    segments[0].slope = -max_slope;
+  
+  for (uint16_t cell = 0; cell < NUM_ARRAY_ELEMENTS(table->index); cell++)
+  {
+    uint8_t i = 0;
+    while (i < table->last_segment && segments[i+1].raw <= (cell << PARAMETRIC_THERMISTOR_INDEX_SHIFT))
+      i++;
+    table->index[cell] = i;
+  }
+  return true;
+}
+
+float Device_TemperatureSensor::GetSamplingPeriod()
+{
+  // each sensor takes one discarded conversion plus its oversampled conversions
+  uint16_t conversions = 0;
+  for (uint8_t i=0; i<num_temperature_sensors; i++)
+    conversions += 1 + (1 << temperature_sensor_oversampling[i]);
+  return conversions * ADC_CONVERSION_TIME;
+}
+
 void Device_TemperatureSensor::UpdateTemperatureSensors()
 {
   if (!temp_meas_ready)
     return;
-  for(uint8_t i=0; i<num_temperature_sensors; i++)
+  // readings are filtered and latched here and only converted on demand 
+  for (uint8_t i=0; i<num_temperature_sensors; i++)
   {
-    temperature_sensor_current_temps[i] = convert_raw_temp_value(temperature_sensor_types[i], temperature_sensor_raw_values[i]);
+    temperature_sensor_current_raw_values[i] = 
+        FilterReading(&temperature_sensor_filter_info[i], temperature_sensor_raw_values[i]);
   }
   CRITICAL_SECTION_START;
   temp_meas_ready = false;
   CRITICAL_SECTION_END;
 }
 
+uint16_t Device_TemperatureSensor::FilterReading(FilterInfo *filter_info, uint16_t raw_value)
+{
+  const uint8_t window = filter_info->median_window;
+  if (window > 1)
+  {
+    if (!filter_info->median_primed)
+    {
+      for (uint8_t i=0; i<window; i++)
+        filter_info->history[i] = raw_value;
+      filter_info->history_index = 0;
+      filter_info->median_primed = true;
+    }
+    filter_info->history[filter_info->history_index] = raw_value;
+    if (++filter_info->history_index >= window)
+      filter_info->history_index = 0;
+    
+    // insertion sort a copy of the (at most 5) readings and take the middle one
+    uint16_t sorted[MAX_TEMP_SENSOR_MEDIAN_WINDOW];
+    for (uint8_t i=0; i<window; i++)
+    {
+      const uint16_t value = filter_info->history[i];
+      uint8_t j = i;
+      while (j > 0 && sorted[j-1] > value)
+      {
+        sorted[j] = sorted[j-1];
+        j--;
+      }
+      sorted[j] = value;
+    }
+    raw_value = sorted[window / 2];
+  }
+  
+  // out of range readings bypass the low pass filter so that faults are not delayed
+  // (and so that the filter restarts from the first good reading afterwards)
+  if (raw_value < THERMISTOR_RAW_HI_TEMP || raw_value > THERMISTOR_RAW_LO_TEMP)
+  {
+    filter_info->low_pass_primed = false;
+    return raw_value;
+  }
+  
+  const uint8_t shift = filter_info->time_constant_shift;
+  if (!filter_info->low_pass_primed)
+  {
+    filter_info->low_pass_sum = (uint32_t)raw_value << shift;
+    filter_info->low_pass_primed = true;
+  }
+  else
+  {
+    // y += (x - y) / 2^shift, with y kept scaled by 2^shift to avoid losing precision
+    filter_info->low_pass_sum += raw_value - (filter_info->low_pass_sum >> shift);
+  }
+  return (filter_info->low_pass_sum + ((1 << shift) >> 1)) >> shift;
+}
+
+temperature_t Device_TemperatureSensor::ConvertRawValue(uint8_t device_number, uint16_t raw_value)
+{
+  const int8_t type = temperature_sensor_types[device_number];
+  if (type == TEMP_SENSOR_TYPE_PARAMETRIC_THERMISTOR)
+    return ConvertParametricRawValue(temperature_sensor_parametric[device_number], raw_value);
+  return convert_raw_temp_value(type, raw_value);
+}
+
+temperature_t Device_TemperatureSensor::ReadCurrentTemperature(uint8_t device_number)
+{
+  const temperature_t temp = ConvertRawValue(device_number, 
+                                  temperature_sensor_current_raw_values[device_number]);
+  if (temp == SENSOR_TEMPERATURE_INVALID)
+  {
+    // TODO - improve this.
+    DEBUGPGM("Invalid Temp: ");
+    DEBUG((int)device_number);
+    DEBUGPGM(" ");
+    DEBUGLN(temperature_sensor_current_raw_values[device_number]);
+  }
+  return temp;
+}
+
+uint16_t Device_TemperatureSensor::ReadCurrentRawKey(uint8_t device_number)
+{
+  const uint16_t raw_value = temperature_sensor_current_raw_values[device_number];
+  
+  // the open-circuit/short-circuit limits are the same for all sensor types
+  if (raw_value < THERMISTOR_RAW_HI_TEMP || raw_value > THERMISTOR_RAW_LO_TEMP)
+    return RAW_KEY_INVALID;
+  
+  if (temperature_sensor_types[device_number] >= FIRST_THERMISTOR_SENSOR_TYPE)
+    return raw_value ^ THERMISTOR_RAW_KEY_MASK;
+  return raw_value;
+}
+
+uint16_t Device_TemperatureSensor::TemperatureToRawKey(uint8_t device_number, temperature_t temp)
+{
+  const int8_t type = temperature_sensor_types[device_number];
+  const uint16_t key_mask = (type >= FIRST_THERMISTOR_SENSOR_TYPE) ? THERMISTOR_RAW_KEY_MASK : 0;
+  
+  // binary search for the first key at or above temp (conversions are monotonic in key 
+  // order and the search stays within the valid raw range so every conversion is valid)
+  uint16_t lo = THERMISTOR_RAW_HI_TEMP;
+  uint16_t hi = THERMISTOR_RAW_LO_TEMP + 1;
+  while (lo < hi)
+  {
+    const uint16_t mid = (lo + hi) / 2;
+    if (ConvertRawValue(device_number, mid ^ key_mask) >= temp)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return (lo > THERMISTOR_RAW_LO_TEMP) ? RAW_KEY_LIMIT : lo;
+}
+
@@ -25,12 +25,43 @@
 #define DEVICE_TEMPERATURE_SENSOR_H
 
 #include "Minnow.h"
+#include "temperature_ISR.h"
+
+//
+// Temperatures are handled as fixed point values in 1/16 degree C units (i.e., 
+// +/-2047 degrees C) so that no floating point is required when converting, 
+// controlling and reporting temperatures.
+//
+typedef int16_t temperature_t;
+
+#define TEMPERATURE_FRACTION_BITS 4
+#define TEMPERATURE_ONE_DEGREE (1 << TEMPERATURE_FRACTION_BITS)
+#define MAX_TEMPERATURE_DEGREES 2047
+
+#define DEGREES_TO_TEMPERATURE(_d) ((temperature_t)((_d) * TEMPERATURE_ONE_DEGREE))
+#define TEMPERATURE_TO_DEGREES(_t) ((_t) / (float)TEMPERATURE_ONE_DEGREE) // for diagnostics only
+
+// conversions to and from the 1/10 degree units used by the Pacemaker protocol 
+FORCE_INLINE temperature_t decidegrees_to_temperature(int16_t decidegrees)
+{
+  // saturate values which are outside of the representable range
+  if (decidegrees > MAX_TEMPERATURE_DEGREES * 10)
+    decidegrees = MAX_TEMPERATURE_DEGREES * 10;
+  else if (decidegrees < -MAX_TEMPERATURE_DEGREES * 10)
+    decidegrees = -MAX_TEMPERATURE_DEGREES * 10;
+  return ((int32_t)decidegrees * TEMPERATURE_ONE_DEGREE) / 10;
+}
+
+FORCE_INLINE int16_t temperature_to_decidegrees(temperature_t temp)
+{
+  return ((int32_t)temp * 10) / TEMPERATURE_ONE_DEGREE;
+}
 
 class Device_TemperatureSensor
 {
 public:
 
-#define SENSOR_TEMPERATURE_INVALID 0.0
+#define SENSOR_TEMPERATURE_INVALID 0
 
 #define TEMP_SENSOR_TYPE_INVALID     0
 
@@ -58,6 +89,9 @@ public:
 // 51 is 100k thermistor - EPCOS (1k pullup)
 // 52 is 200k thermistor - ATC Semitec 204GT-2 (1k pullup)
 // 55 is 100k thermistor - ATC Semitec 104GT-2 (Used in ParCan) (1k pullup)
+//
+// 99 is a parametric thermistor - the conversion table is calculated from the beta (or 
+//    Steinhart-Hart) coefficients, pullup and series resistances configured for the sensor
 
 // Thermocouple sensor types: (<0)
 //
@@ -66,6 +100,7 @@ public:
 
 #define FIRST_THERMISTOR_SENSOR_TYPE 1 // all temperature sensor types below this are not thermistors
 #define LAST_THERMISTOR_SENSOR_TYPE 99 // all temperature sensor types above this are not thermistors
+#define TEMP_SENSOR_TYPE_PARAMETRIC_THERMISTOR 99
 // see thermistortables.h for available thermistor types.
 
 #define FIRST_THERMOCOUPLE_SENSOR_TYPE -30 // all temperature sensor types below this are not thermocouples
@@ -102,22 +137,84 @@ public:
     return temperature_sensor_types[device_number];
   }
   
-  FORCE_INLINE static float ReadCurrentTemperature(uint8_t device_number)
-  {
-    if (temperature_sensor_current_temps[device_number] == SENSOR_TEMPERATURE_INVALID)
-    {
-      // TODO - improve this.
-      DEBUGPGM("Invalid Temp: ");
-      DEBUG((int)device_number);
-      DEBUGPGM(" ");
-      DEBUGLN(temperature_sensor_raw_values[device_number]);
-    }
-    return temperature_sensor_current_temps[device_number];
+  FORCE_INLINE static uint8_t GetOversampling(uint8_t device_number)
+  {
+    return 1 << temperature_sensor_oversampling[device_number];
+  }
+  
+  FORCE_INLINE static uint8_t GetFilterMedian(uint8_t device_number)
+  {
+    return temperature_sensor_filter_info[device_number].median_window;
   }
   
+  FORCE_INLINE static uint8_t GetFilterTimeConstant(uint8_t device_number)
+  {
+    return 1 << temperature_sensor_filter_info[device_number].time_constant_shift;
+  }
+  
+  // converts the current reading (readings are only converted when requested)
+  static temperature_t ReadCurrentTemperature(uint8_t device_number);
+  
+  //
+  // Raw keys allow temperature thresholds to be checked without converting readings.
+  // A raw key is the raw reading ordered so that larger keys are hotter for all sensor 
+  // types (i.e., thermistor readings are inverted). Invalid readings have a key of 0.
+  //
+  #define RAW_KEY_INVALID 0
+  #define RAW_KEY_LIMIT   (1024 * OVERSAMPLENR) // larger than any key
+  
+  static uint16_t ReadCurrentRawKey(uint8_t device_number);
+  
+  // returns the smallest raw key whose temperature is at least temp (or RAW_KEY_LIMIT)
+  static uint16_t TemperatureToRawKey(uint8_t device_number, temperature_t temp);
+  
   // these configuration functions return APP_ERROR_TYPE_SUCCESS or error code
   static uint8_t SetPin(uint8_t device_number, uint8_t pin);
   static uint8_t SetType(uint8_t device_number, int16_t type);
+  static uint8_t SetOversampling(uint8_t device_number, uint8_t count);
+  static uint8_t SetFilterMedian(uint8_t device_number, uint8_t window);
+  static uint8_t SetFilterTimeConstant(uint8_t device_number, uint8_t readings);
+  
+  // parametric thermistor configuration (the Steinhart-Hart model is used if sh_b is non-zero),
+  // the getters return NAN for sensors which have never been configured as parametric
+  static float GetThermistorBeta(uint8_t device_number)
+  {
+    return GetParametricParameter(device_number, &ParametricThermistor::beta);
+  }
+  static float GetThermistorR25(uint8_t device_number)
+  {
+    return GetParametricParameter(device_number, &ParametricThermistor::r25);
+  }
+  static float GetThermistorShA(uint8_t device_number)
+  {
+    return GetParametricParameter(device_number, &ParametricThermistor::sh_a);
+  }
+  static float GetThermistorShB(uint8_t device_number)
+  {
+    return GetParametricParameter(device_number, &ParametricThermistor::sh_b);
+  }
+  static float GetThermistorShC(uint8_t device_number)
+  {
+    return GetParametricParameter(device_number, &ParametricThermistor::sh_c);
+  }
+  static float GetPullupResistance(uint8_t device_number)
+  {
+    return GetParametricParameter(device_number, &ParametricThermistor::pullup_resistance);
+  }
+  static float GetSeriesResistance(uint8_t device_number)
+  {
+    return GetParametricParameter(device_number, &ParametricThermistor::series_resistance);
+  }
+  static uint8_t SetThermistorBeta(uint8_t device_number, float value);
+  static uint8_t SetThermistorR25(uint8_t device_number, float value);
+  static uint8_t SetThermistorShA(uint8_t device_number, float value);
+  static uint8_t SetThermistorShB(uint8_t device_number, float value);
+  static uint8_t SetThermistorShC(uint8_t device_number, float value);
+  static uint8_t SetPullupResistance(uint8_t device_number, float value);
+  static uint8_t SetSeriesResistance(uint8_t device_number, float value);
+
+  // returns the time in seconds taken to sample all temperature sensors once
+  static float GetSamplingPeriod();
 
   static void UpdateTemperatureSensors();
   
@@ -129,11 +226,87 @@ private:
   
   static uint8_t *temperature_sensor_pins;
   static int8_t *temperature_sensor_types;
+  static uint8_t *temperature_sensor_oversampling; // log2 of the number of samples per reading
 
   static uint16_t *temperature_sensor_raw_values;  
   static uint16_t *temperature_sensor_isr_raw_values;  
 
-  static float *temperature_sensor_current_temps;  
+  static uint16_t *temperature_sensor_current_raw_values; // latched by UpdateTemperatureSensors
+  
+  //
+  // Each reading passes through a median filter (to reject isolated glitches) followed 
+  // by a first order low pass filter before it is latched as the current raw value.
+  //
+  #define MAX_TEMP_SENSOR_MEDIAN_WINDOW 5
+  #define MAX_TEMP_SENSOR_TIME_CONSTANT_SHIFT 7
+  
+  struct FilterInfo
+  {
+    uint32_t low_pass_sum; // the filtered value << time_constant_shift
+    uint16_t history[MAX_TEMP_SENSOR_MEDIAN_WINDOW]; 
+    uint8_t history_index;
+    uint8_t median_window;
+    uint8_t time_constant_shift;
+    bool median_primed; // false until the first reading after a reset
+    bool low_pass_primed; // false until the first valid reading after a reset or fault
+  };
+  
+  static FilterInfo *temperature_sensor_filter_info;
+  
+  static uint16_t FilterReading(FilterInfo *filter_info, uint16_t raw_value);
+  
+  //
+  // Parametric thermistors are converted with a table of segments which is calculated 
+  // in RAM when the sensor is configured (and only allocated for parametric sensors).
+  // The segments are chosen so the linear interpolation error is within about 1/4 degree 
+  // up to PARAMETRIC_THERMISTOR_MAX_TEMP. A new table is built separately and then 
+  // swapped in as the conversion can be used from an interrupt.
+  //
+  #define PARAMETRIC_THERMISTOR_MAX_SEGMENTS 48
+  #define PARAMETRIC_THERMISTOR_INDEX_SHIFT 8
+  #define PARAMETRIC_THERMISTOR_MAX_TEMP 400
+  
+  struct ParametricSegment
+  {
+    uint16_t raw;
+    temperature_t temp;
+    int32_t slope; // temperature units per raw unit (16.16 fixed point)
+  };
+  
+  struct ParametricTable
+  {
+    uint8_t last_segment;
+    uint8_t index[RAW_KEY_LIMIT >> PARAMETRIC_THERMISTOR_INDEX_SHIFT];
+    ParametricSegment segments[PARAMETRIC_THERMISTOR_MAX_SEGMENTS];
+  };
+  
+  struct ParametricThermistor
+  {
+    float beta;
+    float r25; // resistance at 25 degrees C
+    float sh_a;
+    float sh_b;
+    float sh_c;
+    float pullup_resistance;
+    float series_resistance;
+    ParametricTable *table; // or 0 if not built yet
+  };
+  
+  static ParametricThermistor **temperature_sensor_parametric;
+  
+  static temperature_t ConvertRawValue(uint8_t device_number, uint16_t raw_value);
+  static temperature_t ConvertParametricRawValue(const ParametricThermistor *thermistor, uint16_t raw_value);
+  static float ParametricThermistorTemperature(const ParametricThermistor *thermistor, uint16_t raw_value);
+  static ParametricThermistor *GetParametricThermistor(uint8_t device_number);
+  static float GetParametricParameter(uint8_t device_number, float ParametricThermistor::*parameter)
+  {
+    const ParametricThermistor *thermistor = temperature_sensor_parametric[device_number];
+    return (thermistor != 0) ? thermistor->*parameter : NAN;
+  }
+  static uint8_t UpdateParametricThermistor(uint8_t device_number, 
+                    float ParametricThermistor::*parameter, float value);
+  static uint8_t BuildParametricTable(ParametricThermistor *thermistor);
+  static bool FillParametricTable(const ParametricThermistor *thermistor, ParametricTable *table);
 };
 
 
@@ -37,6 +37,20 @@ HardwareSerial HwSerial;
   ring_buffer rx_buffer  =  { { 0 }, 0, 0 };
 #endif
 
+#if EMERGENCY_STOP_ESCAPE_LENGTH > 0
+uint8_t rx_escape_count = 0;
+volatile bool rx_emergency_stop_requested = false;
+
+void rx_emergency_stop()
+{
+  // only the outputs are turned off from the interrupt; the stop is reported
+  // from loop(). The movement ISR will dump the queue once it sees the stopped state
+  is_stopped = true;
+  disable_all_outputs();
+  rx_emergency_stop_requested = true;
+}
+#endif
+
 FORCE_INLINE void store_char(unsigned char c)
 {
   int i = (unsigned int)(rx_buffer.head + 1) % RX_BUFFER_SIZE;
@@ -59,6 +73,9 @@ FORCE_INLINE void store_char(unsigned char c)
   SIGNAL(M_USARTx_RX_vect)
   {
     unsigned char c  =  M_UDRx;
+#if EMERGENCY_STOP_ESCAPE_LENGTH > 0
+    check_emergency_stop_escape(c);
+#endif
     store_char(c);
   }
 #endif
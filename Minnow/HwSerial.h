@@ -86,6 +86,27 @@ struct ring_buffer
   extern ring_buffer rx_buffer;
 #endif
 
+#if EMERGENCY_STOP_ESCAPE_LENGTH > 0
+extern uint8_t rx_escape_count;
+extern volatile bool rx_emergency_stop_requested; // set when the stop has yet to be reported
+void rx_emergency_stop();
+
+// Called for every received character (from the ISR or checkRx) so that
+// an emergency stop is not delayed by main loop processing.
+FORCE_INLINE void check_emergency_stop_escape(unsigned char c)
+{
+  if (c != EMERGENCY_STOP_ESCAPE_BYTE)
+  {
+    rx_escape_count = 0;
+  }
+  else if (++rx_escape_count == EMERGENCY_STOP_ESCAPE_LENGTH)
+  {
+    rx_escape_count = 0;
+    rx_emergency_stop();
+  }
+}
+#endif
+
 class HardwareSerial //: public Stream
 {
 
@@ -115,6 +136,9 @@ class HardwareSerial //: public Stream
     {
       if((M_UCSRxA & (1<<M_RXCx)) != 0) {
         unsigned char c  =  M_UDRx;
+#if EMERGENCY_STOP_ESCAPE_LENGTH > 0
+        check_emergency_stop_escape(c);
+#endif
         int i = (unsigned int)(rx_buffer.head + 1) % RX_BUFFER_SIZE;
 
         // if we should be storing the received character into the location
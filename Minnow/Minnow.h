@@ -65,6 +65,7 @@
 
 bool allocate_command_queue_memory();
 void emergency_stop(uint8_t stopped_cause, uint8_t stopped_type = PARAM_STOPPED_TYPE_ONE_TIME_OR_CLEARED);
+void disable_all_outputs();
 void die();
 
 //
@@ -74,8 +75,8 @@ void die();
 // Receive order related
 extern uint8_t order_code;
 extern uint8_t control_byte;
-extern uint8_t parameter_length;
-extern uint8_t * const parameter_value;
+extern uint16_t parameter_length;
+extern uint8_t *parameter_value;
 
 // Stopped state related
 extern bool is_stopped;
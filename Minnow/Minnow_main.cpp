@@ -32,7 +32,10 @@
 #include "protocol.h"
 #include "response.h"
 #include "crc8.h"
+#include "crc16.h"
+#include "events.h"
 #include "firmware_configuration.h"
+#include "temperature_history.h"
 #include "initial_pin_state.h"
 #include "order_helpers.h"
 
@@ -69,20 +72,24 @@ extern volatile bool temp_meas_ready;
 static PROGMEM const uint32_t autodetect_baudrates[] = AUTODETECT_BAUDRATES;
 static uint8_t autodetect_baudrates_index = 0;
 
+// used until the command queue is allocated (which may provide a larger buffer)
+static uint8_t default_recv_buf[MAX_RECV_BUF_LEN];
+
 //===========================================================================
 //=============================public variables=============================
 //===========================================================================
 
 uint16_t recv_buf_len = 0;
-uint8_t recv_buf[MAX_RECV_BUF_LEN];
+uint16_t recv_buf_size = MAX_RECV_BUF_LEN;
+uint8_t *recv_buf = default_recv_buf;
 
 uint32_t recv_count = 0;
 uint16_t recv_errors = 0;
 
 uint8_t order_code;
 uint8_t control_byte;
-uint8_t parameter_length;
-uint8_t * const parameter_value = &recv_buf[PM_PARAMETER_OFFSET];
+uint16_t parameter_length;
+uint8_t *parameter_value = &default_recv_buf[PM_PARAMETER_OFFSET];
 
 #if DEBUG_NOT_STOPPED_INITIALLY
   bool is_stopped = false; // doesn't require a resume after reset can make testing easier
@@ -174,6 +181,20 @@ bool allocate_command_queue_memory()
   {
     return false;
   }
+  
+  // Use part of the budget for a larger receive buffer to support extended frames.
+  // Note: the current order's parameters may still be in the default buffer so
+  // the new buffer is only used from the next frame onwards.
+  if (recv_buf == default_recv_buf)
+  {
+    uint16_t extended_size = min(memory_size / EXTENDED_RECV_BUF_SHARE, MAX_EXTENDED_RECV_BUF_LEN);
+    if (extended_size > MAX_RECV_BUF_LEN && memory_size - extended_size >= MIN_QUEUE_SIZE)
+    {
+      memory_size -= extended_size;
+      recv_buf = memory + memory_size;
+      recv_buf_size = extended_size;
+    }
+  }
   CommandQueue::Init(memory, memory_size);
   return true;
 }
@@ -507,20 +528,84 @@ void setup()
   DEBUGLNPGM("starting");
 
   apply_initial_configuration();
+  restore_configuration_snapshot();
   apply_debug_commands();
 }
 
+FORCE_INLINE static bool is_extended_frame()
+{
+  return recv_buf[PM_SYNC_BYTE_OFFSET] == SYNC_BYTE_EXTENDED_ORDER_VALUE;
+}
+
+FORCE_INLINE static uint8_t get_received_control_byte()
+{
+  return recv_buf[is_extended_frame() ? PM_EXTENDED_CONTROL_BYTE_OFFSET : PM_CONTROL_BYTE_OFFSET];
+}
+
+// returns true when a complete extended frame has been received
+FORCE_INLINE static bool get_extended_command_char(uint8_t serial_char, bool &abort_frame)
+{
+  if (recv_buf_len == recv_buf_size)
+  {
+    generate_response_transport_error_start(PARAM_FRAME_RECEIPT_ERROR_TYPE_BAD_FRAME, 
+        recv_buf[PM_EXTENDED_CONTROL_BYTE_OFFSET]);
+    generate_response_send();
+    abort_frame = true;
+    return false;
+  }
+  recv_buf[recv_buf_len++] = serial_char;
+  
+  if (recv_buf_len < PM_EXTENDED_HEADER_SIZE)
+    return false;
+    
+  const uint16_t length = (recv_buf[PM_EXTENDED_LENGTH_OFFSET] << 8) 
+      | recv_buf[PM_EXTENDED_LENGTH_OFFSET + 1];
+  // reject the frame as soon as the length is known if it cannot fit in the buffer
+  // (the sum is done in 32 bits so a large length cannot wrap)
+  if (length < 2 || (uint32_t)length + PM_EXTENDED_CONTROL_BYTE_OFFSET 
+      + PM_EXTENDED_CHECK_CODE_SIZE > recv_buf_size)
+  {
+    generate_response_transport_error_start(PARAM_FRAME_RECEIPT_ERROR_TYPE_BAD_FRAME, 
+        recv_buf[PM_EXTENDED_CONTROL_BYTE_OFFSET]);
+    generate_response_send();
+    abort_frame = true;
+    return false;
+  }
+
+  // still need more bytes?
+  const uint16_t check_code_offset = PM_EXTENDED_CONTROL_BYTE_OFFSET + length;
+  if (recv_buf_len < check_code_offset + PM_EXTENDED_CHECK_CODE_SIZE)
+    return false;
+
+  // we have enough bytes - check the crc
+  if (crc16(&recv_buf[PM_EXTENDED_LENGTH_OFFSET], check_code_offset - PM_EXTENDED_LENGTH_OFFSET)
+      != ((recv_buf[check_code_offset] << 8) | recv_buf[check_code_offset + 1]))
+  {
+#if !DEBUG_DONT_CHECK_CRC8_VALUE 
+    generate_response_transport_error_start(PARAM_FRAME_RECEIPT_ERROR_TYPE_BAD_CHECK_CODE, 
+        recv_buf[PM_EXTENDED_CONTROL_BYTE_OFFSET]);
+    generate_response_send();
+    recv_errors += 1;
+    abort_frame = true;
+    return false;
+#endif      
+  }
+  recv_buf[check_code_offset] = '\0'; // null-terminate parameters
+  return true;
+}
+
 FORCE_INLINE static bool get_command()
 {
   uint8_t serial_char;
   
-  if (recv_buf_len > 0 && millis() - first_rcvd_time > MAX_FRAME_COMPLETION_DELAY_MS)
+  if (recv_buf_len > 0 && millis() - first_rcvd_time > 
+      (is_extended_frame() ? MAX_EXTENDED_FRAME_COMPLETION_DELAY_MS : MAX_FRAME_COMPLETION_DELAY_MS))
   {
     // timeout waiting for frame completion
-    if (recv_buf_len >= PM_HEADER_SIZE)
+    if (recv_buf_len >= (is_extended_frame() ? PM_EXTENDED_HEADER_SIZE : PM_HEADER_SIZE))
     {    
       generate_response_transport_error_start(PARAM_FRAME_RECEIPT_ERROR_TYPE_BAD_FRAME, 
-          recv_buf[PM_CONTROL_BYTE_OFFSET]);
+          get_received_control_byte());
       generate_response_send();
       recv_errors += 1;
     }
@@ -534,20 +619,33 @@ FORCE_INLINE static bool get_command()
     if (recv_buf_len == 0)
     {
       // ignore non-sync characters at the start
-      if (serial_char == SYNC_BYTE_ORDER_VALUE)
+      if (serial_char == SYNC_BYTE_ORDER_VALUE || serial_char == SYNC_BYTE_EXTENDED_ORDER_VALUE)
       {
         first_rcvd_time = millis();
-        recv_buf[0] = SYNC_BYTE_ORDER_VALUE;
+        recv_buf[0] = serial_char;
         recv_buf_len = 1;
       }
       continue;
     }
+    
+    else if (is_extended_frame())
+    {
+      bool abort_frame = false;
+      if (get_extended_command_char(serial_char, abort_frame))
+      {
+        recv_count += 1;
+        return true;
+      }
+      if (abort_frame)
+        recv_buf_len = 0;
+      continue;
+    }
 
     // still need more bytes?
     else if (recv_buf_len < PM_HEADER_SIZE
         || recv_buf_len - 2 < recv_buf[PM_LENGTH_BYTE_OFFSET])
     {
-      if (recv_buf_len == sizeof(recv_buf)) // should only occur due to reduced buffer size
+      if (recv_buf_len == recv_buf_size) // should only occur due to reduced buffer size
       {
         generate_response_transport_error_start(PARAM_FRAME_RECEIPT_ERROR_TYPE_BAD_FRAME, 
             recv_buf[PM_CONTROL_BYTE_OFFSET]);
@@ -613,9 +711,21 @@ void loop()
     autodetect_baudrates_index = 0xFF;
     last_order_time = millis();
     is_host_active = true;
-    order_code = recv_buf[PM_ORDER_BYTE_OFFSET];
-    control_byte = recv_buf[PM_CONTROL_BYTE_OFFSET];
-    parameter_length = recv_buf[PM_LENGTH_BYTE_OFFSET]-2;
+    if (is_extended_frame())
+    {
+      order_code = recv_buf[PM_EXTENDED_ORDER_BYTE_OFFSET];
+      control_byte = recv_buf[PM_EXTENDED_CONTROL_BYTE_OFFSET];
+      parameter_length = ((recv_buf[PM_EXTENDED_LENGTH_OFFSET] << 8) 
+          | recv_buf[PM_EXTENDED_LENGTH_OFFSET + 1]) - 2;
+      parameter_value = &recv_buf[PM_EXTENDED_PARAMETER_OFFSET];
+    }
+    else
+    {
+      order_code = recv_buf[PM_ORDER_BYTE_OFFSET];
+      control_byte = recv_buf[PM_CONTROL_BYTE_OFFSET];
+      parameter_length = recv_buf[PM_LENGTH_BYTE_OFFSET]-2;
+      parameter_value = &recv_buf[PM_PARAMETER_OFFSET];
+    }
 
 #if TRACE_ORDER
     DEBUGPGM("\nOrder(");  
@@ -625,10 +735,10 @@ void loop()
     DEBUGPGM(", cb=");  
     DEBUG_F(control_byte, HEX);  
     DEBUGPGM("):");  
-    for (uint8_t i = 0; i < parameter_length; i++)
+    for (uint16_t i = 0; i < parameter_length; i++)
     {
       DEBUG_CH(' '); 
-      DEBUG_F(recv_buf[i], HEX);  
+      DEBUG_F(parameter_value[i], HEX);  
     }
     DEBUG_EOL();
 #endif    
@@ -676,8 +786,25 @@ void loop()
   {
     Device_TemperatureSensor::UpdateTemperatureSensors();
     Device_Heater::UpdateHeaters();
+    record_temperature_history();
   }
 
+#if EMERGENCY_STOP_ESCAPE_LENGTH > 0
+  // Report a stop requested with the serial escape sequence
+  if (rx_emergency_stop_requested)
+  {
+    rx_emergency_stop_requested = false;
+    emergency_stop(PARAM_STOPPED_CAUSE_USER_REQUEST);
+  }
+#endif
+
+  // Send any events raised by the ISRs or by the emergency stop handler
+  if (events_pending())
+    send_pending_events();
+
+  // Commit the next queued EEPROM write (if the EEPROM is ready)
+  NVConfigStore::WritePendingData();
+
   // Now check low-priority stuff
   uint32_t now = millis();
   if (now - last_idle_check > 1000) // checked every second
@@ -706,11 +833,18 @@ void emergency_stop(uint8_t new_stopped_cause, uint8_t new_stopped_type
   ERROR("Stopping: cause="); // TODO improve with error reason /Language-ify
   ERRORLN(new_stopped_cause);
   
-  uint8_t i;
   is_stopped = true; 
   stopped_is_acknowledged = false;
   stopped_cause = new_stopped_cause;
   stopped_type = new_stopped_type;
+  raise_event(PARAM_EVENT_TYPE_STOPPED, new_stopped_cause);
+  disable_all_outputs();
+}
+
+// Turns off all steppers, heaters and outputs (this is safe to call from an ISR)
+void disable_all_outputs()
+{
+  uint8_t i;
   for (i=0; i<Device_Stepper::GetNumDevices(); i++)
   {
     Device_Stepper::WriteEnableState(i, false);
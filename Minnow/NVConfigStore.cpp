@@ -38,6 +38,67 @@
 
 #if USE_EEPROM
 
+#include "crc8.h"
+#include <string.h>
+
+// Journal record tags (the record key identifies the instance of the value)
+#define RECORD_TAG_HARDWARE_TYPE          0x01
+#define RECORD_TAG_HARDWARE_REV           0x02
+#define RECORD_TAG_HARDWARE_NAME          0x03
+#define RECORD_TAG_BOARD_ID               0x04
+#define RECORD_TAG_BOARD_SERIAL_NUM       0x05
+#define RECORD_TAG_CONFIG_HASH            0x06
+#define RECORD_TAG_CONFIG_SNAPSHOT_INFO   0x07 // snapshot length and hash
+#define RECORD_TAG_CONFIG_SNAPSHOT_CHUNK  0x08 // key is the chunk number
+#define RECORD_TAG_INITIAL_PIN_STATE      0x09 // key is the pin
+#define RECORD_TAG_DEVICE_NAME            0x10 // plus the device type, key is the device number
+#define RECORD_TAG_END                    0xFF
+
+// Address of the latest record for each tag & key (0 == unused slot)
+static uint16_t journal_index[JOURNAL_INDEX_SIZE];
+
+static uint16_t journal_bank;       // start of the active bank
+static uint16_t journal_end;        // address of the end of journal marker
+static uint16_t journal_sequence;   // sequence number of the active bank
+static bool journal_check_compaction = false; // set when records have been appended
+
+// Background compaction state (the live records are copied into the other bank a 
+// few bytes at a time from loop() while the active bank remains in use)
+#define NO_COMPACT_SLOT 0xFF
+static bool compacting = false;
+static uint16_t compact_bank;       // bank being written
+static uint16_t compact_address;    // next address to write in compact_bank
+static uint8_t compact_next;        // next index slot to copy
+static uint8_t compact_slot;        // index slot being copied (or NO_COMPACT_SLOT)
+static uint16_t compact_record;     // address of the record being copied
+static uint16_t compact_offset;     // offset of the next byte of the record to copy
+static uint8_t compact_dirty[(JOURNAL_INDEX_SIZE + 7) / 8]; // slots changed after being copied
+
+// EEPROM writes which have not been committed yet (oldest first)
+static uint16_t pending_write_address[EEPROM_WRITE_QUEUE_SIZE];
+static uint8_t pending_write_value[EEPROM_WRITE_QUEUE_SIZE];
+static uint8_t pending_write_head = 0;
+static uint8_t pending_write_count = 0;
+
+// Cached initial pin states (2 bits per pin: 0 == HIGHZ, otherwise the state + 1)
+static uint8_t pin_state_cache[(NUM_DIGITAL_PINS + 3) / 4];
+
+#if DEVICE_NAME_CACHE_SIZE > 0
+// Most recently used device names (most recent first)
+struct DeviceNameCacheEntry
+{
+  uint8_t device_type; // PM_DEVICE_TYPE_INVALID == unused entry
+  uint8_t device_number;
+  int8_t length; // -1 == device has no name
+  char name[MAX_DEVICE_NAME_LENGTH];
+};
+static DeviceNameCacheEntry device_name_cache[DEVICE_NAME_CACHE_SIZE];
+#endif
+
+// The snapshot chunk currently being written
+static uint8_t snapshot_chunk[CONFIG_SNAPSHOT_CHUNK_SIZE];
+static uint8_t snapshot_chunk_number = 0xFF; // 0xFF == none
+
 // replacements for functions missing from avr library
 FORCE_INLINE void eeprom_update_byte(uint8_t *address, uint8_t value)
 {
@@ -45,25 +106,311 @@ FORCE_INLINE void eeprom_update_byte(uint8_t *address, uint8_t value)
     eeprom_write_byte(address, value);
 }
 
-// replacements for functions missing from avr library
-FORCE_INLINE void eeprom_update_word(uint16_t *address, uint16_t value)
+// Commits the oldest queued write (only waiting for the EEPROM if wait is set)
+static bool write_pending_byte(bool wait)
 {
-  if (eeprom_read_word(address) != value)
-    eeprom_write_word(address, value);
+  if (pending_write_count == 0 || (!wait && !eeprom_is_ready()))
+    return false;
+  eeprom_update_byte((uint8_t*)pending_write_address[pending_write_head], pending_write_value[pending_write_head]);
+  pending_write_head = (pending_write_head + 1) & (EEPROM_WRITE_QUEUE_SIZE - 1);
+  pending_write_count -= 1;
+  return true;
 }
 
-uint8_t read_eeprom_string(uint8_t *address, uint8_t max_length, char *buffer, uint8_t buffer_len)
+static uint8_t read_journal_byte(uint16_t address)
 {
-  uint8_t i = 0;
-  while (i < max_length && i < buffer_len)
+  // queued writes are more recent than the EEPROM contents
+  for (uint8_t i = pending_write_count; i > 0; i--)
+  {
+    const uint8_t slot = (pending_write_head + i - 1) & (EEPROM_WRITE_QUEUE_SIZE - 1);
+    if (pending_write_address[slot] == address)
+      return pending_write_value[slot];
+  }
+  return eeprom_read_byte((uint8_t*)address);
+}
+
+static void write_journal_byte(uint16_t address, uint8_t value)
+{
+  if (read_journal_byte(address) == value)
+    return;
+  if (pending_write_count == EEPROM_WRITE_QUEUE_SIZE)
+    write_pending_byte(true);
+  // writes are committed in order so an interrupted journal update remains consistent
+  const uint8_t slot = (pending_write_head + pending_write_count) & (EEPROM_WRITE_QUEUE_SIZE - 1);
+  pending_write_address[slot] = address;
+  pending_write_value[slot] = value;
+  pending_write_count += 1;
+}
+
+FORCE_INLINE uint8_t journal_index_hash(uint8_t tag, uint8_t key)
+{
+  return (uint8_t)(tag * 31 + key) & (JOURNAL_INDEX_SIZE - 1);
+}
+
+// Returns the index slot holding the record with the given tag & key (or the 
+// unused slot where it would be added), or 0 if the index is full.
+static uint16_t *find_index_slot(uint8_t tag, uint8_t key)
+{
+  uint8_t i = journal_index_hash(tag, key);
+  for (uint8_t probes = 0; probes < JOURNAL_INDEX_SIZE; probes++)
+  {
+    uint16_t *slot = &journal_index[i];
+    if (*slot == 0 
+        || (read_journal_byte(*slot) == tag && read_journal_byte(*slot + 1) == key))
+      return slot;
+    i = (i + 1) & (JOURNAL_INDEX_SIZE - 1);
+  }
+  return 0;
+}
+
+// Returns the address of the data of the value with the given tag & key, or 0 
+// if the value has not been set.
+static uint16_t find_record(uint8_t tag, uint8_t key, uint8_t *length)
+{
+  const uint16_t *slot = find_index_slot(tag, key);
+  if (slot == 0 || *slot == 0)
+    return 0;
+  *length = read_journal_byte(*slot + 2);
+  if (*length == 0)
+    return 0; // deleted
+  return *slot + JOURNAL_RECORD_HEADER_LENGTH;
+}
+
+// Returns the total length of the record at address, or 0 if it is not valid
+static uint16_t check_record(uint16_t address, uint16_t bank_end)
+{
+  if (address + JOURNAL_RECORD_OVERHEAD > bank_end)
+    return 0;
+  const uint16_t record_length = JOURNAL_RECORD_OVERHEAD + read_journal_byte(address + 2);
+  if (address + record_length > bank_end)
+    return 0;
+  uint8_t crc = 0;
+  for (uint16_t i = 0; i < record_length - 1; i++)
+    crc = crc8_update(crc, read_journal_byte(address + i));
+  return (crc == read_journal_byte(address + record_length - 1)) ? record_length : 0;
+}
+
+static bool read_bank_header(uint16_t bank, uint16_t *sequence)
+{
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < JOURNAL_HEADER_LENGTH - 1; i++)
+    crc = crc8_update(crc, read_journal_byte(bank + i));
+  if (read_journal_byte(bank) != EEPROM_FORMAT_VERSION 
+      || read_journal_byte(bank + JOURNAL_HEADER_LENGTH - 1) != crc)
+    return false;
+  *sequence = read_journal_byte(bank + 1) | (read_journal_byte(bank + 2) << 8);
+  return true;
+}
+
+static void write_bank_header(uint16_t bank, uint16_t sequence)
+{
+  uint8_t header[JOURNAL_HEADER_LENGTH - 1] = { EEPROM_FORMAT_VERSION, (uint8_t)sequence, (uint8_t)(sequence >> 8) };
+  write_journal_byte(bank + 1, header[1]);
+  write_journal_byte(bank + 2, header[2]);
+  write_journal_byte(bank + 3, crc8(header, sizeof(header)));
+  // the format number is written last so the bank only becomes valid once complete
+  write_journal_byte(bank, EEPROM_FORMAT_VERSION);
+}
+
+// Rebuilds the journal index from the records in the active bank
+static void scan_journal()
+{
+  const uint16_t bank_end = journal_bank + JOURNAL_BANK_SIZE;
+  uint16_t address = journal_bank + JOURNAL_HEADER_LENGTH;
+  
+  memset(journal_index, 0, sizeof(journal_index));
+  while (address < bank_end && read_journal_byte(address) != RECORD_TAG_END)
+  {
+    const uint16_t record_length = check_record(address, bank_end);
+    if (record_length == 0)
+      break; // a damaged record ends the journal (it is overwritten by the next record)
+    uint16_t *slot = find_index_slot(read_journal_byte(address), read_journal_byte(address + 1));
+    if (slot == 0)
+      break;
+    *slot = address;
+    address += record_length;
+  }
+  journal_end = address;
+}
+
+// Starts copying the live records into the other bank
+static void start_compaction()
+{
+  compact_bank = (journal_bank == 0) ? JOURNAL_BANK_SIZE : 0;
+  compact_address = compact_bank + JOURNAL_HEADER_LENGTH;
+  compact_next = 0;
+  compact_slot = NO_COMPACT_SLOT;
+  memset(compact_dirty, 0, sizeof(compact_dirty));
+  compacting = true;
+  
+  // invalidate the bank while it is being rewritten
+  write_journal_byte(compact_bank, 0);
+}
+
+// Copies the next byte of the live records into the new bank (returns false once
+// all of the records have been copied)
+static bool compact_journal_step()
+{
+  while (true)
   {
-    char ch = (char)eeprom_read_byte(address + i);
-    if (ch == 0xFF || ch == '\0')
+    if (compact_slot == NO_COMPACT_SLOT)
     {
-      buffer[i] = '\0';
-      return i; 
+      // each slot is copied in turn, then any which were changed after being copied
+      // are copied again (the later record supersedes the earlier one)
+      bool recopy = false;
+      if (compact_next < JOURNAL_INDEX_SIZE)
+      {
+        compact_slot = compact_next++;
+      }
+      else
+      {
+        uint8_t i = 0;
+        while (i < JOURNAL_INDEX_SIZE && (compact_dirty[i / 8] & (1 << (i % 8))) == 0)
+          i++;
+        if (i == JOURNAL_INDEX_SIZE)
+          return false;
+        compact_dirty[i / 8] &= ~(1 << (i % 8));
+        compact_slot = i;
+        recopy = true;
+      }
+      compact_record = journal_index[compact_slot];
+      compact_offset = 0;
+      
+      // deleted values are dropped (unless the deletion happened after the copy)
+      if (compact_record == 0 || (!recopy && read_journal_byte(compact_record + 2) == 0))
+      {
+        compact_slot = NO_COMPACT_SLOT;
+        continue;
+      }
+      if (compact_address + JOURNAL_RECORD_OVERHEAD + read_journal_byte(compact_record + 2) 
+          > compact_bank + JOURNAL_BANK_SIZE)
+      {
+        // too many records were copied again so start over with just the live records
+        start_compaction();
+        continue;
+      }
     }
-    buffer[i] = ch;
+    
+    // the record itself is never modified so the copy is consistent even if the
+    // value is superseded while it is being copied
+    const uint16_t record_length = JOURNAL_RECORD_OVERHEAD + read_journal_byte(compact_record + 2);
+    write_journal_byte(compact_address++, read_journal_byte(compact_record + compact_offset++));
+    if (compact_offset == record_length)
+      compact_slot = NO_COMPACT_SLOT;
+    return true;
+  }
+}
+
+// Makes the new bank the active bank once all of the records have been copied
+static void finish_compaction()
+{
+  if (compact_address < compact_bank + JOURNAL_BANK_SIZE)
+    write_journal_byte(compact_address, RECORD_TAG_END);
+  
+  journal_sequence += 1;
+  write_bank_header(compact_bank, journal_sequence);
+  journal_bank = compact_bank;
+  compacting = false;
+  scan_journal();
+}
+
+// Copies the live records into the other bank which then becomes the active bank
+// (completing any compaction already in progress)
+static void compact_journal()
+{
+  if (!compacting)
+    start_compaction();
+  while (compact_journal_step())
+    ;
+  finish_compaction();
+}
+
+// Starts a background compaction once less than JOURNAL_COMPACT_MARGIN bytes of the
+// active bank are free, provided that at least that much can be reclaimed
+static bool should_start_compaction()
+{
+  const uint16_t used = journal_end - journal_bank;
+  if (JOURNAL_BANK_SIZE - used >= JOURNAL_COMPACT_MARGIN)
+    return false;
+  uint16_t live = JOURNAL_HEADER_LENGTH;
+  for (uint8_t i = 0; i < JOURNAL_INDEX_SIZE; i++)
+  {
+    if (journal_index[i] != 0 && read_journal_byte(journal_index[i] + 2) != 0)
+      live += JOURNAL_RECORD_OVERHEAD + read_journal_byte(journal_index[i] + 2);
+  }
+  return used - live >= JOURNAL_COMPACT_MARGIN;
+}
+
+static bool journal_matches(uint16_t address, const uint8_t *data, uint8_t length)
+{
+  for (uint8_t i = 0; i < length; i++)
+  {
+    if (read_journal_byte(address + i) != data[i])
+      return false;
+  }
+  return true;
+}
+
+// Appends a record which supersedes any earlier record with the same tag & key
+// (a length of 0 deletes the value).
+static uint8_t append_record(uint8_t tag, uint8_t key, const uint8_t *data, uint8_t length)
+{
+  uint8_t old_length;
+  const uint16_t old_data = find_record(tag, key, &old_length);
+  
+  // unchanged values are not rewritten so they do not wear the EEPROM
+  if (old_data == 0 ? (length == 0) : (old_length == length && journal_matches(old_data, data, length)))
+    return APP_ERROR_TYPE_SUCCESS;
+
+  const uint16_t record_length = JOURNAL_RECORD_OVERHEAD + length;
+  uint16_t *slot = find_index_slot(tag, key);
+  if (slot == 0 || journal_end + record_length > journal_bank + JOURNAL_BANK_SIZE)
+  {
+    // the bank is full (this only waits for the whole compaction if the background
+    // compaction has not already freed some space)
+    compact_journal();
+    slot = find_index_slot(tag, key);
+    if (slot == 0 || journal_end + record_length > journal_bank + JOURNAL_BANK_SIZE)
+      return PARAM_APP_ERROR_TYPE_FAILED;
+  }
+  
+  const uint16_t address = journal_end;
+  if (address + record_length < journal_bank + JOURNAL_BANK_SIZE)
+    write_journal_byte(address + record_length, RECORD_TAG_END);
+  
+  uint8_t crc = crc8_update(crc8_update(crc8_update(0, tag), key), length);
+  write_journal_byte(address + 1, key);
+  write_journal_byte(address + 2, length);
+  for (uint8_t i = 0; i < length; i++)
+  {
+    write_journal_byte(address + JOURNAL_RECORD_HEADER_LENGTH + i, data[i]);
+    crc = crc8_update(crc, data[i]);
+  }
+  write_journal_byte(address + record_length - 1, crc);
+  
+  // the tag is written last so an interrupted write leaves the journal unchanged
+  write_journal_byte(address, tag);
+  
+  // a value which has already been copied by a background compaction is copied again
+  const uint8_t slot_number = slot - journal_index;
+  if (compacting && slot_number < compact_next)
+    compact_dirty[slot_number / 8] |= (1 << (slot_number % 8));
+  *slot = address;
+  journal_check_compaction = true;
+  journal_end = address + record_length;
+  return APP_ERROR_TYPE_SUCCESS;
+}
+
+static int8_t read_record_string(uint8_t tag, uint8_t key, char *buffer, uint8_t buffer_len)
+{
+  uint8_t length;
+  const uint16_t address = find_record(tag, key, &length);
+  if (address == 0)
+    return -1;
+  uint8_t i = 0;
+  while (i < length && i < buffer_len)
+  {
+    buffer[i] = (char)read_journal_byte(address + i);
     i += 1;
   }
   if (i < buffer_len)
@@ -71,32 +418,107 @@ uint8_t read_eeprom_string(uint8_t *address, uint8_t max_length, char *buffer, u
   return i;
 }
 
-uint8_t update_eeprom_string(uint8_t *address, uint8_t max_length, const char *str)
+static int8_t read_record_string_P(uint8_t tag, const char *default_pstr, char *buffer, uint8_t buffer_len)
 {
-  uint8_t i = 0;
-  while (i < max_length)
+  const int8_t length = read_record_string(tag, 0, buffer, buffer_len);
+  if (length >= 0)
+    return length;
+  strncpy_P(buffer, default_pstr, buffer_len);
+  return min(strlen_P(default_pstr), buffer_len);
+}
+
+static uint8_t write_record_string(uint8_t tag, uint8_t key, const char *str, uint8_t max_length)
+{
+  return append_record(tag, key, (const uint8_t *)str, min(strlen(str), max_length));
+}
+
+static uint8_t read_record_byte(uint8_t tag, uint8_t key, uint8_t default_value)
+{
+  uint8_t length;
+  const uint16_t address = find_record(tag, key, &length);
+  return (address != 0) ? read_journal_byte(address) : default_value;
+}
+
+static uint16_t read_record_word(uint8_t tag, uint8_t offset)
+{
+  uint8_t length;
+  const uint16_t address = find_record(tag, 0, &length);
+  if (address == 0 || offset + 2 > length)
+    return 0;
+  return read_journal_byte(address + offset) | (read_journal_byte(address + offset + 1) << 8);
+}
+
+FORCE_INLINE uint8_t get_cached_pin_state(uint8_t pin)
+{
+  const uint8_t bits = (pin_state_cache[pin >> 2] >> ((pin & 3) * 2)) & 3;
+  return (bits == 0) ? INITIAL_PIN_STATE_HIGHZ : bits - 1;
+}
+
+static void set_cached_pin_state(uint8_t pin, uint8_t initial_state)
+{
+  const uint8_t shift = (pin & 3) * 2;
+  const uint8_t bits = (initial_state == INITIAL_PIN_STATE_HIGHZ) ? 0 : (initial_state + 1) & 3;
+  pin_state_cache[pin >> 2] = (pin_state_cache[pin >> 2] & ~(3 << shift)) | (bits << shift);
+}
+
+// Loads the RAM caches from the journal
+static void load_caches()
+{
+  memset(pin_state_cache, 0, sizeof(pin_state_cache));
+  for (uint8_t i = 0; i < JOURNAL_INDEX_SIZE; i++)
   {
-    char ch = str[i];
-    eeprom_update_byte(address + i, ch);
-    if (ch == '\0')
-      break;
-    i += 1;
+    const uint16_t record = journal_index[i];
+    if (record != 0 
+        && read_journal_byte(record) == RECORD_TAG_INITIAL_PIN_STATE
+        && read_journal_byte(record + 2) != 0
+        && read_journal_byte(record + 1) < NUM_DIGITAL_PINS)
+    {
+      set_cached_pin_state(read_journal_byte(record + 1), read_journal_byte(record + JOURNAL_RECORD_HEADER_LENGTH));
+    }
   }
-  return APP_ERROR_TYPE_SUCCESS;
+#if DEVICE_NAME_CACHE_SIZE > 0
+  memset(device_name_cache, 0, sizeof(device_name_cache));
+#endif
 }
 
-uint8_t update_eeprom_string_P(uint8_t *address, uint8_t max_length, const char *pstr)
+#if DEVICE_NAME_CACHE_SIZE > 0
+// Returns the cache entry for the device name (loading it from the journal if 
+// necessary) and makes it the most recently used entry.
+static DeviceNameCacheEntry *get_device_name_cache_entry(uint8_t device_type, uint8_t device_number)
 {
-  uint8_t i = 0;
-  while (i < max_length)
+  DeviceNameCacheEntry entry;
+  uint8_t i;
+  for (i = 0; i < DEVICE_NAME_CACHE_SIZE - 1; i++)
   {
-    char ch = pgm_read_byte(pstr+i);
-    eeprom_update_byte(address + i, ch);
-    if (ch == '\0')
+    if (device_name_cache[i].device_type == device_type 
+        && device_name_cache[i].device_number == device_number)
       break;
-    i += 1;
   }
-  return APP_ERROR_TYPE_SUCCESS;
+  if (device_name_cache[i].device_type == device_type 
+      && device_name_cache[i].device_number == device_number)
+  {
+    entry = device_name_cache[i];
+  }
+  else
+  {
+    // replace the least recently used entry
+    entry.device_type = device_type;
+    entry.device_number = device_number;
+    entry.length = read_record_string(RECORD_TAG_DEVICE_NAME + device_type, device_number, 
+        entry.name, sizeof(entry.name));
+  }
+  memmove(&device_name_cache[1], &device_name_cache[0], i * sizeof(entry));
+  device_name_cache[0] = entry;
+  return &device_name_cache[0];
+}
+#endif
+
+static void flush_snapshot_chunk()
+{
+  if (snapshot_chunk_number == 0xFF)
+    return;
+  append_record(RECORD_TAG_CONFIG_SNAPSHOT_CHUNK, snapshot_chunk_number, snapshot_chunk, CONFIG_SNAPSHOT_CHUNK_SIZE);
+  snapshot_chunk_number = 0xFF;
 }
 #endif
 
@@ -104,22 +526,30 @@ void
 NVConfigStore::Initialize()
 {
 #if USE_EEPROM
-  uint8_t format_num = eeprom_read_byte((uint8_t*)FORMAT_NUMBER_OFFSET);
-  uint16_t data_length_num = eeprom_read_word((uint16_t*)DATA_LENGTH_OFFSET);
-  uint16_t device_name_table_offset = eeprom_read_word((uint16_t*)DEVICE_NAME_TABLE_OFFSET_OFFSET);
-  uint8_t device_name_length = eeprom_read_byte((uint8_t*)DEVICE_NAME_LENGTH_OFFSET);
-  uint16_t initial_pin_state_table_offset = eeprom_read_word((uint16_t*)INITIAL_PIN_STATE_TABLE_OFFSET_OFFSET);
-  uint8_t initial_pin_state_table_length = eeprom_read_byte((uint8_t*)INITIAL_PIN_STATE_TABLE_LENGTH_OFFSET);
+  uint16_t sequence0, sequence1;
+  const bool valid0 = read_bank_header(0, &sequence0);
+  const bool valid1 = read_bank_header(JOURNAL_BANK_SIZE, &sequence1);
   
-  if ((format_num < EEPROM_FORMAT_VERSION || format_num == 0xFF)
-      || data_length_num < EEPROM_DATA_LENGTH
-      || device_name_table_offset != DEVICE_NAME_TABLE_OFFSET
-      || device_name_length != MAX_DEVICE_NAME_LENGTH
-      || initial_pin_state_table_offset != INITIAL_PIN_STATE_TABLE_OFFSET
-      || initial_pin_state_table_length != 2*MAX_NUM_INITIAL_PIN_STATES)
+  if (valid1 && (!valid0 || (int16_t)(sequence1 - sequence0) > 0))
   {
-    WriteDefaults(false);
+    journal_bank = JOURNAL_BANK_SIZE;
+    journal_sequence = sequence1;
   }
+  else if (valid0)
+  {
+    journal_bank = 0;
+    journal_sequence = sequence0;
+  }
+  else
+  {
+    // no valid journal (e.g., a new board or an older EEPROM format)
+    journal_bank = JOURNAL_BANK_SIZE;
+    journal_sequence = 0;
+    WriteDefaults(true);
+    return;
+  }
+  scan_journal();
+  load_caches();
 #endif  
 }
   
@@ -127,46 +557,60 @@ void
 NVConfigStore::WriteDefaults(bool reset_all)
 {
 #if USE_EEPROM
-  // we can improve this to only reset new elements when format number is increased later
-  // but as we only have one format version for now, just reset everything
-  eeprom_update_byte((uint8_t*)FORMAT_NUMBER_OFFSET, EEPROM_FORMAT_VERSION);
-  eeprom_update_word((uint16_t*)DATA_LENGTH_OFFSET, EEPROM_DATA_LENGTH);
-
-  // do we need to reset the device name cache?
-  uint16_t old_device_name_table_offset = eeprom_read_word((uint16_t*)DEVICE_NAME_TABLE_OFFSET);
-  uint8_t old_device_name_length = eeprom_read_byte((uint8_t*)DEVICE_NAME_LENGTH_OFFSET);
-  if (old_device_name_table_offset != DEVICE_NAME_TABLE_OFFSET
-      || old_device_name_length != MAX_DEVICE_NAME_LENGTH
-      || reset_all)
+  snapshot_chunk_number = 0xFF;
+  if (reset_all)
   {
-    for (uint8_t* addr=(uint8_t*)DEVICE_NAME_TABLE_OFFSET; addr<(uint8_t*)E2END; addr += MAX_DEVICE_NAME_LENGTH + 2)
-      eeprom_update_byte(addr,0xFF); // we only need to reset the device type to 0xFF
+    // compacting an empty index starts a new empty journal
+    memset(journal_index, 0, sizeof(journal_index));
+    start_compaction();
+    compact_journal();
+    load_caches();
+    return;
   }
-  eeprom_update_word((uint16_t*)DEVICE_NAME_TABLE_OFFSET, DEVICE_NAME_TABLE_OFFSET);
-  eeprom_update_byte((uint8_t*)DEVICE_NAME_LENGTH_OFFSET, MAX_DEVICE_NAME_LENGTH);
-  
-  // do we need to reset the initial pin state cache?
-  uint16_t old_initial_pin_state_table_offset = eeprom_read_word((uint16_t*)INITIAL_PIN_STATE_TABLE_OFFSET_OFFSET);
-  uint8_t old_initial_pin_state_table_length = eeprom_read_byte((uint8_t*)INITIAL_PIN_STATE_TABLE_LENGTH_OFFSET);
-  if (old_initial_pin_state_table_offset != INITIAL_PIN_STATE_TABLE_OFFSET
-      || old_initial_pin_state_table_length != 2*MAX_NUM_INITIAL_PIN_STATES
-      || reset_all)
+  // otherwise only the hardware identifiers are reset
+  append_record(RECORD_TAG_HARDWARE_TYPE, 0, 0, 0);
+  append_record(RECORD_TAG_HARDWARE_REV, 0, 0, 0);
+  append_record(RECORD_TAG_HARDWARE_NAME, 0, 0, 0);
+  append_record(RECORD_TAG_BOARD_ID, 0, 0, 0);
+  append_record(RECORD_TAG_BOARD_SERIAL_NUM, 0, 0, 0);
+#endif  
+}
+
+void 
+NVConfigStore::WritePendingData()
+{
+#if USE_EEPROM
+  if (compacting)
   {
-    for (uint8_t* addr=(uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET; 
-      addr<(uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET + (2*MAX_NUM_INITIAL_PIN_STATES); addr += 2)
+    // only as much of the compaction is queued as the write queue has room for
+    for (uint8_t i = 0; i < JOURNAL_COMPACT_STEP_LENGTH; i++)
     {
-      eeprom_update_byte(addr,0xFF); // we only need to reset the pin to 0xFF
+      if (pending_write_count == EEPROM_WRITE_QUEUE_SIZE)
+        break;
+      if (!compact_journal_step())
+      {
+        if (pending_write_count + JOURNAL_HEADER_LENGTH + 1 <= EEPROM_WRITE_QUEUE_SIZE)
+          finish_compaction();
+        break;
+      }
     }
   }
-  eeprom_update_word((uint16_t*)INITIAL_PIN_STATE_TABLE_OFFSET_OFFSET, INITIAL_PIN_STATE_TABLE_OFFSET);
-  eeprom_update_byte((uint8_t*)INITIAL_PIN_STATE_TABLE_LENGTH_OFFSET, 2*MAX_NUM_INITIAL_PIN_STATES);
-
-  // reset other values
-  eeprom_update_byte((uint8_t*)HARDWARE_TYPE_OFFSET, DEFAULT_HARDWARE_TYPE);
-  eeprom_update_byte((uint8_t*)HARDWARE_REV_OFFSET, DEFAULT_HARDWARE_REV);
-  update_eeprom_string_P((uint8_t*)HARDWARE_NAME_OFFSET, HARDWARE_NAME_LENGTH, PSTR(DEFAULT_HARDWARE_NAME)); 
-  update_eeprom_string_P((uint8_t*)BOARD_ID_OFFSET, BOARD_ID_LENGTH, PSTR(DEFAULT_BOARD_IDENTITY)); 
-  update_eeprom_string_P((uint8_t*)BOARD_SERIAL_NUM_OFFSET, BOARD_SERIAL_NUM_LENGTH, PSTR(DEFAULT_BOARD_SERIAL_NUMBER)); 
+  else if (journal_check_compaction && pending_write_count == 0)
+  {
+    journal_check_compaction = false;
+    if (should_start_compaction())
+      start_compaction();
+  }
+  write_pending_byte(false);
+#endif  
+}
+
+void 
+NVConfigStore::Flush()
+{
+#if USE_EEPROM
+  while (write_pending_byte(true))
+    ;
 #endif  
 }
 
@@ -174,7 +618,7 @@ int8_t
 NVConfigStore::GetBoardIdentity(char *buffer, uint8_t buffer_len)
 {
 #if USE_EEPROM
-  return read_eeprom_string((uint8_t*)BOARD_ID_OFFSET, BOARD_ID_LENGTH, buffer, buffer_len);
+  return read_record_string_P(RECORD_TAG_BOARD_ID, PSTR(DEFAULT_BOARD_IDENTITY), buffer, buffer_len);
 #else
   const char *pstr = PSTR(DEFAULT_BOARD_IDENTITY);
   strncpy_P(buffer, pstr, buffer_len);
@@ -186,7 +630,7 @@ int8_t
 NVConfigStore::GetBoardSerialNumber(char *buffer, uint8_t buffer_len)
 {
 #if USE_EEPROM
-  return read_eeprom_string((uint8_t*)BOARD_SERIAL_NUM_OFFSET, BOARD_SERIAL_NUM_LENGTH, buffer, buffer_len);
+  return read_record_string_P(RECORD_TAG_BOARD_SERIAL_NUM, PSTR(DEFAULT_BOARD_SERIAL_NUMBER), buffer, buffer_len);
 #else
   const char *pstr = PSTR(DEFAULT_BOARD_SERIAL_NUMBER);
   strncpy_P(buffer, pstr, buffer_len);
@@ -198,7 +642,7 @@ int8_t
 NVConfigStore::GetHardwareName(char *buffer, uint8_t buffer_len)
 {
 #if USE_EEPROM
-  return read_eeprom_string((uint8_t*)HARDWARE_NAME_OFFSET, HARDWARE_NAME_LENGTH, buffer, buffer_len);
+  return read_record_string_P(RECORD_TAG_HARDWARE_NAME, PSTR(DEFAULT_HARDWARE_NAME), buffer, buffer_len);
 #else
   const char *pstr = PSTR(DEFAULT_HARDWARE_NAME);
   strncpy_P(buffer, pstr, buffer_len);
@@ -210,7 +654,7 @@ uint8_t
 NVConfigStore::GetHardwareType()
 {
 #if USE_EEPROM
-  return eeprom_read_byte((uint8_t*)HARDWARE_TYPE_OFFSET);
+  return read_record_byte(RECORD_TAG_HARDWARE_TYPE, 0, DEFAULT_HARDWARE_TYPE);
 #else
   return DEFAULT_HARDWARE_TYPE;
 #endif  
@@ -220,7 +664,7 @@ uint8_t
 NVConfigStore::GetHardwareRevision()
 {
 #if USE_EEPROM
-  return eeprom_read_byte((uint8_t*)HARDWARE_REV_OFFSET);
+  return read_record_byte(RECORD_TAG_HARDWARE_REV, 0, DEFAULT_HARDWARE_REV);
 #else
   return DEFAULT_HARDWARE_REV;
 #endif  
@@ -229,14 +673,18 @@ NVConfigStore::GetHardwareRevision()
 int8_t NVConfigStore::GetDeviceName(uint8_t device_type, uint8_t device_number, char *buffer, uint8_t buffer_len)
 {
 #if USE_EEPROM
-  uint8_t *address = (uint8_t *)DEVICE_NAME_TABLE_OFFSET;
-  while (address < (uint8_t*)E2END)
-  {
-    if (device_type == eeprom_read_byte(address) && device_number == eeprom_read_byte(address+1))
-      return read_eeprom_string(address+2, MAX_DEVICE_NAME_LENGTH, buffer, buffer_len);
-    address += MAX_DEVICE_NAME_LENGTH + 2;
-  }
-  return -1;
+#if DEVICE_NAME_CACHE_SIZE > 0
+  const DeviceNameCacheEntry *entry = get_device_name_cache_entry(device_type, device_number);
+  if (entry->length < 0)
+    return -1;
+  const uint8_t length = min((uint8_t)entry->length, buffer_len);
+  memcpy(buffer, entry->name, length);
+  if (length < buffer_len)
+    buffer[length] = '\0';
+  return length;
+#else  
+  return read_record_string(RECORD_TAG_DEVICE_NAME + device_type, device_number, buffer, buffer_len);
+#endif  
 #else
   return -1;
 #endif  
@@ -245,7 +693,7 @@ int8_t NVConfigStore::GetDeviceName(uint8_t device_type, uint8_t device_number,
 uint8_t NVConfigStore::SetBoardIdentity(const char *buffer)
 {
 #if USE_EEPROM
-  return update_eeprom_string((uint8_t*)BOARD_ID_OFFSET, BOARD_ID_LENGTH, buffer);
+  return write_record_string(RECORD_TAG_BOARD_ID, 0, buffer, BOARD_ID_LENGTH);
 #else
   generate_response_msg_addPGM(PMSG(MSG_ERR_EEPROM_NOT_ENABLED));
   return PARAM_APP_ERROR_TYPE_FAILED;
@@ -255,7 +703,7 @@ uint8_t NVConfigStore::SetBoardIdentity(const char *buffer)
 uint8_t NVConfigStore::SetBoardSerialNumber(const char *buffer)
 {
 #if USE_EEPROM
-  return update_eeprom_string((uint8_t*)BOARD_SERIAL_NUM_OFFSET, BOARD_SERIAL_NUM_LENGTH, buffer);
+  return write_record_string(RECORD_TAG_BOARD_SERIAL_NUM, 0, buffer, BOARD_SERIAL_NUM_LENGTH);
 #else
   generate_response_msg_addPGM(PMSG(MSG_ERR_EEPROM_NOT_ENABLED));
   return PARAM_APP_ERROR_TYPE_FAILED;
@@ -265,7 +713,7 @@ uint8_t NVConfigStore::SetBoardSerialNumber(const char *buffer)
 uint8_t NVConfigStore::SetHardwareName(const char *buffer)
 {
 #if USE_EEPROM
-  return update_eeprom_string((uint8_t*)HARDWARE_NAME_OFFSET, HARDWARE_NAME_LENGTH, buffer);
+  return write_record_string(RECORD_TAG_HARDWARE_NAME, 0, buffer, HARDWARE_NAME_LENGTH);
 #else
   generate_response_msg_addPGM(PMSG(MSG_ERR_EEPROM_NOT_ENABLED));
   return PARAM_APP_ERROR_TYPE_FAILED;
@@ -275,8 +723,7 @@ uint8_t NVConfigStore::SetHardwareName(const char *buffer)
 uint8_t NVConfigStore::SetHardwareType(uint8_t type)
 {
 #if USE_EEPROM
-  eeprom_update_byte((uint8_t*)HARDWARE_TYPE_OFFSET, type);
-  return APP_ERROR_TYPE_SUCCESS;
+  return append_record(RECORD_TAG_HARDWARE_TYPE, 0, &type, 1);
 #else
   generate_response_msg_addPGM(PMSG(MSG_ERR_EEPROM_NOT_ENABLED));
   return PARAM_APP_ERROR_TYPE_FAILED;
@@ -286,8 +733,7 @@ uint8_t NVConfigStore::SetHardwareType(uint8_t type)
 uint8_t NVConfigStore::SetHardwareRevision(uint8_t rev)
 {
 #if USE_EEPROM
-  eeprom_update_byte((uint8_t*)HARDWARE_REV_OFFSET, rev);
-  return APP_ERROR_TYPE_SUCCESS;
+  return append_record(RECORD_TAG_HARDWARE_REV, 0, &rev, 1);
 #else
   generate_response_msg_addPGM(PMSG(MSG_ERR_EEPROM_NOT_ENABLED));
   return PARAM_APP_ERROR_TYPE_FAILED;
@@ -297,23 +743,17 @@ uint8_t NVConfigStore::SetHardwareRevision(uint8_t rev)
 uint8_t NVConfigStore::SetDeviceName(uint8_t device_type, uint8_t device_number, const char *buffer)
 {
 #if USE_EEPROM
-  uint8_t *address = (uint8_t*)DEVICE_NAME_TABLE_OFFSET;
-  while (address < (uint8_t*)E2END)
+  const uint8_t retval = write_record_string(RECORD_TAG_DEVICE_NAME + device_type, device_number, 
+      buffer, MAX_DEVICE_NAME_LENGTH);
+#if DEVICE_NAME_CACHE_SIZE > 0
+  if (retval == APP_ERROR_TYPE_SUCCESS)
   {
-    uint8_t type = eeprom_read_byte(address);
-    if (type == 0xFF)
-    {
-      eeprom_update_byte(address,device_type);
-      eeprom_update_byte(address+1,device_number);
-      return update_eeprom_string(address+2, MAX_DEVICE_NAME_LENGTH, buffer);
-    }
-    else if (type == device_type && eeprom_read_byte(address+1) == device_number)
-    {
-      return update_eeprom_string(address+2, MAX_DEVICE_NAME_LENGTH, buffer);
-    }
-    address += MAX_DEVICE_NAME_LENGTH + 2;
+    DeviceNameCacheEntry *entry = get_device_name_cache_entry(device_type, device_number);
+    entry->length = read_record_string(RECORD_TAG_DEVICE_NAME + device_type, device_number, 
+        entry->name, sizeof(entry->name));
   }
-  return PARAM_APP_ERROR_TYPE_FAILED;
+#endif
+  return retval;
 #else
   generate_response_msg_addPGM(PMSG(MSG_ERR_EEPROM_NOT_ENABLED));
   return PARAM_APP_ERROR_TYPE_FAILED;
@@ -323,14 +763,7 @@ uint8_t NVConfigStore::SetDeviceName(uint8_t device_type, uint8_t device_number,
 uint8_t NVConfigStore::GetInitialPinState(uint8_t pin)
 {
 #if USE_EEPROM
-  for (uint8_t *address=(uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET; 
-          address<(uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET+(2*MAX_NUM_INITIAL_PIN_STATES); address+=2)
-  {
-    uint8_t read_pin = eeprom_read_byte(address);
-    if (read_pin == pin)
-      return eeprom_read_byte(address + 1);
-  }
-  return INITIAL_PIN_STATE_HIGHZ;
+  return (pin < NUM_DIGITAL_PINS) ? get_cached_pin_state(pin) : INITIAL_PIN_STATE_HIGHZ;
 #else
   return INITIAL_PIN_STATE_HIGHZ;
 #endif  
@@ -339,35 +772,17 @@ uint8_t NVConfigStore::GetInitialPinState(uint8_t pin)
 uint8_t NVConfigStore::SetInitialPinState(uint8_t pin, uint8_t initial_state)
 {
 #if USE_EEPROM
-  uint8_t *free_slot_address = 0;
-  for (uint8_t *address=(uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET; 
-          address<(uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET+(2*MAX_NUM_INITIAL_PIN_STATES); address+=2)
-  {
-    uint8_t read_pin = eeprom_read_byte(address);
-    if (read_pin == 0xFF)
-    {
-      if (free_slot_address == 0)
-        free_slot_address = address;
-    }
-    else if (read_pin == pin)
-    {
-      if (initial_state == INITIAL_PIN_STATE_HIGHZ)
-      {
-        // as this is the default initial pin state we actually just remove the entry
-        eeprom_update_byte(address,0xFF);
-      }
-      else
-      {
-        eeprom_update_byte(address + 1, initial_state);
-      }
-      return APP_ERROR_TYPE_SUCCESS;
-    }
-  }
-  if (free_slot_address == 0)
-    return PARAM_APP_ERROR_TYPE_FAILED;
-  eeprom_update_byte(free_slot_address, pin);
-  eeprom_update_byte(free_slot_address + 1, initial_state);
-  return APP_ERROR_TYPE_SUCCESS;
+  if (pin >= NUM_DIGITAL_PINS)
+    return PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE;
+  uint8_t retval;
+  // as HIGHZ is the default initial pin state we actually just remove the entry
+  if (initial_state == INITIAL_PIN_STATE_HIGHZ)
+    retval = append_record(RECORD_TAG_INITIAL_PIN_STATE, pin, 0, 0);
+  else
+    retval = append_record(RECORD_TAG_INITIAL_PIN_STATE, pin, &initial_state, 1);
+  if (retval == APP_ERROR_TYPE_SUCCESS)
+    set_cached_pin_state(pin, initial_state);
+  return retval;
 #else
   generate_response_msg_addPGM(PMSG(MSG_ERR_EEPROM_NOT_ENABLED));
   return PARAM_APP_ERROR_TYPE_FAILED;
@@ -377,19 +792,123 @@ uint8_t NVConfigStore::SetInitialPinState(uint8_t pin, uint8_t initial_state)
 uint8_t NVConfigStore::GetNextInitialPinState(uint8_t *index, uint8_t *initial_state)
 {
 #if USE_EEPROM
-  for (uint8_t *address=(uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET + (2 * *index); 
-          address<(uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET+(2*MAX_NUM_INITIAL_PIN_STATES); address+=2)
+  for (uint8_t pin = *index; pin < NUM_DIGITAL_PINS; pin++)
   {
-    uint8_t read_pin = eeprom_read_byte(address);
-    if (read_pin == 0xFF)
+    const uint8_t state = get_cached_pin_state(pin);
+    if (state == INITIAL_PIN_STATE_HIGHZ)
       continue;
     // found next entry
-    *index = ((address - (uint8_t*)INITIAL_PIN_STATE_TABLE_OFFSET) / 2) + 1;
-    *initial_state = eeprom_read_byte(address + 1);
-    return read_pin;
+    *index = pin + 1;
+    *initial_state = state;
+    return pin;
   }
   return 0xFF;
 #else
   return 0xFF;
 #endif  
 }
+
+uint16_t NVConfigStore::GetConfigSnapshotCapacity()
+{
+#if USE_EEPROM
+  return CONFIG_SNAPSHOT_CAPACITY;
+#else
+  return 0;
+#endif  
+}
+
+uint16_t NVConfigStore::GetConfigSnapshotLength()
+{
+#if USE_EEPROM
+  uint16_t length = read_record_word(RECORD_TAG_CONFIG_SNAPSHOT_INFO, 0);
+  return (length <= CONFIG_SNAPSHOT_CAPACITY) ? length : 0;
+#else
+  return 0;
+#endif  
+}
+
+uint16_t NVConfigStore::GetConfigSnapshotHash()
+{
+#if USE_EEPROM
+  return read_record_word(RECORD_TAG_CONFIG_SNAPSHOT_INFO, 2);
+#else
+  return 0;
+#endif  
+}
+
+void NVConfigStore::ReadConfigSnapshot(uint16_t offset, uint8_t *buffer, uint8_t length)
+{
+#if USE_EEPROM
+  while (length > 0)
+  {
+    const uint8_t chunk_number = offset / CONFIG_SNAPSHOT_CHUNK_SIZE;
+    uint8_t position = offset % CONFIG_SNAPSHOT_CHUNK_SIZE;
+    uint8_t chunk_length = 0;
+    const uint16_t address = find_record(RECORD_TAG_CONFIG_SNAPSHOT_CHUNK, chunk_number, &chunk_length);
+    do
+    {
+      if (chunk_number == snapshot_chunk_number)
+        *buffer++ = snapshot_chunk[position];
+      else
+        *buffer++ = (address != 0 && position < chunk_length) ? read_journal_byte(address + position) : 0xFF;
+      position += 1;
+      offset += 1;
+      length -= 1;
+    }
+    while (length > 0 && position < CONFIG_SNAPSHOT_CHUNK_SIZE);
+  }
+#endif  
+}
+
+void NVConfigStore::WriteConfigSnapshot(uint16_t offset, const uint8_t *data, uint8_t length)
+{
+#if USE_EEPROM
+  // the data is gathered into chunks and only changed chunks are appended to the journal
+  for (uint8_t i = 0; i < length; i++, offset++)
+  {
+    const uint8_t chunk_number = offset / CONFIG_SNAPSHOT_CHUNK_SIZE;
+    if (chunk_number != snapshot_chunk_number)
+    {
+      flush_snapshot_chunk();
+      ReadConfigSnapshot(chunk_number * CONFIG_SNAPSHOT_CHUNK_SIZE, snapshot_chunk, CONFIG_SNAPSHOT_CHUNK_SIZE);
+      snapshot_chunk_number = chunk_number;
+    }
+    snapshot_chunk[offset % CONFIG_SNAPSHOT_CHUNK_SIZE] = data[i];
+  }
+#endif  
+}
+
+void NVConfigStore::CommitConfigSnapshot(uint16_t length, uint16_t hash)
+{
+#if USE_EEPROM
+  flush_snapshot_chunk();
+  if (length != 0)
+  {
+    // discard any chunks beyond the end of the new snapshot
+    for (uint8_t chunk_number = (length + CONFIG_SNAPSHOT_CHUNK_SIZE - 1) / CONFIG_SNAPSHOT_CHUNK_SIZE; 
+        chunk_number < CONFIG_SNAPSHOT_CAPACITY / CONFIG_SNAPSHOT_CHUNK_SIZE; chunk_number++)
+    {
+      append_record(RECORD_TAG_CONFIG_SNAPSHOT_CHUNK, chunk_number, 0, 0);
+    }
+  }
+  const uint8_t info[4] = { (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)hash, (uint8_t)(hash >> 8) };
+  append_record(RECORD_TAG_CONFIG_SNAPSHOT_INFO, 0, info, sizeof(info));
+#endif  
+}
+
+uint16_t NVConfigStore::GetConfigHash()
+{
+#if USE_EEPROM
+  return read_record_word(RECORD_TAG_CONFIG_HASH, 0);
+#else
+  return 0;
+#endif  
+}
+
+void NVConfigStore::SetConfigHash(uint16_t hash)
+{
+#if USE_EEPROM
+  const uint8_t value[2] = { (uint8_t)hash, (uint8_t)(hash >> 8) };
+  append_record(RECORD_TAG_CONFIG_HASH, 0, value, sizeof(value));
+#endif  
+}
@@ -35,51 +35,63 @@
 #define USE_EEPROM 1 // Set to 0 to use default/compiled in values.
 
 // EEPROM Contents and Layout
-#define FORMAT_NUMBER_OFFSET            0
-#define FORMAT_NUMBER_LENGTH            1
-#define DATA_LENGTH_OFFSET              (FORMAT_NUMBER_OFFSET+FORMAT_NUMBER_LENGTH)
-#define DATA_LENGTH_LENGTH              2
-#define DEVICE_NAME_TABLE_OFFSET_OFFSET (DATA_LENGTH_OFFSET+DATA_LENGTH_LENGTH)
-#define DEVICE_NAME_TABLE_OFFSET_LENGTH 2
-#define DEVICE_NAME_LENGTH_OFFSET       (DEVICE_NAME_TABLE_OFFSET_OFFSET+DEVICE_NAME_TABLE_OFFSET_LENGTH)
-#define DEVICE_NAME_LENGTH_LENGTH       1
-#define HARDWARE_TYPE_OFFSET            (DEVICE_NAME_LENGTH_OFFSET+DEVICE_NAME_LENGTH_LENGTH)
-#define HARDWARE_TYPE_LENGTH            1
-#define HARDWARE_REV_OFFSET             (HARDWARE_TYPE_OFFSET+HARDWARE_TYPE_LENGTH)
-#define HARDWARE_REV_LENGTH             1
-#define HARDWARE_NAME_OFFSET            (HARDWARE_REV_OFFSET+HARDWARE_REV_LENGTH)
+//
+// The EEPROM is split into two journal banks of which only one is active at a 
+// time. Values are never updated in place; instead each change is appended to 
+// the active bank as a record and superseded records are discarded when the live
+// records are compacted into the other bank (which spreads the wear across the 
+// whole EEPROM and means an interrupted write can only lose the latest change).
+//
+// Bank header:  [format number][sequence number (2 bytes)][crc8]
+// Record:       [tag][key][data length][data...][crc8]
+//
+// The bank with a valid header and the most recent sequence number is active. 
+// A tag of 0xFF marks the end of the journal and a record with no data deletes 
+// the value.
+//
+#define JOURNAL_BANK_SIZE               ((E2END+1)/2)
+#define JOURNAL_HEADER_LENGTH           4
+#define JOURNAL_RECORD_HEADER_LENGTH    3
+#define JOURNAL_RECORD_OVERHEAD         (JOURNAL_RECORD_HEADER_LENGTH+1)
+
+// The journal is compacted in the background (a few bytes per main loop iteration)
+// once less than the margin is free in the active bank
+#define JOURNAL_COMPACT_MARGIN          (JOURNAL_BANK_SIZE/8)
+#define JOURNAL_COMPACT_STEP_LENGTH     8
+
 #define HARDWARE_NAME_LENGTH            30
-#define BOARD_ID_OFFSET                 (HARDWARE_NAME_OFFSET+HARDWARE_NAME_LENGTH)
 #define BOARD_ID_LENGTH                 15
-#define BOARD_SERIAL_NUM_OFFSET         (BOARD_ID_OFFSET+BOARD_ID_LENGTH)
 #define BOARD_SERIAL_NUM_LENGTH         15
-#define INITIAL_PIN_STATE_TABLE_OFFSET_OFFSET    (BOARD_SERIAL_NUM_OFFSET+BOARD_SERIAL_NUM_LENGTH)
-#define INITIAL_PIN_STATE_TABLE_OFFSET_LENGTH    2
-#define INITIAL_PIN_STATE_TABLE_LENGTH_OFFSET   (INITIAL_PIN_STATE_TABLE_OFFSET_OFFSET+INITIAL_PIN_STATE_TABLE_OFFSET_LENGTH)
-#define INITIAL_PIN_STATE_TABLE_LENGTH_LENGTH   1
 
-// This is the length of all the above data
-#define EEPROM_DATA_LENGTH          (INITIAL_PIN_STATE_TABLE_LENGTH_OFFSET+INITIAL_PIN_STATE_TABLE_LENGTH_LENGTH)
-
-// Device Name store information
+// Journal capacity information (the journal index is held in RAM)
 #if E2END == 511  
   #define MAX_DEVICE_NAME_LENGTH        8
-  #define MAX_NUM_DEVICE_NAMES          20 // taking up top 200 bytes
-  #define MAX_NUM_INITIAL_PIN_STATES    20 // taking up top 40 bytes
+  #define JOURNAL_INDEX_SIZE            32 // a power of 2 (at most 128)
+  #define CONFIG_SNAPSHOT_CAPACITY      96
+  #define EEPROM_WRITE_QUEUE_SIZE       16 // a power of 2 (at most 128)
+  #define DEVICE_NAME_CACHE_SIZE        0  // set to 0 to disable
 #elif E2END == 1023
   #define MAX_DEVICE_NAME_LENGTH        10
-  #define MAX_NUM_DEVICE_NAMES          50 // taking up top 600 bytes
-  #define MAX_NUM_INITIAL_PIN_STATES    50 // taking up top 100 bytes
+  #define JOURNAL_INDEX_SIZE            64
+  #define CONFIG_SNAPSHOT_CAPACITY      192
+  #define EEPROM_WRITE_QUEUE_SIZE       32
+  #define DEVICE_NAME_CACHE_SIZE        0
 #else  
   #define MAX_DEVICE_NAME_LENGTH        16
-  #define MAX_NUM_DEVICE_NAMES          60 // taking up top 1080 bytes
-  #define MAX_NUM_INITIAL_PIN_STATES    60 // taking up top 120 bytes
+  #define JOURNAL_INDEX_SIZE            128
+  #define CONFIG_SNAPSHOT_CAPACITY      768
+  #define EEPROM_WRITE_QUEUE_SIZE       64
+  #define DEVICE_NAME_CACHE_SIZE        8
 #endif  
 
-#define DEVICE_NAME_TABLE_OFFSET        (E2END+1-((MAX_DEVICE_NAME_LENGTH+2)*MAX_NUM_DEVICE_NAMES)) // Start of device name store
-#define INITIAL_PIN_STATE_TABLE_OFFSET    (DEVICE_NAME_TABLE_OFFSET-(MAX_NUM_INITIAL_PIN_STATES*2)) // Start of pin initial states store
+// The initial pin states are cached in RAM (2 bits per pin) and the most recently
+// used device names (including devices without a name) are also cached in RAM.
+
+// The device configuration snapshot is stored as a series of fixed size chunks
+// so that only the chunks which have changed are rewritten
+#define CONFIG_SNAPSHOT_CHUNK_SIZE      16
 
-#define EEPROM_FORMAT_VERSION       1
+#define EEPROM_FORMAT_VERSION       2
 
 // Default Hardware Identifiers (these are used when resetting EEPROM config or  not using EEPROM)
 #define DEFAULT_BOARD_IDENTITY      ""
@@ -96,6 +108,12 @@ public:
   
   static void WriteDefaults(bool reset_all);
 
+  // EEPROM writes are queued (as each byte takes ~3.3ms to write) and are committed 
+  // by calling WritePendingData() from the idle loop. Flush() waits for all 
+  // queued writes to be committed.
+  static void WritePendingData();
+  static void Flush();
+
   static int8_t GetBoardIdentity(char *buffer, uint8_t buffer_len);
   static int8_t GetBoardSerialNumber(char *buffer, uint8_t buffer_len);
   static int8_t GetHardwareName(char *buffer, uint8_t buffer_len);
@@ -116,6 +134,18 @@ public:
   
   static uint8_t SetDeviceName(uint8_t device_type, uint8_t device_number, const char *buffer);
 
+  // Device configuration snapshot (a length of 0 means there is no valid snapshot)
+  static uint16_t GetConfigSnapshotCapacity();
+  static uint16_t GetConfigSnapshotLength();
+  static uint16_t GetConfigSnapshotHash();
+  static void ReadConfigSnapshot(uint16_t offset, uint8_t *buffer, uint8_t length);
+  static void WriteConfigSnapshot(uint16_t offset, const uint8_t *data, uint8_t length);
+  static void CommitConfigSnapshot(uint16_t length, uint16_t hash);
+  
+  // The configuration hash at the time the snapshot was taken
+  static uint16_t GetConfigHash();
+  static void SetConfigHash(uint16_t hash);
+
 };
 
 #endif//NV_CONFIG_STORE_H
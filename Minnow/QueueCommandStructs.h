@@ -27,6 +27,7 @@
 #define QUEUE_COMMAND_STRUCTS_H
  
 #include "AxisInfo.h"
+#include "Device_TemperatureSensor.h"
 
 #include <stdint.h>
 
@@ -93,7 +94,7 @@ struct SetHeaterTargetTempCommand
 {
   uint8_t command_type; // QUEUE_COMMAND_STRUCTS_TYPE_SET_HEATER_TARGET_TEMP
   uint8_t heater_number;
-  float target_temp;
+  temperature_t target_temp;
 };
 
 struct SetActiveToolheadCommand
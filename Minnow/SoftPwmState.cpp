@@ -23,18 +23,21 @@
 bool SoftPwmState::Init(uint8_t _num_devices, uint8_t _soft_pwm_scale)
 {
   uint8_t *memory = (uint8_t*)malloc(_num_devices * 
-    (sizeof(*output_reg) + sizeof(*output_bit) + sizeof(*pwm_power) + sizeof(*pwm_count)));
+    (sizeof(*output_reg) + sizeof(*output_bit) + sizeof(*pwm_power) + sizeof(*pwm_count)
+      + sizeof(*pwm_phase)));
   if (memory == 0)
     return false;
 
   pwm_power = memory;
   pwm_count = pwm_power + _num_devices;
   output_bit = pwm_count + _num_devices;
-  output_reg = (uint8_t **)(output_bit + _num_devices);
+  pwm_phase = output_bit + _num_devices;
+  output_reg = (uint8_t **)(pwm_phase + _num_devices);
      
   memset(pwm_power, 0, _num_devices * sizeof(*pwm_power));
   memset(output_bit, 0, _num_devices * sizeof(*output_bit));
   memset(pwm_count, 0, _num_devices * sizeof(*pwm_count));
+  memset(pwm_phase, 0, _num_devices * sizeof(*pwm_phase));
 
   num_devices = _num_devices;
   soft_pwm_scale = _soft_pwm_scale;
@@ -59,5 +62,34 @@ bool SoftPwmState::EnableSoftPwm(uint8_t device_number, uint8_t pin, bool enable
   {
     output_bit[device_number] = 0;
   }
+  UpdatePhases();
   return true;
 }
+
+// Spreads the start of the on phase of the enabled devices evenly across the pwm 
+// period so that their switch on currents do not all occur at the same time.
+void SoftPwmState::UpdatePhases()
+{
+  const uint8_t phase_mask = 0x7f & ~((1 << soft_pwm_scale) - 1);
+  uint8_t num_enabled = 0;
+  uint8_t i;
+  
+  for (i = 0; i < num_devices; i++)
+  {
+    if (output_bit[i] != 0)
+      num_enabled += 1;
+  }
+  uint8_t enabled_count = 0;
+  for (i = 0; i < num_devices; i++)
+  {
+    if (output_bit[i] != 0)
+    {
+      pwm_phase[i] = ((uint16_t)enabled_count * 0x80 / num_enabled) & phase_mask;
+      enabled_count += 1;
+    }
+    else
+    {
+      pwm_phase[i] = 0;
+    }
+  }
+}
@@ -49,8 +49,11 @@ private:
   uint8_t num_devices;
   uint8_t soft_pwm_scale;
   
+  void UpdatePhases();
+  
   uint8_t *pwm_power; // desired duty cycle for each device
   uint8_t *output_bit;
+  uint8_t *pwm_phase; // pwm_isr_count at which each device's on phase starts
   uint8_t **output_reg;
   
   uint8_t pwm_isr_count; // count across devices incremented by ISR
@@ -51,11 +51,22 @@
 #define MAX_STACK_SIZE                          400   // code will use all space in excess of this for the command queue
 
 #define MAX_RECV_BUF_LEN                        (PM_HEADER_SIZE + 265 + 1)
+#define MAX_EXTENDED_RECV_BUF_LEN               (PM_EXTENDED_HEADER_SIZE + 1024 + PM_EXTENDED_CHECK_CODE_SIZE)
+#define EXTENDED_RECV_BUF_SHARE                 3     // up to 1/N of the queue memory budget is used for 
+                                                      // receiving extended frames (if larger than MAX_RECV_BUF_LEN)
 #define MAX_RESPONSE_PARAM_LENGTH               128
 
 #define MIN_QUEUE_SIZE                          150   // If the firmware cannot allocate this much memory then it will fail
                                                       // (otherwise all excess memory is allocated to the queue)
 
+#define MAX_PENDING_EVENTS                      8     // events waiting to be sent to the host (2 bytes each)
+
+// The temperature history is shared by all of the sensors (one sample per sensor every 
+// interval), so it covers TEMPERATURE_HISTORY_LENGTH / <number of sensors> intervals. 
+// e.g., 32 samples with 2 sensors covers 16 intervals, i.e. 8 seconds.
+#define TEMPERATURE_HISTORY_LENGTH              32    // temperature samples kept for the host (6 bytes each, power of 2)
+#define TEMPERATURE_HISTORY_INTERVAL            500   // milliseconds between temperature history samples
+
 // The following values determines the size of bitmasks used to store some state
 // for these device states.
 // Note: dynamic allocation of individual devices is still handled separately, so 
@@ -84,6 +95,10 @@
 // A host timeout is declared if the host does not send a request within this period
 #define HOST_TIMEOUT_SECS      30
 
+// A queue low water event is sent to the host when the number of commands 
+// in the queue drops to this level (0 == only when the queue is drained).
+#define EVENT_QUEUE_LOW_WATER_LEVEL  4
+
 // Does the Arduino use an AT90USB USB Serial UART?
 #if defined (__AVR_AT90USB1287__) || defined (__AVR_AT90USB1286__) || defined (__AVR_AT90USB646__) || defined(__AVR_AT90USB647__)
   #define AT90USB
@@ -91,6 +106,15 @@
 
 #define MAX_STEP_FREQUENCY 40000 // Max step frequency (5000 pps / half step)
 
+// The host can stop the machine immediately (without waiting for the main loop
+// to process an emergency stop order) by sending a run of the following byte.
+// This is detected by the serial receive interrupt irrespective of framing so
+// it is disabled by default: only enable it (e.g., with a length of 8) if the 
+// host ensures that frames never contain a run of this length.
+// (Set the length to 0 to disable)
+#define EMERGENCY_STOP_ESCAPE_BYTE    0x18
+#define EMERGENCY_STOP_ESCAPE_LENGTH  0
+
 /////////////////////////////////////////////////////////////////////////////////
 // Boot time configuration (optional)
 //
@@ -0,0 +1,50 @@
+/*
+ Minnow Pacemaker client firmware.
+    
+ Copyright (C) 2013 Robert Fairlie-Cuninghame
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Crc 16 functions
+//
+
+#include "crc16.h"
+
+// A table driven implementation would need 512 bytes of flash so the 
+// byte-wise shift form is used instead (this is still only a handful of 
+// cycles per byte).
+static inline uint16_t crc16_update(uint16_t crc, uint8_t data)
+{
+  data ^= (uint8_t)crc;
+  data ^= data << 4;
+  return ((((uint16_t)data << 8) | (uint8_t)(crc >> 8)) ^ (uint8_t)(data >> 4) 
+          ^ ((uint16_t)data << 3));
+}
+
+uint16_t crc16(uint8_t *data, uint16_t length)
+{
+  return crc16_continue(data, length, 0xFFFF);
+}
+
+uint16_t crc16_continue(uint8_t *data, uint16_t length, uint16_t crc)
+{
+  while (length-- > 0)
+  {
+    crc = crc16_update(crc, *data);
+    data += 1;
+  }
+  return crc;
+}
@@ -0,0 +1,34 @@
+/*
+ Minnow Pacemaker client firmware.
+    
+ Copyright (C) 2013 Robert Fairlie-Cuninghame
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Crc 16 functions
+//
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+
+// CRC-16 (reflected CCITT polynomial 0x8408, initial value 0xFFFF, no final xor;
+// also known as CRC-16/MCRF4XX) as used by extended frames
+uint16_t crc16(uint8_t *data, uint16_t length);
+uint16_t crc16_continue(uint8_t *data, uint16_t length, uint16_t initial_crc_value);
+
+#endif
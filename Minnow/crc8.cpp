@@ -81,3 +81,8 @@ uint8_t crc8_continue(uint8_t *data, uint16_t length, uint8_t crc)
   }
   return crc;
 }
+
+uint8_t crc8_update(uint8_t crc, uint8_t data)
+{
+  return pgm_read_byte_near(crc_array + (data ^ crc));
+}
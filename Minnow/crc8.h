@@ -28,5 +28,6 @@
 
 uint8_t crc8(uint8_t *data, uint16_t length);
 uint8_t crc8_continue(uint8_t *data, uint16_t length, uint8_t initial_crc_value);
+uint8_t crc8_update(uint8_t crc, uint8_t data);
 
 #endif
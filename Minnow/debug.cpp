@@ -22,7 +22,7 @@
 
 #if DEBUG_ENABLED
 
-#include "crc8.h"
+#include "response.h"
 
 // Constructors ////////////////////////////////////////////////////////////////
 
@@ -55,12 +55,10 @@ void DebugSerial::flush()
   {
     debug_header[PM_LENGTH_BYTE_OFFSET] = debug_buf_len + 2;
     debug_header[PM_CONTROL_BYTE_OFFSET] = CONTROL_BYTE_RESPONSE_DEBUG_BIT | (debug_sequence_number++ & CONTROL_BYTE_SEQUENCE_NUMBER_MASK);
-    PSERIAL.write(debug_header, sizeof(debug_header));
-    PSERIAL.write(debug_buf, debug_buf_len);
     // take crc over header and parameter (except sync byte)
-    uint8_t crc = crc8(&debug_header[1], PM_HEADER_SIZE-1);
-    if (debug_buf_len > 0)
-      crc = crc8_continue(debug_buf, debug_buf_len, crc);
+    PSERIAL.write(debug_header[PM_SYNC_BYTE_OFFSET]);
+    uint8_t crc = write_frame_bytes(&debug_header[PM_LENGTH_BYTE_OFFSET], PM_HEADER_SIZE-1, 0);
+    crc = write_frame_bytes(debug_buf, debug_buf_len, crc);
     PSERIAL.write(crc);
     debug_buf_len = 0;
   }
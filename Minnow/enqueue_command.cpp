@@ -32,6 +32,7 @@
 #include "AxisInfo.h"
 
 extern bool is_checkpoint_last;
+extern bool is_checkpoint_reported;
 
 static void send_enqueue_error(uint8_t error_type, uint8_t block_index, uint8_t reply_error_code = 0xFF);
 static uint8_t generate_enqueue_insufficient_bytes_error(uint8_t expected_num_bytes, uint8_t rcvd_num_bytes);
@@ -328,14 +329,13 @@ FORCE_INLINE uint8_t enqueue_set_heater_target_temperature_command(const uint8_t
     return ENQUEUE_ERROR_QUEUE_FULL;
   
   uint8_t heater_number = queue_command[0];
-  int16_t target_temp = (queue_command[1] << 8) | queue_command[2];
-  float target_ftemp = (float)target_temp / 10;
+  const temperature_t target_temp = decidegrees_to_temperature((queue_command[1] << 8) | queue_command[2]);
   
-  uint8_t retval = Device_Heater::ValidateTargetTemperature(heater_number, target_ftemp);
+  uint8_t retval = Device_Heater::ValidateTargetTemperature(heater_number, target_temp);
   if (retval != APP_ERROR_TYPE_SUCCESS)
     return retval;
 
-  if (is_stopped && target_ftemp != SENSOR_TEMPERATURE_INVALID)
+  if (is_stopped && target_temp != SENSOR_TEMPERATURE_INVALID)
   {
     generate_response_msg_addPGM(PMSG(MSG_ERR_CANNOT_ACTIVATE_DEVICE_WHEN_STOPPED));
     return PARAM_APP_ERROR_TYPE_DEVICE_UNAVAILABLE;
@@ -344,7 +344,7 @@ FORCE_INLINE uint8_t enqueue_set_heater_target_temperature_command(const uint8_t
   SetHeaterTargetTempCommand *cmd = (SetHeaterTargetTempCommand *)insertion_point;
   cmd->command_type = QUEUE_COMMAND_STRUCTS_TYPE_SET_HEATER_TARGET_TEMP;
   cmd->heater_number = queue_command[0];
-  cmd->target_temp = target_ftemp;
+  cmd->target_temp = target_temp;
 
   CommandQueue::EnqueueCommand(sizeof(SetHeaterTargetTempCommand));
   return ENQUEUE_SUCCESS;
@@ -751,6 +751,8 @@ uint8_t enqueue_linear_move_command(const uint8_t *queue_command, uint8_t queue_
 
 uint8_t enqueue_move_checkpoint_command(const uint8_t *queue_command, uint8_t queue_command_length)
 {
+  // clear the reported flag first as the ISR may check these at any time
+  is_checkpoint_reported = false;
   is_checkpoint_last = true;
   return ENQUEUE_SUCCESS;
 }
\ No newline at end of file
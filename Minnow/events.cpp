@@ -0,0 +1,110 @@
+/*
+ Minnow Pacemaker client firmware.
+    
+ Copyright (C) 2013 Robert Fairlie-Cuninghame
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Pending event queue and unsolicited event frame generation
+//
+// Events are raised by the ISRs and the emergency stop handler. Each event 
+// is stored as a (type, data) byte pair and all pending events are sent
+// together in a single unsolicited event frame from the main loop.
+//
+
+#include "events.h"
+#include "protocol.h"
+#include "response.h"
+
+#include "Minnow.h"
+
+//===========================================================================
+//=============================imported variables============================
+//===========================================================================
+
+extern bool response_squelch;
+
+//===========================================================================
+//=============================private variables=============================
+//===========================================================================
+
+static uint8_t event_buf[MAX_PENDING_EVENTS * 2];
+static volatile uint8_t event_buf_len = 0;
+static volatile uint8_t events_lost = 0;
+
+static uint8_t event_header[PM_HEADER_SIZE] = 
+    { SYNC_BYTE_RESPONSE_VALUE, 0, 0, UNSOLICITED_FRAME_EVENT };
+static uint8_t event_sequence_number = 0;
+
+//===========================================================================
+//=============================public variables=============================
+//===========================================================================
+
+//===========================================================================
+//============================= ROUTINES =============================
+//===========================================================================
+
+void raise_event(uint8_t event_type, uint8_t event_data)
+{
+  CRITICAL_SECTION_START
+  if (event_buf_len < sizeof(event_buf))
+  {
+    event_buf[event_buf_len] = event_type;
+    event_buf[event_buf_len+1] = event_data;
+    event_buf_len += 2;
+  }
+  else if (events_lost != 0xFF)
+  {
+    events_lost += 1;
+  }
+  CRITICAL_SECTION_END
+}
+
+bool events_pending()
+{
+  return (event_buf_len != 0 || events_lost != 0);
+}
+
+void send_pending_events()
+{
+  uint8_t frame_buf[sizeof(event_buf) + 2];
+  uint8_t frame_len = 0;
+  
+  if (!events_pending() || response_squelch)
+    return;
+  
+  // take a copy so that events raised while sending are not lost
+  CRITICAL_SECTION_START
+  if (events_lost != 0)
+  {
+    frame_buf[frame_len++] = PARAM_EVENT_TYPE_EVENTS_LOST;
+    frame_buf[frame_len++] = events_lost;
+    events_lost = 0;
+  }
+  memcpy(&frame_buf[frame_len], event_buf, event_buf_len);
+  frame_len += event_buf_len;
+  event_buf_len = 0;
+  CRITICAL_SECTION_END
+  
+  event_header[PM_LENGTH_BYTE_OFFSET] = frame_len + 2;
+  event_header[PM_CONTROL_BYTE_OFFSET] = CONTROL_BYTE_RESPONSE_EVENT_BIT 
+      | (event_sequence_number++ & CONTROL_BYTE_SEQUENCE_NUMBER_MASK);
+  // take crc over header and parameter (except sync byte)
+  PSERIAL.write(event_header[PM_SYNC_BYTE_OFFSET]);
+  uint8_t crc = write_frame_bytes(&event_header[PM_LENGTH_BYTE_OFFSET], PM_HEADER_SIZE-1, 0);
+  crc = write_frame_bytes(frame_buf, frame_len, crc);
+  PSERIAL.write(crc);
+}
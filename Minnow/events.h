@@ -0,0 +1,51 @@
+/*
+ Minnow Pacemaker client firmware.
+    
+ Copyright (C) 2013 Robert Fairlie-Cuninghame
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Pending event queue and unsolicited event frame generation
+//
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+
+//
+// Queues an event for delivery to the host. 
+//
+// This may be called from ISRs. If the event queue is full the event is 
+// dropped and reported to the host as a lost event count.
+//
+void raise_event(uint8_t event_type, uint8_t event_data);
+
+//
+// Returns true if there are events waiting to be sent to the host.
+// (This is used to set the event bit in the control byte of responses.)
+//
+bool events_pending();
+
+//
+// Sends all pending events in a single unsolicited event frame.
+//
+// This must only be called from the main loop when no response is being
+// generated.
+//
+void send_pending_events();
+
+#endif
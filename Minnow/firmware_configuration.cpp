@@ -31,6 +31,9 @@
 #include "NVConfigStore.h"
 #include "CommandQueue.h"
 #include "initial_pin_state.h"
+#include "order_helpers.h"
+#include "crc16.h"
+#include "AxisInfo.h"
 
 #include "Device_InputSwitch.h"
 #include "Device_OutputSwitch.h"
@@ -40,15 +43,34 @@
 #include "Device_Stepper.h"
 #include "Device_TemperatureSensor.h"
 
-FORCE_INLINE static void generate_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id);
-FORCE_INLINE static bool set_uint8_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, uint8_t value);
-FORCE_INLINE static bool set_int16_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, int16_t value);
-FORCE_INLINE static bool set_bool_value(uint8_t node_type, uint8_t parent_instance_id, uint8_t instance_id, bool value);
-FORCE_INLINE static bool set_string_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, const char *value);
-FORCE_INLINE static bool set_float_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, float value);
+FORCE_INLINE static void generate_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id);
+
+// The current value of a numeric (UINT8, INT16, BOOL or FLOAT) leaf
+union numeric_value_type
+{
+  int16_t integer; // UINT8, INT16 & BOOL
+  float real; // FLOAT
+};
+static bool is_numeric_datatype(uint8_t datatype);
+static bool read_numeric_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,
+    numeric_value_type &value);
+FORCE_INLINE static bool set_uint8_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, uint8_t value);
+FORCE_INLINE static bool set_int16_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, int16_t value);
+FORCE_INLINE static bool set_bool_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id, uint8_t instance_id, bool value);
+FORCE_INLINE static bool set_string_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, const char *value);
+FORCE_INLINE static bool set_float_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, float value);
 FORCE_INLINE static bool setPin(uint8_t node_type, uint8_t device_number, uint8_t pin);
+FORCE_INLINE static bool check_set_result(uint8_t retval);
 
 static bool read_number(long &number, const char *value);
+static const char *stringify_pid_autotune_state(uint8_t state);
+
+static void update_configuration_hash(const ConfigurationTreeNode *node, uint8_t device_number,
+    const uint8_t *value, uint8_t value_length);
+
+// Rolling hash of all configuration applied since reset (or restored from 
+// the configuration snapshot)
+uint16_t firmware_configuration_hash = 0xFFFF;
 
 void handle_firmware_configuration_value_properties(const char *name)
 {
@@ -147,6 +169,296 @@ void handle_firmware_configuration_traversal(const char *name)
   generate_response_send();
 }
 
+void handle_firmware_configuration_traversal_page(uint8_t flags, const uint8_t *cursor, uint16_t cursor_length)
+{
+  extern uint8_t reply_frame[];
+  extern uint8_t * const reply_buf;
+  extern uint8_t reply_data_len;
+  extern uint8_t *recv_buf;
+  extern uint16_t recv_buf_size;
+  extern bool response_squelch;
+  ConfigurationTree tree;
+  
+  ConfigurationTreeNode *node;
+  if (cursor_length == 0)
+  {
+    node = tree.FindFirstLeafNode(tree.GetRootNode());
+  }
+  else
+  {
+    if (cursor_length > MAX_CONFIGURATION_TREE_CURSOR_LENGTH || tree.SetCursor(cursor, cursor_length) == 0)
+    {
+      send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE,
+                        PMSG(ERR_MSG_CONFIG_NODE_NOT_FOUND));
+      return;
+    }
+    node = tree.FindNextLeafNode(tree.GetRootNode());
+  }
+
+  // The entries are assembled in the receive buffer (which is not needed again until
+  // the next order) as the values are generated in the response buffer. Space is 
+  // reserved in the response for the cursor.
+  uint8_t * const page = recv_buf;
+  const uint8_t page_size = min(recv_buf_size, 
+      MAX_RESPONSE_PARAM_LENGTH - 1 - MAX_CONFIGURATION_TREE_CURSOR_LENGTH);
+  uint8_t page_length = 0;
+  uint8_t next_cursor[MAX_CONFIGURATION_TREE_CURSOR_LENGTH];
+  uint8_t next_cursor_length = 0;
+
+  for (; node != 0; node = tree.FindNextLeafNode(tree.GetRootNode()))
+  {
+    uint8_t entry_length = 0;
+    int8_t length = tree.GetFullName(node, (char *)&page[page_length + 1], page_size - page_length - 1);
+    if (length <= 0)
+      break;
+    page[page_length] = length;
+    entry_length = 1 + length;
+    
+    if ((flags & PARAM_TRAVERSE_FLAG_VALUES) != 0)
+    {
+      reply_data_len = 0;
+      if ((node->GetLeafOperations() & FIRMWARE_CONFIG_OPS_READABLE) != 0)
+      {
+        // the value is only generated (not sent) so it can be copied into the page
+        const bool squelch = response_squelch;
+        response_squelch = true;
+        generate_value(node, tree.GetParentNode(node)->GetInstanceId(), node->GetInstanceId());
+        response_squelch = squelch;
+        if (reply_frame[PM_ORDER_BYTE_OFFSET] != RSP_OK)
+          reply_data_len = 0;
+      }
+      if (page_length + entry_length + 1 + reply_data_len > page_size)
+        break;
+      page[page_length + entry_length] = reply_data_len;
+      memcpy(&page[page_length + entry_length + 1], reply_buf, reply_data_len);
+      entry_length += 1 + reply_data_len;
+    }
+    
+    if ((flags & PARAM_TRAVERSE_FLAG_PROPERTIES) != 0)
+    {
+      if (page_length + entry_length + 2 > page_size)
+        break;
+      page[page_length + entry_length] = node->GetLeafClass();
+      page[page_length + entry_length + 1] = node->GetLeafOperations();
+      entry_length += 2;
+    }
+    
+    page_length += entry_length;
+    next_cursor_length = tree.GetCursor(node, next_cursor, sizeof(next_cursor));
+  }
+  
+  if (node != 0 && page_length == 0)
+  {
+    send_app_error_response(PARAM_APP_ERROR_TYPE_FIRMWARE_ERROR, 0);
+    return;
+  }
+  
+  // an empty cursor indicates that the traversal is complete
+  generate_response_start(RSP_OK);
+  if (node == 0)
+  {
+    generate_response_data_addbyte(0);
+  }
+  else
+  {
+    generate_response_data_addbyte(next_cursor_length);
+    generate_response_data_add(next_cursor, next_cursor_length);
+  }
+  generate_response_data_add(page, page_length);
+  generate_response_send();
+}
+
+void handle_firmware_configuration_handle_request(const char *name)
+{
+  ConfigurationTree tree;
+
+  ConfigurationTreeNode *node = (name[0] != '\0') ? tree.FindNode(name) : 0;
+  if (node == 0 || !node->IsLeafNode())
+  {
+    send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE,
+                      PMSG(ERR_MSG_CONFIG_NODE_NOT_FOUND), name);
+    return;
+  }
+  
+  generate_response_start(RSP_OK);
+  generate_response_data_addbyte(node->GetNodeType());
+  generate_response_data_addbyte(tree.GetParentNode(node)->GetInstanceId());
+  generate_response_data_addbyte(node->GetLeafSetDataType());
+  generate_response_data_addbyte(node->GetLeafOperations());
+  generate_response_send();
+}
+
+// Includes a successful configuration write in the configuration hash. Writes are
+// hashed in binary form so that they are hashed the same whether they are made by 
+// name or by handle.
+static void update_configuration_hash(const ConfigurationTreeNode *node, uint8_t device_number,
+    const uint8_t *value, uint8_t value_length)
+{
+  const uint8_t leaf_class = node->GetLeafClass();
+  if (leaf_class != FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG 
+      && leaf_class != FIRMWARE_CONFIG_TYPE_NONVOLATILE_CONFIG)
+    return; // operations are not configuration
+    
+  uint8_t handle[PM_CONFIG_HANDLE_SIZE] = { node->GetNodeType(), device_number };
+  update_firmware_configuration_hash(handle, sizeof(handle));
+  update_firmware_configuration_hash(value, value_length);
+}
+
+void update_firmware_configuration_hash(const uint8_t *data, uint16_t length)
+{
+  firmware_configuration_hash = crc16_continue((uint8_t *)data, length, firmware_configuration_hash);
+}
+
+// Returns the length of the binary encoding of a value (or 0 if variable length)
+static uint8_t get_binary_value_length(uint8_t datatype)
+{
+  switch (datatype)
+  {
+  case LEAF_SET_DATATYPE_UINT8:
+  case LEAF_SET_DATATYPE_BOOL:
+    return 1;
+  case LEAF_SET_DATATYPE_INT16:
+    return 2;
+  case LEAF_SET_DATATYPE_FLOAT:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+// Validates a configuration handle and returns the corresponding leaf node
+// (or sends an error response and returns 0).
+static ConfigurationTreeNode *find_handle_node(ConfigurationTree &tree, 
+    uint8_t node_type, uint8_t device_number, uint8_t required_operation)
+{
+  ConfigurationTreeNode *node = tree.FindLeafNode(node_type);
+  if (node != 0)
+  {
+    const uint8_t device_type = node->GetLeafDeviceType();
+    if ((device_type == PM_DEVICE_TYPE_INVALID) ? (device_number != INVALID_INSTANCE_ID)
+          : (device_number >= get_num_devices(device_type)))
+      node = 0;
+  }
+  if (node == 0)
+  {
+    send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE,
+                      PMSG(ERR_MSG_INVALID_CONFIG_HANDLE));
+    return 0;
+  }
+  if ((node->GetLeafOperations() & required_operation) == 0)
+  {
+    send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE,
+                      (required_operation == FIRMWARE_CONFIG_OPS_READABLE) ? 
+                      PMSG(ERR_MSG_CONFIG_NODE_NOT_READABLE) : PMSG(ERR_MSG_CONFIG_NODE_NOT_WRITEABLE));
+    return 0;
+  }
+  return node;
+}
+
+void handle_firmware_configuration_read_by_handle(uint8_t node_type, uint8_t device_number)
+{
+  extern bool response_squelch;
+  extern uint8_t reply_frame[];
+  extern uint8_t * const reply_buf;
+  extern uint8_t reply_data_len;
+  ConfigurationTree tree;
+  
+  ConfigurationTreeNode *node = find_handle_node(tree, node_type, device_number, 
+      FIRMWARE_CONFIG_OPS_READABLE);
+  if (node == 0)
+    return;
+    
+  const uint8_t datatype = node->GetLeafSetDataType();
+  if (!is_numeric_datatype(datatype))
+  {
+    // string and status values are the same as when read by name
+    generate_value(node, device_number, node->GetInstanceId());
+    return;
+  }
+  
+  // numeric values are encoded directly (an empty value means no current value)
+  numeric_value_type value;
+  generate_response_start(RSP_OK);
+  if (read_numeric_value(node, device_number, value))
+  {
+    if (datatype == LEAF_SET_DATATYPE_FLOAT)
+    {
+      union { float f; uint32_t u; } number;
+      number.f = value.real;
+      generate_response_data_add(number.u);
+    }
+    else if (datatype == LEAF_SET_DATATYPE_INT16)
+    {
+      generate_response_data_add(value.integer);
+    }
+    else
+    {
+      generate_response_data_addbyte(value.integer);
+    }
+  }
+  generate_response_send();
+}
+
+void handle_firmware_configuration_write_by_handle(uint8_t node_type, uint8_t device_number, 
+    const uint8_t *value, uint16_t value_length)
+{
+  ConfigurationTree tree;
+  
+  ConfigurationTreeNode *node = find_handle_node(tree, node_type, device_number, 
+      FIRMWARE_CONFIG_OPS_WRITEABLE);
+  if (node == 0)
+    return;
+
+  const uint8_t datatype = node->GetLeafSetDataType();
+  const uint8_t expected_length = get_binary_value_length(datatype);
+  if (value_length < expected_length)
+  {
+    send_insufficient_bytes_error_response(PM_CONFIG_HANDLE_SIZE + expected_length);
+    return;
+  }
+
+  generate_response_start(RSP_APPLICATION_ERROR, 1);
+
+  bool success;
+  switch (datatype)
+  {
+  case LEAF_SET_DATATYPE_UINT8:
+    success = set_uint8_value(node, device_number, node->GetInstanceId(), value[0]);
+    break;
+  case LEAF_SET_DATATYPE_BOOL:
+    success = set_bool_value(node, device_number, node->GetInstanceId(), value[0] != 0);
+    break;
+  case LEAF_SET_DATATYPE_INT16:
+    success = set_int16_value(node, device_number, node->GetInstanceId(), 
+        (value[0] << 8) | value[1]);
+    break;
+  case LEAF_SET_DATATYPE_FLOAT:
+  {
+    union { float f; uint32_t u; } number;
+    number.u = ((uint32_t)value[0] << 24) | ((uint32_t)value[1] << 16) 
+        | ((uint32_t)value[2] << 8) | value[3];
+    success = set_float_value(node, device_number, node->GetInstanceId(), number.f);
+    break;
+  }
+  case LEAF_SET_DATATYPE_STRING:
+    // note: get_command() already makes the end of the command (ie. value) null-terminated
+    success = set_string_value(node, device_number, node->GetInstanceId(), (const char *)value);
+    break;
+  default:
+    send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_FORMAT,
+                            PMSG(MSG_ERR_CANNOT_HANDLE_FIRMWARE_CONFIG_REQUEST), __LINE__);
+    return;
+  }
+  
+  if (success)
+  {
+    update_configuration_hash(node, device_number, value, 
+        (expected_length != 0) ? expected_length : strlen((const char *)value));
+    send_OK_response();
+  }
+  // otherwise assume that set function has generated an error response
+}
+
 void handle_firmware_configuration_request(const char *name, const char* value)
 {
   ConfigurationTree tree;
@@ -182,7 +494,7 @@ void handle_firmware_configuration_request(const char *name, const char* value)
                       PMSG(ERR_MSG_CONFIG_NODE_NOT_READABLE));
       return;
     }
-    generate_value(node->GetNodeType(), tree.GetParentNode(node)->GetInstanceId(), node->GetInstanceId());
+    generate_value(node, tree.GetParentNode(node)->GetInstanceId(), node->GetInstanceId());
   }
   else
   {
@@ -195,6 +507,11 @@ void handle_firmware_configuration_request(const char *name, const char* value)
     
     generate_response_start(RSP_APPLICATION_ERROR, 1);
 
+    // binary form of the value for the configuration hash
+    uint8_t binary_value[4];
+    const uint8_t *hash_value = binary_value;
+    uint8_t hash_value_length = get_binary_value_length(node->GetLeafSetDataType());
+
     // ensure value has correct format and then attempt to set
     switch (node->GetLeafSetDataType())
     {
@@ -209,11 +526,12 @@ void handle_firmware_configuration_request(const char *name, const char* value)
         return;
       }
 
-      if (!set_uint8_value(node->GetNodeType(), tree.GetParentNode(node)->GetInstanceId(), 
+      if (!set_uint8_value(node, tree.GetParentNode(node)->GetInstanceId(), 
           node->GetInstanceId(), number))
       {
         return; // assume that set function has generated an error response
       }
+      binary_value[0] = number;
       break;
     }
     
@@ -227,11 +545,13 @@ void handle_firmware_configuration_request(const char *name, const char* value)
         return;
       }
 
-      if (!set_int16_value(node->GetNodeType(), tree.GetParentNode(node)->GetInstanceId(), 
+      if (!set_int16_value(node, tree.GetParentNode(node)->GetInstanceId(), 
           node->GetInstanceId(), number))
       {
         return; // assume that set function has generated an error response
       }
+      binary_value[0] = (uint16_t)number >> 8;
+      binary_value[1] = number & 0xFF;
       break;
     }    
     
@@ -253,21 +573,24 @@ void handle_firmware_configuration_request(const char *name, const char* value)
         return;
       }
       
-      if (!set_bool_value(node->GetNodeType(), tree.GetParentNode(node)->GetInstanceId(), 
+      if (!set_bool_value(node, tree.GetParentNode(node)->GetInstanceId(), 
           node->GetInstanceId(), val))
       {
         return; // assume that set function has generated an error response
       }
+      binary_value[0] = val;
       break;
     }
     
     case LEAF_SET_DATATYPE_STRING:
     {
-      if (!set_string_value(node->GetNodeType(), tree.GetParentNode(node)->GetInstanceId(), 
+      if (!set_string_value(node, tree.GetParentNode(node)->GetInstanceId(), 
           node->GetInstanceId(), value))
       {
         return; // assume that set function has generated an error response
       }
+      hash_value = (const uint8_t *)value;
+      hash_value_length = strlen(value);
       break;
     }
     
@@ -282,11 +605,17 @@ void handle_firmware_configuration_request(const char *name, const char* value)
         return;
       }
 
-      if (!set_float_value(node->GetNodeType(), tree.GetParentNode(node)->GetInstanceId(), 
+      if (!set_float_value(node, tree.GetParentNode(node)->GetInstanceId(), 
           node->GetInstanceId(), val))
       {
         return; // assume that set function has generated an error response
       }
+      union { float f; uint32_t u; } number;
+      number.f = val;
+      binary_value[0] = number.u >> 24;
+      binary_value[1] = (number.u >> 16) & 0xFF;
+      binary_value[2] = (number.u >> 8) & 0xFF;
+      binary_value[3] = number.u & 0xFF;
       break;
     }
     
@@ -296,11 +625,13 @@ void handle_firmware_configuration_request(const char *name, const char* value)
       return;
     }
 
+    update_configuration_hash(node, tree.GetParentNode(node)->GetInstanceId(), 
+        hash_value, hash_value_length);
     send_OK_response();
   }
 }
 
-void generate_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id)
+void generate_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id)
 {
     generate_response_start(RSP_OK);
     char *response_data_buf = (char *)generate_response_data_ptr();
@@ -308,31 +639,46 @@ void generate_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t inst
     int8_t length;
     uint8_t value;
 
-    switch(node_type)
+    const uint8_t datatype = node->GetLeafSetDataType();
+    if (is_numeric_datatype(datatype))
+    {
+      numeric_value_type number;
+      if (read_numeric_value(node, parent_instance_id, number))
+      {
+        switch (datatype)
+        {
+        case LEAF_SET_DATATYPE_UINT8:
+          utoa((uint8_t)number.integer, response_data_buf, 10);
+          generate_response_data_addlen(strlen(response_data_buf));
+          break;
+        case LEAF_SET_DATATYPE_INT16:
+          itoa(number.integer, response_data_buf, 10);
+          generate_response_data_addlen(strlen(response_data_buf));
+          break;
+        case LEAF_SET_DATATYPE_BOOL:
+          generate_response_data_addbyte(number.integer ? '1' : '0');
+          break;
+        case LEAF_SET_DATATYPE_FLOAT:
+          dtostre(number.real, response_data_buf, 6, 0);
+          generate_response_data_addlen(strlen(response_data_buf));
+          break;
+        }
+      }
+      generate_response_send();
+      return;
+    }
+
+    switch (node->GetNodeType())
     {
     case NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_FRIENDLY_NAME:
       if ((length = NVConfigStore::GetDeviceName(PM_DEVICE_TYPE_SWITCH_INPUT, parent_instance_id, response_data_buf, response_data_buf_len)) > 0)
         generate_response_data_addlen(length);
       break;
-    case NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_PIN:
-      utoa(Device_InputSwitch::GetPin(parent_instance_id), response_data_buf, 10);
-      generate_response_data_addlen(strlen(response_data_buf));
-      break;
-    case NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_TRIGGER_LEVEL:
-      generate_response_data_addbyte(Device_InputSwitch::GetTriggerLevel(parent_instance_id) ? '1' : '0');
-      break;
-    case NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_ENABLE_PULLUP:
-      generate_response_data_addbyte(Device_InputSwitch::GetEnablePullup(parent_instance_id) ? '1' : '0');
-      break;
       
     case NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_FRIENDLY_NAME:
       if ((length = NVConfigStore::GetDeviceName(PM_DEVICE_TYPE_SWITCH_OUTPUT, instance_id, response_data_buf, response_data_buf_len)) > 0)
         generate_response_data_addlen(length);
       break;
-    case NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_PIN:
-      utoa(Device_OutputSwitch::GetPin(parent_instance_id), response_data_buf, 10);
-      generate_response_data_addlen(strlen(response_data_buf));
-      break;
     case NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_INITIAL_STATE:
       value = Device_OutputSwitch::GetInitialState(instance_id);
       strncpy_P(response_data_buf, stringify_initial_pin_state_value(value), response_data_buf_len);
@@ -343,53 +689,24 @@ void generate_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t inst
       if ((length = NVConfigStore::GetDeviceName(PM_DEVICE_TYPE_PWM_OUTPUT, instance_id, response_data_buf, response_data_buf_len)) > 0)
         generate_response_data_addlen(length);
       break;
-    case NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_PIN:
-      utoa(Device_PwmOutput::GetPin(parent_instance_id), response_data_buf, 10);
-      generate_response_data_addlen(strlen(response_data_buf));
-      break;
-    case NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_USE_SOFT_PWM:
-      generate_response_data_addbyte(Device_PwmOutput::GetSoftPwmState(parent_instance_id) ? '1' : '0');
-      break;
-      
       
     case NODE_TYPE_CONFIG_LEAF_BUZZER_FRIENDLY_NAME:
       if ((length = NVConfigStore::GetDeviceName(PM_DEVICE_TYPE_BUZZER, instance_id, response_data_buf, response_data_buf_len)) > 0)
         generate_response_data_addlen(length);
       break;
-    case NODE_TYPE_CONFIG_LEAF_BUZZER_PIN:
-      utoa(Device_Buzzer::GetPin(parent_instance_id), response_data_buf, 10);
-      generate_response_data_addlen(strlen(response_data_buf));
-      break;
       
     case NODE_TYPE_CONFIG_LEAF_HEATER_FRIENDLY_NAME:
       if ((length = NVConfigStore::GetDeviceName(PM_DEVICE_TYPE_HEATER, instance_id, response_data_buf, response_data_buf_len)) > 0)
         generate_response_data_addlen(length);
       break;
-    case NODE_TYPE_CONFIG_LEAF_HEATER_PIN:
-      utoa(Device_Heater::GetHeaterPin(parent_instance_id), response_data_buf, 10);
+    case NODE_TYPE_CONFIG_LEAF_HEATER_PID_AUTOTUNE_STATE:
+      strncpy_P(response_data_buf, 
+          stringify_pid_autotune_state(Device_Heater::GetPidAutotuneState(parent_instance_id)), 
+          response_data_buf_len);
       generate_response_data_addlen(strlen(response_data_buf));
       break;
-    case NODE_TYPE_CONFIG_LEAF_HEATER_USE_SOFT_PWM:
-      generate_response_data_addbyte(Device_Heater::GetSoftPwmState(parent_instance_id) ? '1' : '0');
-      break;
-    case NODE_TYPE_CONFIG_LEAF_HEATER_USE_BANG_BANG:
-      generate_response_data_addbyte(
-        (Device_Heater::GetControlMode(parent_instance_id) == HEATER_CONTROL_MODE_BANG_BANG) ? '1' : '0');
-      break;
-    case NODE_TYPE_CONFIG_LEAF_HEATER_USE_PID:
-      generate_response_data_addbyte(
-        (Device_Heater::GetControlMode(parent_instance_id) == HEATER_CONTROL_MODE_PID) ? '1' : '0');
-      break;
-    case NODE_TYPE_CONFIG_LEAF_HEATER_BANG_BANG_HYSTERESIS:
-      if (Device_Heater::GetControlMode(parent_instance_id) == HEATER_CONTROL_MODE_BANG_BANG)
-        generate_response_data_addbyte(Device_Heater::GetBangBangHysteresis(parent_instance_id));
-      break;
-    case NODE_TYPE_CONFIG_LEAF_HEATER_PID_FUNCTIONAL_RANGE:
-      if (Device_Heater::GetControlMode(parent_instance_id) == HEATER_CONTROL_MODE_PID)
-        generate_response_data_addbyte(Device_Heater::GetPidFunctionalRange(parent_instance_id));
-      break;
-    // TODO add other heater config
      
+    
     // Statistics Related
     case NODE_TYPE_STATS_LEAF_RX_PACKET_COUNT:
     {
@@ -437,8 +754,123 @@ void generate_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t inst
 }
 
  
-bool set_uint8_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, uint8_t value)
+bool is_numeric_datatype(uint8_t datatype)
+{
+  return datatype == LEAF_SET_DATATYPE_UINT8 || datatype == LEAF_SET_DATATYPE_INT16
+      || datatype == LEAF_SET_DATATYPE_BOOL || datatype == LEAF_SET_DATATYPE_FLOAT;
+}
+
+// Reads the value of a numeric leaf (returns false if the leaf currently has no value)
+bool read_numeric_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,
+    numeric_value_type &value)
+{
+  // values which can be read directly
+  const config_accessor_type getter = node->GetLeafGetter();
+  if (getter != 0)
+  {
+    switch (node->GetLeafSetDataType())
+    {
+    case LEAF_SET_DATATYPE_UINT8:
+      value.integer = ((config_UINT8_getter_type)getter)(parent_instance_id);
+      return true;
+    case LEAF_SET_DATATYPE_INT16:
+      value.integer = ((config_INT16_getter_type)getter)(parent_instance_id);
+      return true;
+    case LEAF_SET_DATATYPE_BOOL:
+      value.integer = ((config_BOOL_getter_type)getter)(parent_instance_id);
+      return true;
+    case LEAF_SET_DATATYPE_FLOAT:
+      value.real = ((config_FLOAT_getter_type)getter)(parent_instance_id);
+      return !isnan(value.real);
+    }
+    return false;
+  }
+
+  switch (node->GetNodeType())
+  {
+  case NODE_TYPE_CONFIG_LEAF_HEATER_USE_BANG_BANG:
+    value.integer = (Device_Heater::GetControlMode(parent_instance_id) == HEATER_CONTROL_MODE_BANG_BANG);
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_HEATER_USE_PID:
+    value.integer = (Device_Heater::GetControlMode(parent_instance_id) == HEATER_CONTROL_MODE_PID);
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_HEATER_BANG_BANG_HYSTERESIS:
+    if (Device_Heater::GetControlMode(parent_instance_id) != HEATER_CONTROL_MODE_BANG_BANG)
+      return false;
+    value.integer = Device_Heater::GetBangBangHysteresis(parent_instance_id);
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_HEATER_PID_FUNCTIONAL_RANGE:
+    if (Device_Heater::GetControlMode(parent_instance_id) != HEATER_CONTROL_MODE_PID)
+      return false;
+    value.integer = Device_Heater::GetPidFunctionalRange(parent_instance_id);
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_HEATER_PID_KP:
+  case NODE_TYPE_CONFIG_LEAF_HEATER_PID_KI:
+  case NODE_TYPE_CONFIG_LEAF_HEATER_PID_KD:
+    // the PID parameters only exist while the heater is in PID mode
+    if (Device_Heater::GetControlMode(parent_instance_id) != HEATER_CONTROL_MODE_PID)
+      return false;
+    if (node->GetNodeType() == NODE_TYPE_CONFIG_LEAF_HEATER_PID_KP)
+      value.real = Device_Heater::GetPidDefaultKp(parent_instance_id);
+    else if (node->GetNodeType() == NODE_TYPE_CONFIG_LEAF_HEATER_PID_KI)
+      value.real = Device_Heater::GetPidDefaultKi(parent_instance_id);
+    else
+      value.real = Device_Heater::GetPidDefaultKd(parent_instance_id);
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_HEATER_MAX_TEMP:
+    if (Device_Heater::GetMaxTemperature(parent_instance_id) == SENSOR_TEMPERATURE_INVALID)
+      return false;
+    value.integer = Device_Heater::GetMaxTemperature(parent_instance_id) >> TEMPERATURE_FRACTION_BITS;
+    return true;
+    
+  case NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_TYPE:
+    value.integer = (int8_t)Device_TemperatureSensor::GetType(parent_instance_id);
+    return true;
+    
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_INPUT_SWITCHES:
+    value.integer = Device_InputSwitch::GetNumDevices();
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_OUTPUT_SWITCHES:
+    value.integer = Device_OutputSwitch::GetNumDevices();
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_PWM_OUTPUTS:
+    value.integer = Device_PwmOutput::GetNumDevices();
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_BUZZERS:
+    value.integer = Device_Buzzer::GetNumDevices();
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_TEMP_SENSORS:
+    value.integer = Device_TemperatureSensor::GetNumDevices();
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_HEATERS:
+    value.integer = Device_Heater::GetNumDevices();
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_NUM_STEPPERS:
+    value.integer = Device_Stepper::GetNumDevices();
+    return true;
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_QUEUE_STATUS_TRAILER:
+  {
+    extern bool response_queue_status_trailer;
+    value.integer = response_queue_status_trailer;
+    return true;
+  }
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_HEATER_POWER_BUDGET:
+    value.integer = Device_Heater::GetPowerBudget();
+    return true;
+  // TODO add other heater config
+    
+  default:
+    return false;
+  }
+}
+
+bool set_uint8_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, uint8_t value)
 { 
+  const config_accessor_type setter = node->GetLeafSetter();
+  if (setter != 0)
+    return check_set_result(((config_UINT8_setter_type)setter)(parent_instance_id, value));
+
+  const uint8_t node_type = node->GetNodeType();
   uint8_t retval;
   switch (node_type)
   {
@@ -486,45 +918,29 @@ bool set_uint8_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t ins
     retval = Device_OutputSwitch::SetInitialState(parent_instance_id, value);
     break;
 
-  case NODE_TYPE_CONFIG_LEAF_HEATER_TEMP_SENSOR:
-    retval = Device_Heater::SetTempSensor(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_HEATER_POWER_ON_LEVEL:
-    retval = Device_Heater::SetPowerOnLevel(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_HEATER_BANG_BANG_HYSTERESIS:
-    retval = Device_Heater::SetBangBangHysteresis(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_HEATER_PID_FUNCTIONAL_RANGE:
-    retval = Device_Heater::SetPidFunctionalRange(parent_instance_id, value);
-    break;
-
   default: 
     send_app_error_response(PARAM_APP_ERROR_TYPE_FIRMWARE_ERROR,
          PMSG(MSG_ERR_CANNOT_HANDLE_FIRMWARE_CONFIG_REQUEST), __LINE__);
     return false;
   }
   
-  if (retval == APP_ERROR_TYPE_SUCCESS)
-    return true;
-  
-  generate_response_data_addbyte(retval);
-  generate_response_send();
-  return false;
+  return check_set_result(retval);
 }
 
-bool set_int16_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, int16_t value)
+bool set_int16_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, int16_t value)
 { 
-  uint8_t retval;
+  const config_accessor_type setter = node->GetLeafSetter();
+  if (setter != 0)
+    return check_set_result(((config_INT16_setter_type)setter)(parent_instance_id, value));
 
-  switch (node_type)
+  uint8_t retval;
+  switch (node->GetNodeType())
   {
   case NODE_TYPE_CONFIG_LEAF_HEATER_MAX_TEMP:
     retval = Device_Heater::SetMaxTemperature(parent_instance_id, value);
     break;
-
-  case NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_TYPE:
-    retval = Device_TemperatureSensor::SetType(parent_instance_id, value);
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_HEATER_POWER_BUDGET:
+    retval = Device_Heater::SetPowerBudget(value);
     break;
     
   default: 
@@ -533,34 +949,18 @@ bool set_int16_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t ins
     return false;
   }
   
-  if (retval == APP_ERROR_TYPE_SUCCESS)
-    return true;
-  
-  generate_response_data_addbyte(retval);
-  generate_response_send();
-  return false;
+  return check_set_result(retval);
 }
 
-bool set_bool_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, bool value)
+bool set_bool_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, bool value)
 { 
-  uint8_t retval;
+  const config_accessor_type setter = node->GetLeafSetter();
+  if (setter != 0)
+    return check_set_result(((config_BOOL_setter_type)setter)(parent_instance_id, value));
 
-  switch (node_type)
+  uint8_t retval;
+  switch (node->GetNodeType())
   {
-  case NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_TRIGGER_LEVEL:
-    retval = Device_InputSwitch::SetTriggerLevel(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_ENABLE_PULLUP:
-    retval = Device_InputSwitch::SetEnablePullup(parent_instance_id, value);
-    break;
-  
-  case NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_USE_SOFT_PWM:
-    retval = Device_PwmOutput::EnableSoftPwm(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_HEATER_USE_SOFT_PWM:
-    retval = Device_Heater::EnableSoftPwm(parent_instance_id, value);
-    break;
-
   case NODE_TYPE_CONFIG_LEAF_HEATER_USE_BANG_BANG:
     if (value)
       retval = Device_Heater::SetControlMode(parent_instance_id, HEATER_CONTROL_MODE_BANG_BANG);
@@ -573,16 +973,14 @@ bool set_bool_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t inst
     else
       retval = APP_ERROR_TYPE_SUCCESS;
     break;
-    
-  case NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_INVERT:
-    retval = Device_Stepper::SetEnableInvert(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_INVERT:
-    retval = Device_Stepper::SetDirectionInvert(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_INVERT:
-    retval = Device_Stepper::SetStepInvert(parent_instance_id, value);
+
+  case NODE_TYPE_CONFIG_LEAF_SYSTEM_QUEUE_STATUS_TRAILER:
+  {
+    extern bool response_queue_status_trailer;
+    response_queue_status_trailer = value;
+    retval = APP_ERROR_TYPE_SUCCESS;
     break;
+  }
 
   default: 
     send_app_error_response(PARAM_APP_ERROR_TYPE_FIRMWARE_ERROR,
@@ -590,21 +988,16 @@ bool set_bool_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t inst
     return false;
   }
   
-  if (retval == APP_ERROR_TYPE_SUCCESS)
-    return true;
-  
-  generate_response_data_addbyte(retval);
-  generate_response_send();
-  return false;
+  return check_set_result(retval);
 }
 
-bool set_string_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, const char *value)
+bool set_string_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, const char *value)
 { 
   uint8_t retval;
 
   generate_response_start(RSP_APPLICATION_ERROR, 1);
   
-  switch (node_type)
+  switch (node->GetNodeType())
   {
   case NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_FRIENDLY_NAME:
     retval = NVConfigStore::SetDeviceName(PM_DEVICE_TYPE_SWITCH_INPUT, parent_instance_id, value);
@@ -671,8 +1064,25 @@ bool set_string_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t in
                               PMSG(ERR_MSG_DEVICE_NOT_IN_USE));
       return false;
     }
-    send_OK_response(); // send response now as it takes a while to complete
-    Device_Heater::DoPidAutotune(parent_instance_id, temp, cycles);
+    if (temp < 0 || temp > MAX_TEMPERATURE_DEGREES 
+        || DEGREES_TO_TEMPERATURE(temp) > Device_Heater::GetMaxTemperature(parent_instance_id)
+        || cycles < 0 || cycles > 255)
+    {
+      send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE, 0);
+      return false;
+    }
+    if (is_stopped)
+    {
+      send_app_error_response(PARAM_APP_ERROR_TYPE_DEVICE_UNAVAILABLE,
+          PMSG(MSG_ERR_CANNOT_ACTIVATE_DEVICE_WHEN_STOPPED));
+      return false;
+    }
+    // the autotune runs in the background (see pid_autotune_state for progress)
+    retval = Device_Heater::StartPidAutotune(parent_instance_id, DEGREES_TO_TEMPERATURE(temp), cycles);
+    if (retval == APP_ERROR_TYPE_SUCCESS)
+      send_OK_response(); // an operation so not included in the configuration hash
+    else
+      check_set_result(retval);
     return false;
   }  
   case NODE_TYPE_OPERATION_LEAF_RESET_EEPROM:
@@ -685,36 +1095,24 @@ bool set_string_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t in
     return false;
   }
   
-  if (retval == APP_ERROR_TYPE_SUCCESS)
-    return true;
-  
-  generate_response_data_addbyte(retval);
-  generate_response_send();
-  return false;
+  return check_set_result(retval);
 }
 
-bool set_float_value(uint8_t node_type, uint8_t parent_instance_id,  uint8_t instance_id, float value)
+bool set_float_value(const ConfigurationTreeNode *node, uint8_t parent_instance_id,  uint8_t instance_id, float value)
 { 
-  uint8_t retval;
-
-  switch (node_type)
+  const config_accessor_type setter = node->GetLeafSetter();
+  if (setter == 0)
   {
-  case NODE_TYPE_CONFIG_LEAF_HEATER_PID_KP:
-    retval = Device_Heater::SetPidDefaultKp(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_HEATER_PID_KI:
-    retval = Device_Heater::SetPidDefaultKi(parent_instance_id, value);
-    break;
-  case NODE_TYPE_CONFIG_LEAF_HEATER_PID_KD:
-    retval = Device_Heater::SetPidDefaultKd(parent_instance_id, value);
-    break;
-
-  default: 
     send_app_error_response(PARAM_APP_ERROR_TYPE_FIRMWARE_ERROR,
          PMSG(MSG_ERR_CANNOT_HANDLE_FIRMWARE_CONFIG_REQUEST), __LINE__);
     return false;
   }
-  
+  return check_set_result(((config_FLOAT_setter_type)setter)(parent_instance_id, value));
+}
+
+// Returns true if the value was set, otherwise generates the error response
+bool check_set_result(uint8_t retval)
+{
   if (retval == APP_ERROR_TYPE_SUCCESS)
     return true;
   
@@ -780,6 +1178,247 @@ bool setPin(uint8_t node_type, uint8_t device_number, uint8_t pin)
   return false;
 }
 
+//
+// Device Configuration Snapshot
+//
+// The snapshot is a sequence of records which each start with a configuration
+// handle (i.e., leaf node type and device number) followed by the binary value of 
+// the leaf (string values are preceded by their length). Axis settings which are 
+// configured by orders rather than configuration values use an axis record instead.
+//
+#define CONFIG_SNAPSHOT_AXIS_RECORD           0xFF
+#define CONFIG_SNAPSHOT_AXIS_RECORD_LENGTH    (2 + 2 + 2 + 4 + 2 * sizeof(BITMASK(MAX_ENDSTOPS)))
+#define CONFIG_SNAPSHOT_MAX_STRING_LENGTH     15
+
+static uint8_t *store_snapshot_number(uint8_t *ptr, uint32_t value, uint8_t length)
+{
+  while (length-- > 0)
+    *ptr++ = value >> (8 * length);
+  return ptr;
+}
+
+static uint32_t load_snapshot_number(const uint8_t *&ptr, uint8_t length)
+{
+  uint32_t value = 0;
+  while (length-- > 0)
+    value = (value << 8) | *ptr++;
+  return value;
+}
+
+static bool append_snapshot_data(const uint8_t *data, uint8_t length, bool write,
+    uint16_t &snapshot_length, uint16_t &hash)
+{
+  if (snapshot_length + length > NVConfigStore::GetConfigSnapshotCapacity())
+    return false;
+  if (write)
+    NVConfigStore::WriteConfigSnapshot(snapshot_length, data, length);
+  hash = crc16_continue((uint8_t *)data, length, hash);
+  snapshot_length += length;
+  return true;
+}
+
+// Returns true if a leaf value is an unassigned pin or device (not restorable)
+static bool is_unassigned_value(uint8_t node_type, const uint8_t *value, uint8_t value_length)
+{
+  if (value_length != 1 || value[0] != 0xFF)
+    return false;
+  switch (node_type)
+  {
+  case NODE_TYPE_CONFIG_LEAF_INPUT_SWITCH_PIN:
+  case NODE_TYPE_CONFIG_LEAF_OUTPUT_SWITCH_PIN:
+  case NODE_TYPE_CONFIG_LEAF_PWM_OUTPUT_PIN:
+  case NODE_TYPE_CONFIG_LEAF_BUZZER_PIN:
+  case NODE_TYPE_CONFIG_LEAF_TEMP_SENSOR_PIN:
+  case NODE_TYPE_CONFIG_LEAF_HEATER_PIN:
+  case NODE_TYPE_CONFIG_LEAF_HEATER_TEMP_SENSOR:
+  case NODE_TYPE_CONFIG_LEAF_STEPPER_ENABLE_PIN:
+  case NODE_TYPE_CONFIG_LEAF_STEPPER_DIRECTION_PIN:
+  case NODE_TYPE_CONFIG_LEAF_STEPPER_STEP_PIN:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Generates the snapshot of the current device configuration (only writing it to
+// EEPROM if write is set) and returns its length, or 0 if it does not fit.
+static uint16_t generate_configuration_snapshot(bool write, uint16_t &hash)
+{
+  extern bool response_squelch;
+  extern uint8_t reply_frame[];
+  extern uint8_t * const reply_buf;
+  extern uint8_t reply_data_len;
+  ConfigurationTree tree;
+  uint8_t record[CONFIG_SNAPSHOT_AXIS_RECORD_LENGTH];
+  uint16_t length = 0;
+  
+  hash = 0xFFFF;
+  
+  ConfigurationTreeNode *node = tree.FindFirstLeafNode(tree.GetRootNode());
+  for (; node != 0; node = tree.FindNextLeafNode(tree.GetRootNode()))
+  {
+    if (node->GetLeafClass() != FIRMWARE_CONFIG_TYPE_VOLATILE_CONFIG
+        || (node->GetLeafOperations() & LEAF_OPERATIONS_READWRITEABLE) != LEAF_OPERATIONS_READWRITEABLE)
+      continue;
+      
+    record[0] = node->GetNodeType();
+    record[1] = tree.GetParentNode(node)->GetInstanceId();
+    
+    response_squelch = true;
+    handle_firmware_configuration_read_by_handle(record[0], record[1]);
+    response_squelch = false;
+    if (reply_frame[PM_ORDER_BYTE_OFFSET] != RSP_OK || reply_data_len == 0
+        || is_unassigned_value(record[0], reply_buf, reply_data_len))
+      continue;
+      
+    uint8_t header_length = 2;
+    if (node->GetLeafSetDataType() == LEAF_SET_DATATYPE_STRING)
+    {
+      if (reply_data_len > CONFIG_SNAPSHOT_MAX_STRING_LENGTH)
+        continue;
+      record[header_length++] = reply_data_len;
+    }
+    if (!append_snapshot_data(record, header_length, write, length, hash)
+        || !append_snapshot_data(reply_buf, reply_data_len, write, length, hash))
+      return 0;
+  }
+
+  for (uint8_t i = 0; i < AxisInfo::GetNumAxes(); i++)
+  {
+    if (!AxisInfo::IsInUse(i))
+      continue;
+    uint8_t *ptr = record;
+    *ptr++ = CONFIG_SNAPSHOT_AXIS_RECORD;
+    *ptr++ = i;
+    ptr = store_snapshot_number(ptr, AxisInfo::GetAxisMaxRate(i), 2);
+    ptr = store_snapshot_number(ptr, AxisInfo::GetUnderrunRate(i), 2);
+    ptr = store_snapshot_number(ptr, AxisInfo::GetUnderrunAccelRate(i), 4);
+    ptr = store_snapshot_number(ptr, AxisInfo::GetAxisMinEndstops(i), sizeof(BITMASK(MAX_ENDSTOPS)));
+    ptr = store_snapshot_number(ptr, AxisInfo::GetAxisMaxEndstops(i), sizeof(BITMASK(MAX_ENDSTOPS)));
+    if (!append_snapshot_data(record, sizeof(record), write, length, hash))
+      return 0;
+  }
+  return length;
+}
+
+static void save_configuration_snapshot()
+{
+  uint16_t hash;
+  uint16_t length = generate_configuration_snapshot(false, hash);
+  
+  if (length != NVConfigStore::GetConfigSnapshotLength() 
+      || hash != NVConfigStore::GetConfigSnapshotHash())
+  {
+    // invalidate the old snapshot while the new one is being written
+    NVConfigStore::CommitConfigSnapshot(0, 0);
+    if (length == 0)
+      return; 
+    generate_configuration_snapshot(true, hash);
+    NVConfigStore::CommitConfigSnapshot(length, hash);
+  }
+  
+  // the restored configuration has the same hash as the original configuration
+  NVConfigStore::SetConfigHash(firmware_configuration_hash);
+}
+
+// Restores the device configuration snapshot held in EEPROM (returns false if 
+// there is no valid snapshot)
+bool restore_configuration_snapshot()
+{
+  extern bool response_squelch;
+  extern uint8_t reply_frame[];
+  ConfigurationTree tree;
+  uint8_t buffer[max(CONFIG_SNAPSHOT_AXIS_RECORD_LENGTH, CONFIG_SNAPSHOT_MAX_STRING_LENGTH + 1)];
+  const uint16_t length = NVConfigStore::GetConfigSnapshotLength();
+  uint16_t offset;
+  
+  if (length == 0)
+    return false;
+    
+  // verify the whole snapshot before applying any of it
+  uint16_t hash = 0xFFFF;
+  for (offset = 0; offset < length; offset += sizeof(buffer))
+  {
+    const uint8_t chunk_length = min(length - offset, sizeof(buffer));
+    NVConfigStore::ReadConfigSnapshot(offset, buffer, chunk_length);
+    hash = crc16_continue(buffer, chunk_length, hash);
+  }
+  if (hash != NVConfigStore::GetConfigSnapshotHash())
+    return false;
+
+  DEBUGLNPGM("Restoring configuration snapshot");
+  
+  bool all_applied = true;
+  response_squelch = true;
+  offset = 0;
+  while (offset + 2 <= length)
+  {
+    NVConfigStore::ReadConfigSnapshot(offset, buffer, 2);
+    offset += 2;
+    const uint8_t node_type = buffer[0];
+    const uint8_t device_number = buffer[1];
+    
+    if (node_type == CONFIG_SNAPSHOT_AXIS_RECORD)
+    {
+      if (offset + CONFIG_SNAPSHOT_AXIS_RECORD_LENGTH - 2 > length)
+        break;
+      NVConfigStore::ReadConfigSnapshot(offset, buffer, CONFIG_SNAPSHOT_AXIS_RECORD_LENGTH - 2);
+      offset += CONFIG_SNAPSHOT_AXIS_RECORD_LENGTH - 2;
+      
+      const uint8_t *ptr = buffer;
+      uint8_t retval = AxisInfo::SetAxisMaxRate(device_number, load_snapshot_number(ptr, 2));
+      retval |= AxisInfo::SetUnderrunRate(device_number, load_snapshot_number(ptr, 2));
+      retval |= AxisInfo::SetUnderrunAccelRate(device_number, load_snapshot_number(ptr, 4));
+      const uint32_t min_endstops = load_snapshot_number(ptr, sizeof(BITMASK(MAX_ENDSTOPS)));
+      const uint32_t max_endstops = load_snapshot_number(ptr, sizeof(BITMASK(MAX_ENDSTOPS)));
+      retval |= AxisInfo::ClearEndstops(device_number);
+      for (uint8_t i = 0; i < MAX_ENDSTOPS; i++)
+      {
+        if ((min_endstops & (1UL << i)) != 0)
+          retval |= AxisInfo::SetMinEndstopDevice(device_number, i);
+        if ((max_endstops & (1UL << i)) != 0)
+          retval |= AxisInfo::SetMaxEndstopDevice(device_number, i);
+      }
+      if (retval != APP_ERROR_TYPE_SUCCESS)
+        all_applied = false;
+      continue;
+    }
+    
+    ConfigurationTreeNode *node = tree.FindLeafNode(node_type);
+    if (node == 0)
+      break;
+    uint8_t value_length = get_binary_value_length(node->GetLeafSetDataType());
+    if (node->GetLeafSetDataType() == LEAF_SET_DATATYPE_STRING)
+    {
+      NVConfigStore::ReadConfigSnapshot(offset++, &value_length, 1);
+      if (value_length > CONFIG_SNAPSHOT_MAX_STRING_LENGTH)
+        break;
+    }
+    if (value_length == 0 || offset + value_length > length)
+      break;
+    NVConfigStore::ReadConfigSnapshot(offset, buffer, value_length);
+    offset += value_length;
+    buffer[value_length] = '\0';
+    
+    // values which can no longer be applied are skipped (but the restore is incomplete)
+    handle_firmware_configuration_write_by_handle(node_type, device_number, buffer, value_length);
+    if (reply_frame[PM_ORDER_BYTE_OFFSET] != RSP_OK)
+      all_applied = false;
+  }
+  response_squelch = false;
+  
+  update_firmware_configuration(false);
+  if (offset != length || !all_applied)
+  {
+    // the configuration only partly matches the snapshot so make sure the
+    // host cannot mistake it for the stored configuration
+    firmware_configuration_hash = ~NVConfigStore::GetConfigHash();
+    return false;
+  }
+  firmware_configuration_hash = NVConfigStore::GetConfigHash();
+  return true;
+}
+
 void update_firmware_configuration(bool final)
 {
   uint8_t i;
@@ -798,6 +1437,9 @@ void update_firmware_configuration(bool final)
   {
     // remove from the EEPROM settings any pins which have not been used anymore
     cleanup_initial_pin_state();
+    
+    // allow the configuration to be restored at the next reset without the host
+    save_configuration_snapshot();
   }
 }
 
@@ -818,10 +1460,24 @@ void apply_initial_configuration()
 #endif  
 }
 
+// Applies a configuration value without sending a response 
+// (returns false if the value could not be applied)
+bool apply_firmware_configuration_value(const char *name, const char *value)
+{
+  extern bool response_squelch;
+  extern uint8_t reply_frame[];
+
+  response_squelch = true;
+  handle_firmware_configuration_request(name, value);
+  response_squelch = false;
+  return (reply_frame[PM_ORDER_BYTE_OFFSET] == RSP_OK);
+}
+
 void apply_firmware_configuration_string_P(const char *pstr)
 {
   extern uint16_t recv_buf_len;
-  extern uint8_t recv_buf[MAX_RECV_BUF_LEN];
+  extern uint8_t *recv_buf;
+  extern uint16_t recv_buf_size;
 
   // Note: this function overwrites recv_buf contents so it is primarily intended for 
   // development & boot time usage
@@ -830,7 +1486,7 @@ void apply_firmware_configuration_string_P(const char *pstr)
 
   // copy next command into recv_buf
   // (we use one less than the size so that the last byte of recv_buf buffer always remains zero)
-  strncpy_P(buf_start, pstr, sizeof(recv_buf) - PM_PARAMETER_OFFSET - 1); 
+  strncpy_P(buf_start, pstr, recv_buf_size - PM_PARAMETER_OFFSET - 1); 
   
   const char *value = 0;
   char *ptr = buf_start;
@@ -866,13 +1522,13 @@ void apply_firmware_configuration_string_P(const char *pstr)
   DEBUGPGM(" ... ");
 
   extern bool response_squelch;
-  extern uint8_t reply_header[PM_HEADER_SIZE];
-  extern uint8_t reply_buf[MAX_RESPONSE_PARAM_LENGTH];
+  extern uint8_t reply_frame[];
+  extern uint8_t * const reply_buf;
   extern uint8_t reply_msg_len;
 
   response_squelch = true;
   handle_firmware_configuration_request(buf_start, value);
-  if (reply_header[PM_ORDER_BYTE_OFFSET] == RSP_OK)
+  if (reply_frame[PM_ORDER_BYTE_OFFSET] == RSP_OK)
   {
     DEBUGLNPGM("ok"); 
   }
@@ -906,3 +1562,20 @@ bool read_number(long &number, const char *value)
     return false;
   return true;
 }
+
+const char *stringify_pid_autotune_state(uint8_t state)
+{
+  switch (state)
+  {
+  case HEATER_AUTOTUNE_STATE_RUNNING:
+    return PSTR(CONFIG_STR(AUTOTUNE_RUNNING));
+  case HEATER_AUTOTUNE_STATE_DONE:
+    return PSTR(CONFIG_STR(AUTOTUNE_DONE));
+  case HEATER_AUTOTUNE_STATE_FAILED:
+    return PSTR(CONFIG_STR(AUTOTUNE_FAILED));
+  case HEATER_AUTOTUNE_STATE_ABORTED:
+    return PSTR(CONFIG_STR(AUTOTUNE_ABORTED));
+  default:
+    return PSTR(CONFIG_STR(AUTOTUNE_IDLE));
+  }
+}
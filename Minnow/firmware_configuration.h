@@ -27,9 +27,16 @@
 #include <stdint.h>
 
 void handle_firmware_configuration_request(const char *name, const char *value);
+bool apply_firmware_configuration_value(const char *name, const char *value);
 void handle_firmware_configuration_traversal(const char *name);
+void handle_firmware_configuration_traversal_page(uint8_t flags, const uint8_t *cursor, uint16_t cursor_length);
 void handle_firmware_configuration_value_properties(const char *name);
 
+void handle_firmware_configuration_handle_request(const char *name);
+void handle_firmware_configuration_read_by_handle(uint8_t node_type, uint8_t device_number);
+void handle_firmware_configuration_write_by_handle(uint8_t node_type, uint8_t device_number, 
+    const uint8_t *value, uint16_t value_length);
+
 
 void apply_initial_configuration();
 
@@ -37,5 +44,10 @@ void apply_firmware_configuration_string_P(const char *str);
 
 void update_firmware_configuration(bool final);
 
+bool restore_configuration_snapshot();
+
+extern uint16_t firmware_configuration_hash;
+void update_firmware_configuration_hash(const uint8_t *data, uint16_t length);
+
 
 #endif
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+#
+# Minnow Pacemaker client firmware.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+#
+# Generates thermistortables_indexed.h from the thermistor tables in thermistortables.h
+#
+# Each table is converted to a list of segments (raw value, temperature, fixed-point slope)
+# plus a uniform index which maps (raw value >> THERMISTOR_INDEX_SHIFT) to the segment
+# containing the start of that raw range. A conversion is then an index lookup, a short
+# forward walk (at most a few segments) and one multiply-add - no search and no division.
+#
+# Re-run this script after changing a table, OVERSAMPLENR or THERMISTOR_INDEX_SHIFT:
+#
+#   python3 generate_thermistor_tables.py
+#
+
+import os
+import re
+
+OVERSAMPLENR = 16
+RAW_RANGE = 1024 * OVERSAMPLENR
+SLOPE_FRACTION_BITS = 16
+
+here = os.path.dirname(os.path.abspath(__file__))
+source = open(os.path.join(here, 'thermistortables.h')).read()
+
+index_shift = int(re.search(r'#define THERMISTOR_INDEX_SHIFT\s+(\d+)', source).group(1))
+
+tables = []
+for match in re.finditer(r'const int16_t temptable_(\d+)\[\]\[2\] PROGMEM = \{(.*?)\};', source, re.S):
+  rows = re.findall(r'\{\s*(\d+)\s*\*\s*OVERSAMPLENR\s*,\s*(-?\d+)\s*\}', match.group(2))
+  tables.append((int(match.group(1)), [(int(raw) * OVERSAMPLENR, int(temp)) for raw, temp in rows]))
+
+def segment_for_raw(rows, raw):
+  # same segment selection as a linear scan: the last row whose raw value is <= raw
+  # (raw values before the first row extrapolate the first segment)
+  segment = 0
+  for i in range(1, len(rows)):
+    if rows[i][0] <= raw:
+      segment = i
+  return segment
+
+def round_div(a, b):
+  q, r = divmod(abs(a), abs(b))
+  if 2 * r >= abs(b):
+    q += 1
+  return q if (a < 0) == (b < 0) else -q
+
+out = []
+out.append('''/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Generated by generate_thermistor_tables.py from thermistortables.h - do not edit.
+
+#ifndef THERMISTORTABLES_INDEXED_H_
+#define THERMISTORTABLES_INDEXED_H_
+
+#if OVERSAMPLENR != %d || THERMISTOR_INDEX_SHIFT != %d
+  #error thermistortables_indexed.h is out of date, re-run generate_thermistor_tables.py
+#endif
+''' % (OVERSAMPLENR, index_shift))
+
+for number, rows in tables:
+  segments = []
+  for i, (raw, temp) in enumerate(rows):
+    if i + 1 < len(rows) and rows[i + 1][0] != raw:
+      slope = round_div((rows[i + 1][1] - temp) << SLOPE_FRACTION_BITS, rows[i + 1][0] - raw)
+    else:
+      slope = 0 # last row (or zero-length segment which is never selected)
+    segments.append((raw, temp, slope))
+  index = [segment_for_raw(rows, cell << index_shift) for cell in range(RAW_RANGE >> index_shift)]
+  assert len(rows) <= 256
+
+  out.append('#if ENABLE_THERMISTOR_TYPE_%d' % number)
+  out.append('const ThermistorSegment thermistor_segments_%d[] PROGMEM = {' % number)
+  for raw, temp, slope in segments:
+    out.append('  { %5d, %4d, %8d },' % (raw, temp, slope))
+  out.append('};')
+  out.append('const uint8_t thermistor_index_%d[] PROGMEM = {' % number)
+  for i in range(0, len(index), 16):
+    out.append('  ' + ', '.join('%3d' % v for v in index[i:i + 16]) + ',')
+  out.append('};')
+  out.append('#endif //ENABLE_THERMISTOR_TYPE_%d' % number)
+  out.append('')
+
+out.append('#endif //THERMISTORTABLES_INDEXED_H_')
+
+open(os.path.join(here, 'thermistortables_indexed.h'), 'w').write('\n'.join(out) + '\n')
@@ -119,6 +119,9 @@
 #define ERR_MSG_CONFIG_NODE_NOT_READABLE_ENGLISH "Firmware configuration value is not a readable element"
 #define ERR_MSG_CONFIG_NODE_NOT_READABLE_DEUTSCH "Firmware Konfigurations Wert kann nicht gelesen werden."
 
+#define ERR_MSG_INVALID_CONFIG_HANDLE_ENGLISH "Invalid firmware configuration handle"
+#define ERR_MSG_INVALID_CONFIG_HANDLE_DEUTSCH "Ungültiger Konfigurations Handle"
+
 #define ERR_MSG_QUEUE_ORDER_NOT_PERMITTED_ENGLISH "Order not permitted for queuing: "
 #define ERR_MSG_QUEUE_ORDER_NOT_PERMITTED_DEUTSCH "Befehl kann nicht in die Warteschlange aufgenommen werden: "
 
@@ -140,6 +143,9 @@
 #define MSG_ERR_NOT_SUPPORTED_ENGLISH "Not supported"
 #define MSG_ERR_NOT_SUPPORTED_DEUTSCH MSG_ERR_NOT_SUPPORTED_ENGLISH
 
+#define MSG_ERR_TOO_MANY_DEVICES_ENGLISH "Too many devices for one response"
+#define MSG_ERR_TOO_MANY_DEVICES_DEUTSCH MSG_ERR_TOO_MANY_DEVICES_ENGLISH
+
 //
 // Other strings
 //
@@ -166,6 +172,7 @@ PMSG_VARIABLE(ERR_MSG_EXPECTED_BOOL_VALUE);
 PMSG_VARIABLE(ERR_MSG_EXPECTED_FLOAT_VALUE);
 PMSG_VARIABLE(ERR_MSG_CONFIG_NODE_NOT_WRITEABLE);
 PMSG_VARIABLE(ERR_MSG_CONFIG_NODE_NOT_READABLE);
+PMSG_VARIABLE(ERR_MSG_INVALID_CONFIG_HANDLE);
 PMSG_VARIABLE(ERR_MSG_QUEUE_ORDER_NOT_PERMITTED);
 PMSG_VARIABLE(MSG_ERR_UNKNOWN_VALUE);
 PMSG_VARIABLE(MSG_ERR_ALREADY_INITIALIZED);
@@ -173,6 +180,7 @@ PMSG_VARIABLE(MSG_ERR_INSUFFICIENT_MEMORY);
 PMSG_VARIABLE(ERR_MSG_BAD_PID_AUTOTUNE_FORMAT);
 PMSG_VARIABLE(MSG_ERR_CANNOT_ACTIVATE_DEVICE_WHEN_STOPPED);
 PMSG_VARIABLE(MSG_ERR_NOT_SUPPORTED);
+PMSG_VARIABLE(MSG_ERR_TOO_MANY_DEVICES);
 
 PMSG_VARIABLE(MSG_EXPECTING);
 
@@ -330,9 +338,54 @@ PMSG_VARIABLE(MSG_EXPECTING);
 #define CONFIG_STR_STEP_INVERT_ENGLISH            "step_invert"
 #define CONFIG_STR_STEP_INVERT_DEUTSCH            CONFIG_STR_STEP_INVERT_ENGLISH
 
+#define CONFIG_STR_OVERSAMPLING_ENGLISH           "oversampling"
+#define CONFIG_STR_OVERSAMPLING_DEUTSCH           CONFIG_STR_OVERSAMPLING_ENGLISH
+#define CONFIG_STR_FILTER_MEDIAN_ENGLISH          "filter_median"
+#define CONFIG_STR_FILTER_MEDIAN_DEUTSCH          CONFIG_STR_FILTER_MEDIAN_ENGLISH
+#define CONFIG_STR_FILTER_TIME_CONSTANT_ENGLISH   "filter_time_constant"
+#define CONFIG_STR_FILTER_TIME_CONSTANT_DEUTSCH   CONFIG_STR_FILTER_TIME_CONSTANT_ENGLISH
+#define CONFIG_STR_THERMISTOR_BETA_ENGLISH       "thermistor_beta"
+#define CONFIG_STR_THERMISTOR_BETA_DEUTSCH       CONFIG_STR_THERMISTOR_BETA_ENGLISH
+#define CONFIG_STR_THERMISTOR_R25_ENGLISH        "thermistor_r25"
+#define CONFIG_STR_THERMISTOR_R25_DEUTSCH        CONFIG_STR_THERMISTOR_R25_ENGLISH
+#define CONFIG_STR_THERMISTOR_SH_A_ENGLISH       "thermistor_sh_a"
+#define CONFIG_STR_THERMISTOR_SH_A_DEUTSCH       CONFIG_STR_THERMISTOR_SH_A_ENGLISH
+#define CONFIG_STR_THERMISTOR_SH_B_ENGLISH       "thermistor_sh_b"
+#define CONFIG_STR_THERMISTOR_SH_B_DEUTSCH       CONFIG_STR_THERMISTOR_SH_B_ENGLISH
+#define CONFIG_STR_THERMISTOR_SH_C_ENGLISH       "thermistor_sh_c"
+#define CONFIG_STR_THERMISTOR_SH_C_DEUTSCH       CONFIG_STR_THERMISTOR_SH_C_ENGLISH
+#define CONFIG_STR_PULLUP_RESISTANCE_ENGLISH     "pullup_resistance"
+#define CONFIG_STR_PULLUP_RESISTANCE_DEUTSCH     CONFIG_STR_PULLUP_RESISTANCE_ENGLISH
+#define CONFIG_STR_SERIES_RESISTANCE_ENGLISH     "series_resistance"
+#define CONFIG_STR_SERIES_RESISTANCE_DEUTSCH     CONFIG_STR_SERIES_RESISTANCE_ENGLISH
+#define CONFIG_STR_RUNAWAY_PERIOD_ENGLISH        "runaway_period"
+#define CONFIG_STR_RUNAWAY_PERIOD_DEUTSCH        CONFIG_STR_RUNAWAY_PERIOD_ENGLISH
+#define CONFIG_STR_RUNAWAY_RISE_ENGLISH          "runaway_rise"
+#define CONFIG_STR_RUNAWAY_RISE_DEUTSCH          CONFIG_STR_RUNAWAY_RISE_ENGLISH
+#define CONFIG_STR_RUNAWAY_DEVIATION_ENGLISH     "runaway_deviation"
+#define CONFIG_STR_RUNAWAY_DEVIATION_DEUTSCH     CONFIG_STR_RUNAWAY_DEVIATION_ENGLISH
+#define CONFIG_STR_PID_AUTOTUNE_STATE_ENGLISH    "pid_autotune_state"
+#define CONFIG_STR_PID_AUTOTUNE_STATE_DEUTSCH    CONFIG_STR_PID_AUTOTUNE_STATE_ENGLISH
+#define CONFIG_STR_PID_AUTOTUNE_CYCLE_ENGLISH    "pid_autotune_cycle"
+#define CONFIG_STR_PID_AUTOTUNE_CYCLE_DEUTSCH    CONFIG_STR_PID_AUTOTUNE_CYCLE_ENGLISH
+#define CONFIG_STR_PID_AUTOTUNE_KP_ENGLISH       "pid_autotune_kp"
+#define CONFIG_STR_PID_AUTOTUNE_KP_DEUTSCH       CONFIG_STR_PID_AUTOTUNE_KP_ENGLISH
+#define CONFIG_STR_PID_AUTOTUNE_KI_ENGLISH       "pid_autotune_ki"
+#define CONFIG_STR_PID_AUTOTUNE_KI_DEUTSCH       CONFIG_STR_PID_AUTOTUNE_KI_ENGLISH
+#define CONFIG_STR_PID_AUTOTUNE_KD_ENGLISH       "pid_autotune_kd"
+#define CONFIG_STR_PID_AUTOTUNE_KD_DEUTSCH       CONFIG_STR_PID_AUTOTUNE_KD_ENGLISH
+#define CONFIG_STR_POWER_PRIORITY_ENGLISH        "power_priority"
+#define CONFIG_STR_POWER_PRIORITY_DEUTSCH        CONFIG_STR_POWER_PRIORITY_ENGLISH
+
 #define CONFIG_STR_RESET_EEPROM_ENGLISH           "reset_eeprom"
 #define CONFIG_STR_RESET_EEPROM_DEUTSCH           CONFIG_STR_RESET_EEPROM_ENGLISH
 
+#define CONFIG_STR_QUEUE_STATUS_TRAILER_ENGLISH   "queue_status_trailer"
+#define CONFIG_STR_QUEUE_STATUS_TRAILER_DEUTSCH   CONFIG_STR_QUEUE_STATUS_TRAILER_ENGLISH
+
+#define CONFIG_STR_HEATER_POWER_BUDGET_ENGLISH    "heater_power_budget"
+#define CONFIG_STR_HEATER_POWER_BUDGET_DEUTSCH    CONFIG_STR_HEATER_POWER_BUDGET_ENGLISH
+
 #define CONFIG_STR_INITIAL_STATE_ENGLISH          "initial_state"
 #define CONFIG_STR_INITIAL_STATE_DEUTSCH          CONFIG_STR_INITIAL_STATE_ENGLISH
 
@@ -356,4 +409,19 @@ PMSG_VARIABLE(MSG_EXPECTING);
 #define CONFIG_STR_PULLUP_ENGLISH                 "pullup"
 #define CONFIG_STR_PULLUP_DEUTSCH                 CONFIG_STR_PULLUP_ENGLISH
 
+#define CONFIG_STR_AUTOTUNE_IDLE_ENGLISH          "idle"
+#define CONFIG_STR_AUTOTUNE_IDLE_DEUTSCH          CONFIG_STR_AUTOTUNE_IDLE_ENGLISH
+
+#define CONFIG_STR_AUTOTUNE_RUNNING_ENGLISH       "running"
+#define CONFIG_STR_AUTOTUNE_RUNNING_DEUTSCH       CONFIG_STR_AUTOTUNE_RUNNING_ENGLISH
+
+#define CONFIG_STR_AUTOTUNE_DONE_ENGLISH          "done"
+#define CONFIG_STR_AUTOTUNE_DONE_DEUTSCH          CONFIG_STR_AUTOTUNE_DONE_ENGLISH
+
+#define CONFIG_STR_AUTOTUNE_FAILED_ENGLISH        "failed"
+#define CONFIG_STR_AUTOTUNE_FAILED_DEUTSCH        CONFIG_STR_AUTOTUNE_FAILED_ENGLISH
+
+#define CONFIG_STR_AUTOTUNE_ABORTED_ENGLISH       "aborted"
+#define CONFIG_STR_AUTOTUNE_ABORTED_DEUTSCH       CONFIG_STR_AUTOTUNE_ABORTED_ENGLISH
+
 #endif // ifndef LANGUAGE_H
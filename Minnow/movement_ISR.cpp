@@ -98,6 +98,7 @@
 #include "Device_PwmOutput.h"
 #include "Device_Buzzer.h"
 #include "Device_Heater.h"
+#include "events.h"
 
 #include "speed_lookuptable.h"
 
@@ -122,6 +123,7 @@ extern uint16_t last_enqueued_final_speed;
 
 bool come_to_stop_and_flush_queue;
 bool is_checkpoint_last; // is last movement command in queue a checkpoint?
+bool is_checkpoint_reported; // has the checkpoint reached event been raised?
 
 // Function declarations
 FORCE_INLINE void movement_ISR(); // needs to be non-static due to friend usage elsewhere
@@ -311,7 +313,8 @@ do_handle_queue_command:
         #endif
         return;
       }
-      CommandQueue::current_queue_command_count -= 1;
+      if (--CommandQueue::current_queue_command_count == EVENT_QUEUE_LOW_WATER_LEVEL)
+        raise_event(PARAM_EVENT_TYPE_QUEUE_LOW_WATER, EVENT_QUEUE_LOW_WATER_LEVEL);
       CommandQueue::queue_head += CommandQueue::in_progress_length + 1;
       //  in_progress_length will be updated later
     }
@@ -345,6 +348,11 @@ do_handle_queue_command:
         if (CommandQueue::current_queue_command_count != 0)
           ERRORLNPGM("queue count wrong 1");
   #endif      
+        if (is_checkpoint_last && !is_checkpoint_reported)
+        {
+          raise_event(PARAM_EVENT_TYPE_CHECKPOINT_REACHED, 0);
+          is_checkpoint_reported = true;
+        }
       }
       CommandQueue::current_queue_command_count = 0;
       OCR1A = IDLE_INTERRUPT_RATE; 
@@ -840,7 +848,7 @@ FORCE_INLINE bool check_endstops()
       else
       {
         // stop system
-        // TODO generate error message indicating the endstop
+        raise_event(PARAM_EVENT_TYPE_ENDSTOP_HIT, index);
         emergency_stop(PARAM_STOPPED_CAUSE_ENDSTOP_HIT);
         dump_movement_queue();
         return false;
@@ -27,6 +27,7 @@
 #include "protocol.h"
 #include "response.h"
 #include "firmware_configuration.h"
+#include "temperature_history.h"
 
 #include "Device_InputSwitch.h"
 #include "Device_OutputSwitch.h"
@@ -45,6 +46,7 @@
 //===========================================================================
 
 extern uint16_t total_executed_queued_command_count;
+extern uint16_t recv_buf_size;
 
 //===========================================================================
 //=============================private variables=============================
@@ -78,12 +80,16 @@ FORCE_INLINE static void handle_set_output_switch_state_order();
 FORCE_INLINE static void handle_set_pwm_output_state_order();
 FORCE_INLINE static void handle_set_output_tone_order();
 FORCE_INLINE static void handle_write_firmware_configuration_value_order();
+FORCE_INLINE static void handle_write_firmware_configuration_values_order();
+FORCE_INLINE static void handle_firmware_configuration_by_handle_order();
 FORCE_INLINE static void handle_activate_stepper_control_order();
 FORCE_INLINE static void handle_enable_disable_steppers_order();
 FORCE_INLINE static void handle_configure_endstops_order();
 FORCE_INLINE static void handle_enable_disable_endstops_order();
 FORCE_INLINE static void handle_configure_axis_movement_rates_order();
 FORCE_INLINE static void handle_configure_underrun_params_order();
+
+FORCE_INLINE static void update_configuration_order_hash();
 FORCE_INLINE static void handle_clear_command_queue_order();
 
 //
@@ -123,7 +129,9 @@ void process_command()
       update_firmware_configuration(true);
     }
     else if (firmware_configuration_change_made
-        && order_code != ORDER_WRITE_FIRMWARE_CONFIG_VALUE)
+        && order_code != ORDER_WRITE_FIRMWARE_CONFIG_VALUE
+        && order_code != ORDER_WRITE_FIRMWARE_CONFIG_VALUES
+        && order_code != ORDER_WRITE_FIRMWARE_CONFIG_BY_HANDLE)
     {
       // update individual device states once firmware configuration
       // block is done
@@ -136,6 +144,7 @@ void process_command()
   {
   case ORDER_RESET:
     emergency_stop(PARAM_STOPPED_CAUSE_USER_REQUEST);
+    NVConfigStore::Flush();
     die();
     break;
   case ORDER_RESUME:
@@ -181,6 +190,21 @@ void process_command()
     firmware_configuration_change_made = true;
     handle_write_firmware_configuration_value_order();
     break;
+  case ORDER_WRITE_FIRMWARE_CONFIG_VALUES:
+    firmware_configuration_change_made = true;
+    handle_write_firmware_configuration_values_order();
+    break;
+  case ORDER_WRITE_FIRMWARE_CONFIG_BY_HANDLE:
+    firmware_configuration_change_made = true;
+    handle_firmware_configuration_by_handle_order();
+    break;
+  case ORDER_READ_FIRMWARE_CONFIG_BY_HANDLE:
+    handle_firmware_configuration_by_handle_order();
+    break;
+  case ORDER_GET_FIRMWARE_CONFIG_HANDLE:
+    // note: get_command() already makes the end of the command (ie. name) null-terminated
+    handle_firmware_configuration_handle_request((const char *)&parameter_value[0]);
+    break;
   case ORDER_READ_FIRMWARE_CONFIG_VALUE:
     // note: get_command() already makes the end of the command (ie. name) null-terminated
     handle_firmware_configuration_request((const char *)&parameter_value[0], 0);
@@ -189,10 +213,31 @@ void process_command()
     // note: get_command() already makes the end of the command (ie. name) null-terminated
     handle_firmware_configuration_traversal((const char *)&parameter_value[0]);
     break;
+  case ORDER_TRAVERSE_FIRMWARE_CONFIG_PAGE:
+    if (parameter_length < 1)
+    {
+      send_insufficient_bytes_error_response(1);
+      break;
+    }
+    handle_firmware_configuration_traversal_page(parameter_value[0], &parameter_value[1], 
+        parameter_length - 1);
+    break;
   case ORDER_GET_FIRMWARE_CONFIG_PROPERTIES:
     // note: get_command() already makes the end of the command (ie. name) null-terminated
     handle_firmware_configuration_value_properties((const char *)&parameter_value[0]);
     break;
+  case ORDER_FLUSH_EEPROM_WRITES:
+    NVConfigStore::Flush();
+    send_OK_response();
+    break;
+  case ORDER_READ_TEMPERATURE_HISTORY:
+    if (parameter_length < 2)
+    {
+      send_insufficient_bytes_error_response(2);
+      break;
+    }
+    handle_temperature_history_request((parameter_value[0] << 8) | parameter_value[1]);
+    break;
   case ORDER_EMERGENCY_STOP:
     emergency_stop(PARAM_STOPPED_CAUSE_USER_REQUEST);
     send_OK_response();
@@ -307,6 +352,7 @@ void handle_request_information_order()
     generate_response_data_addbyte(PM_EXTENSION_STEPPER_CONTROL);
     generate_response_data_addbyte(PM_EXTENSION_QUEUED_CMD);
     generate_response_data_addbyte(PM_EXTENSION_BASIC_MOVE);
+    generate_response_data_addbyte(PM_EXTENSION_EXTENDED_FRAMES);
     break;
     
   case PARAM_REQUEST_INFO_FIRMWARE_TYPE:
@@ -338,6 +384,22 @@ void handle_request_information_order()
     generate_response_data_addbyte(HOST_TIMEOUT_SECS);
     break;
     
+  case PARAM_REQUEST_INFO_MAXIMUM_FRAME_LENGTH:
+    // the receive buffer grows once the command queue is allocated
+    generate_response_data_add(recv_buf_size);
+    break;
+    
+  case PARAM_REQUEST_INFO_CONFIG_SNAPSHOT_HASH:
+    // the hash of the device configuration which is restored at reset (if any)
+    if (NVConfigStore::GetConfigSnapshotLength() != 0)
+      generate_response_data_add(NVConfigStore::GetConfigSnapshotHash());
+    break;
+    
+  case PARAM_REQUEST_INFO_CONFIG_HASH:
+    // a rolling hash of the configuration applied since reset
+    generate_response_data_add(firmware_configuration_hash);
+    break;
+    
   default:
     send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_VALUE,0);
     return;
@@ -499,14 +561,20 @@ void handle_request_temperature_reading_order()
     send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_FORMAT, 0);
     return; 
   }
+  // each device's reading takes two bytes
+  if (parameter_length > MAX_RESPONSE_PARAM_LENGTH)
+  {
+    send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_FORMAT, PMSG(MSG_ERR_TOO_MANY_DEVICES));
+    return; 
+  }
 
-  generate_response_start(RSP_OK,parameter_length*2);
+  generate_response_start(RSP_OK,parameter_length);
   
   for (int i = 0; i < parameter_length; i+=2)
   {
     const uint8_t device_type = parameter_value[i];
     const uint8_t device_number = parameter_value[i+1];
-    float ftemp;
+    temperature_t current_temp;
     int16_t temp;
     
     switch(device_type)
@@ -518,7 +586,7 @@ void handle_request_temperature_reading_order()
         send_app_error_at_offset_response(PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER, i+1);
         return;
       }
-      ftemp = Device_Heater::ReadCurrentTemperature(device_number);
+      current_temp = Device_Heater::ReadCurrentTemperature(device_number);
       break;
     }
     case PM_DEVICE_TYPE_TEMP_SENSOR: 
@@ -528,15 +596,15 @@ void handle_request_temperature_reading_order()
         send_app_error_at_offset_response(PARAM_APP_ERROR_TYPE_INVALID_DEVICE_NUMBER, i+1);
         return;
       }
-      ftemp = Device_TemperatureSensor::ReadCurrentTemperature(device_number);
+      current_temp = Device_TemperatureSensor::ReadCurrentTemperature(device_number);
       break;
     }
     default:
       send_app_error_at_offset_response(PARAM_APP_ERROR_TYPE_INVALID_DEVICE_TYPE, i);
       return;
     }
-    if (ftemp != SENSOR_TEMPERATURE_INVALID)
-      temp = ftemp * 10.0;
+    if (current_temp != SENSOR_TEMPERATURE_INVALID)
+      temp = temperature_to_decidegrees(current_temp);
     else
       temp = PM_TEMPERATURE_INVALID;
     generate_response_data_addbyte(highByte(temp));
@@ -604,6 +672,7 @@ void handle_configure_heater_order()
   }
   else
   {
+    update_configuration_order_hash();
     send_OK_response();
   }
 }
@@ -617,11 +686,10 @@ void handle_set_heater_target_temperature_order()
   }
 
   const uint8_t heater_number = parameter_value[0];
-  const int16_t temp = (parameter_value[1] << 8) | parameter_value[2];
-  const float ftemp = (float)temp / 10;
+  const temperature_t temp = decidegrees_to_temperature((parameter_value[1] << 8) | parameter_value[2]);
 
   generate_response_start(RSP_APPLICATION_ERROR, 1);
-  uint8_t retval = Device_Heater::ValidateTargetTemperature(heater_number, ftemp);
+  uint8_t retval = Device_Heater::ValidateTargetTemperature(heater_number, temp);
   if (retval != APP_ERROR_TYPE_SUCCESS)
   {
     generate_response_data_addbyte(retval);
@@ -629,13 +697,13 @@ void handle_set_heater_target_temperature_order()
     return;
   }
 
-  if (is_stopped && ftemp != SENSOR_TEMPERATURE_INVALID)
+  if (is_stopped && temp != SENSOR_TEMPERATURE_INVALID)
   {
     send_app_error_response(PARAM_APP_ERROR_TYPE_DEVICE_UNAVAILABLE,
         PMSG(MSG_ERR_CANNOT_ACTIVATE_DEVICE_WHEN_STOPPED));
     return;
   }
-  Device_Heater::SetTargetTemperature(heater_number, ftemp);
+  Device_Heater::SetTargetTemperature(heater_number, temp);
   send_OK_response();
 }  
  
@@ -653,6 +721,12 @@ void handle_get_input_switch_state_order()
     send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_FORMAT, 0);
     return; 
   }
+  // each device's state takes one byte
+  if (parameter_length / 2 > MAX_RESPONSE_PARAM_LENGTH)
+  {
+    send_app_error_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_FORMAT, PMSG(MSG_ERR_TOO_MANY_DEVICES));
+    return; 
+  }
 
   generate_response_start(RSP_OK,parameter_length/2);
   
@@ -692,7 +766,7 @@ void handle_set_output_switch_state_order()
     return; 
   }
 
-  for (uint8_t i = 0; i < parameter_length; i+=3)
+  for (uint16_t i = 0; i < parameter_length; i+=3)
   {
     if (i + 3 > parameter_length)
     {
@@ -721,7 +795,7 @@ void handle_set_output_switch_state_order()
   }  
 
   // we only write the switches if all are valid
-  for (uint8_t i = 0; i < parameter_length; i+=3)
+  for (uint16_t i = 0; i < parameter_length; i+=3)
   {
     device_type = parameter_value[i];
     device_number = parameter_value[i+1];
@@ -827,6 +901,75 @@ void handle_write_firmware_configuration_value_order()
   handle_firmware_configuration_request((const char *)&parameter_value[0], (const char *)&parameter_value[name_length+1]);
 } 
 
+void handle_write_firmware_configuration_values_order()
+{
+  uint16_t offset = 0;
+  uint16_t num_entries = 0;
+  
+  // validate the framing of all entries before applying any of them
+  while (offset < parameter_length)
+  {
+    const uint8_t name_length = parameter_value[offset];
+    if (name_length == 0 || offset + name_length + 2 > parameter_length
+        || offset + name_length + 2 + parameter_value[offset + name_length + 1] > parameter_length
+        || num_entries == MAX_BULK_CONFIG_ENTRIES)
+    {
+      send_app_error_at_offset_response(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_FORMAT, offset);
+      return;
+    }
+    offset += name_length + 2 + parameter_value[offset + name_length + 1];
+    num_entries += 1;
+  }
+  
+  uint8_t failed_bitmap[(MAX_BULK_CONFIG_ENTRIES + 7) / 8];
+  memset(failed_bitmap, 0, (num_entries + 7) / 8);
+  
+  offset = 0;
+  for (uint8_t i = 0; i < num_entries; i++)
+  {
+    char *name = (char *)&parameter_value[offset];
+    const uint8_t name_length = name[0];
+    char *value = &name[name_length + 1];
+    const uint8_t value_length = value[0];
+
+    // shift the name and value down a byte to make them null terminated
+    memmove(&name[0], &name[1], name_length);
+    name[name_length] = '\0';
+    memmove(&value[0], &value[1], value_length);
+    value[value_length] = '\0';
+    
+    if (!apply_firmware_configuration_value(name, value))
+      failed_bitmap[i / 8] |= (1 << (i % 8));
+
+    offset += name_length + 2 + value_length;
+  }
+  
+  generate_response_start(RSP_OK);
+  generate_response_data_addbyte(num_entries);
+  generate_response_data_add(failed_bitmap, (num_entries + 7) / 8);
+  generate_response_send();
+} 
+
+void handle_firmware_configuration_by_handle_order()
+{
+  if (parameter_length < PM_CONFIG_HANDLE_SIZE)
+  {
+    send_insufficient_bytes_error_response(PM_CONFIG_HANDLE_SIZE);
+    return; 
+  }
+  
+  // these functions will handle response generation
+  if (order_code == ORDER_READ_FIRMWARE_CONFIG_BY_HANDLE)
+  {
+    handle_firmware_configuration_read_by_handle(parameter_value[0], parameter_value[1]);
+  }
+  else
+  {
+    handle_firmware_configuration_write_by_handle(parameter_value[0], parameter_value[1],
+        &parameter_value[PM_CONFIG_HANDLE_SIZE], parameter_length - PM_CONFIG_HANDLE_SIZE);
+  }
+}
+
 void handle_activate_stepper_control_order()
 {
   if (parameter_length < 1)
@@ -884,7 +1027,7 @@ void handle_enable_disable_steppers_order()
 
 void handle_configure_endstops_order()
 {
-  uint8_t num_endstops = (parameter_length-1) / 2;
+  uint16_t num_endstops = (parameter_length-1) / 2;
   
   if (parameter_length < 3 || parameter_length != (2 * num_endstops) + 1)
   {
@@ -901,7 +1044,7 @@ void handle_configure_endstops_order()
   
   AxisInfo::ClearEndstops(axis_number);
   
-  for (uint8_t i=1; i < parameter_length; i+=2)
+  for (uint16_t i=1; i < parameter_length; i+=2)
   {
     uint8_t device_number = parameter_value[i];
     uint8_t min_or_max = parameter_value[i+1];
@@ -919,6 +1062,7 @@ void handle_configure_endstops_order()
       return;
     }
   }
+  update_configuration_order_hash();
   send_OK_response();
 }
 
@@ -930,7 +1074,7 @@ void handle_enable_disable_endstops_order()
     return;
   }
   
-  for (uint8_t i=0; i < parameter_length; i+=2)
+  for (uint16_t i=0; i < parameter_length; i+=2)
   {
     uint8_t device_number = parameter_value[i];
     if (!Device_InputSwitch::IsInUse(device_number) || device_number >= MAX_ENDSTOPS)
@@ -940,7 +1084,7 @@ void handle_enable_disable_endstops_order()
     }
   }
   
-  for (uint8_t i=0; i < parameter_length; i+=2)
+  for (uint16_t i=0; i < parameter_length; i+=2)
   {
     AxisInfo::WriteEndstopEnableState(parameter_value[i], parameter_value[i+1]);
   }
@@ -977,6 +1121,7 @@ void handle_configure_axis_movement_rates_order()
     send_app_error_response(retval, 0);
     return;
   }
+  update_configuration_order_hash();
   send_OK_response();  
 }
 
@@ -1007,6 +1152,7 @@ void handle_configure_underrun_params_order()
 
   AxisInfo::SetUnderrunRate(device_number, underrun_rate);
   AxisInfo::SetUnderrunAccelRate(device_number, underrun_accel_rate);
+  update_configuration_order_hash();
   send_OK_response();  
 }
 
@@ -1038,3 +1184,9 @@ void handle_clear_command_queue_order()
   generate_response_send(); 
 } 
 
+// Includes a successful configuration order in the configuration hash
+void update_configuration_order_hash()
+{
+  update_firmware_configuration_hash(&order_code, 1);
+  update_firmware_configuration_hash(parameter_value, parameter_length);
+}
@@ -29,6 +29,7 @@
 //
 
 #define SYNC_BYTE_ORDER_VALUE       0x23
+#define SYNC_BYTE_EXTENDED_ORDER_VALUE  0x24
 #define SYNC_BYTE_RESPONSE_VALUE    0x42
 
 #define CONTROL_BYTE_SEQUENCE_NUMBER_MASK       0x0F
@@ -42,8 +43,26 @@
 #define PM_ORDER_BYTE_OFFSET        3
 #define PM_PARAMETER_OFFSET         4
 #define PM_HEADER_SIZE              PM_PARAMETER_OFFSET
+
+// Extended order frames (PM_EXTENSION_EXTENDED_FRAMES) allow larger parameter blocks 
+// (e.g., many queued move blocks) by using a 16-bit length (big endian, covering the
+// control byte, order byte and parameters as per normal frames) and a 16-bit check code 
+// (crc16 over the length bytes through to the end of the parameters, big endian).
+// Responses always use the normal frame format.
+#define PM_EXTENDED_LENGTH_OFFSET           1
+#define PM_EXTENDED_CONTROL_BYTE_OFFSET     3
+#define PM_EXTENDED_ORDER_BYTE_OFFSET       4
+#define PM_EXTENDED_PARAMETER_OFFSET        5
+#define PM_EXTENDED_HEADER_SIZE             PM_EXTENDED_PARAMETER_OFFSET
+#define PM_EXTENDED_CHECK_CODE_SIZE         2
     
 #define MAX_FRAME_COMPLETION_DELAY_MS     30 // this is actually measured from the start of the frame (hence the larger value)
+#define MAX_EXTENDED_FRAME_COMPLETION_DELAY_MS  250 // allows for a full receive buffer at 115200 baud
+
+// When enabled (system.queue_status_trailer), every application response carries a
+// trailer after the parameter (and any message) containing the remaining queue slots,
+// current queue command count and total queue command count (as uint16 values). 
+#define PM_QUEUE_STATUS_TRAILER_SIZE      6
 
 //
 // Protocol Defines
@@ -56,6 +75,7 @@
 #define PM_EXTENSION_QUEUED_CMD           0x1
 #define PM_EXTENSION_BASIC_MOVE           0x2
 #define PM_EXTENSION_ERROR_REPORTING      0x3
+#define PM_EXTENSION_EXTENDED_FRAMES      0x4
 
 #define PM_DEVICE_TYPE_SWITCH_INPUT       0x1
 #define PM_DEVICE_TYPE_SWITCH_OUTPUT      0x2
@@ -87,6 +107,7 @@
 
 // Unsolicited Client Frames
 #define RSP_UNSOLICITED_DEBUG_MESSAGE     0x50
+#define RSP_UNSOLICITED_EVENT             0x51
 
 //
 // Response Parameter Value Definitions
@@ -147,6 +168,13 @@
 #define ORDER_READ_FIRMWARE_CONFIG_VALUE       0x0b
 #define ORDER_TRAVERSE_FIRMWARE_CONFIG         0x1b
 #define ORDER_GET_FIRMWARE_CONFIG_PROPERTIES   0x1a
+#define ORDER_WRITE_FIRMWARE_CONFIG_VALUES     0x1d
+#define ORDER_GET_FIRMWARE_CONFIG_HANDLE       0x1e
+#define ORDER_READ_FIRMWARE_CONFIG_BY_HANDLE   0x1f
+#define ORDER_WRITE_FIRMWARE_CONFIG_BY_HANDLE  0x20
+#define ORDER_TRAVERSE_FIRMWARE_CONFIG_PAGE    0x21
+#define ORDER_FLUSH_EEPROM_WRITES              0x22
+#define ORDER_READ_TEMPERATURE_HISTORY         0x23
 #define ORDER_EMERGENCY_STOP                   0x0c
 
 #define ORDER_RESET                            0x7f
@@ -171,6 +199,15 @@
 //
 
 #define UNSOLICITED_FRAME_DEBUG_MESSAGE        0x50
+#define UNSOLICITED_FRAME_EVENT                0x51
+
+// Event Frame Parameter values (sent as event type/event data byte pairs)
+#define PARAM_EVENT_TYPE_EVENTS_LOST                      0x0 // data = number of events lost
+#define PARAM_EVENT_TYPE_STOPPED                          0x1 // data = stopped cause
+#define PARAM_EVENT_TYPE_ENDSTOP_HIT                      0x2 // data = input switch number
+#define PARAM_EVENT_TYPE_HEATER_FAULT                     0x3 // data = heater number
+#define PARAM_EVENT_TYPE_QUEUE_LOW_WATER                  0x4 // data = queue command count
+#define PARAM_EVENT_TYPE_CHECKPOINT_REACHED               0x5 // data = 0
 
 //
 // Order Parameter Values
@@ -180,6 +217,43 @@
 #define PARAM_RESUME_TYPE_ACKNOWLEDGE                     0x0
 #define PARAM_RESUME_TYPE_CLEAR                           0x1
 
+// Write Firmware Configuration Values Order
+// Each entry is: name length, name, value length, value. The response 
+// contains the number of entries followed by a bitmap of failed entries 
+// (bit 0 of the first byte is the first entry).
+#define MAX_BULK_CONFIG_ENTRIES                           255
+
+// Firmware Configuration Handles
+// A handle (node type, device number) is returned by ORDER_GET_FIRMWARE_CONFIG_HANDLE
+// along with the value's datatype and operations. Values read and written using the 
+// handle are binary encoded according to the datatype:
+//   uint8/bool: 1 byte, int16: 2 bytes, float: 4 byte IEEE754, string: raw bytes
+//   (multi-byte values are big endian). Read-only status and statistics values have 
+//   no binary datatype and are returned as text (the same as when read by name).
+#define PM_CONFIG_HANDLE_SIZE                             2
+
+// Traverse Firmware Configuration Page Order
+// The order contains the flags followed by the cursor returned by the previous 
+// page (or no cursor to start a traversal). The response contains the cursor length
+// and cursor for the next page (an empty cursor indicates the traversal is complete)
+// followed by the entries. Each entry is: name length, name and, if requested, 
+// value length, value and the leaf class & operations.
+#define PARAM_TRAVERSE_FLAG_VALUES                        0x1
+#define PARAM_TRAVERSE_FLAG_PROPERTIES                    0x2
+
+// Read Temperature History Order
+// The order contains a 16 bit cursor, the cursor returned by the previous response (any 
+// value can be used for the first request). The response contains the cursor for the 
+// next request, the (16 bit) number of samples lost since the cursor (ie. overwritten 
+// before being read) and then the samples recorded since the cursor in order. Each 
+// sample is: time (low 16 bits of the millisecond clock), temperature sensor number, 
+// temperature (int16 in 1/10 degrees C) and the power level of the heater using the sensor.
+// If not all samples fit in the response, the remainder are sent in the next response.
+// A cursor which is ahead of the most recent sample returns all of the available samples.
+// The samples of all sensors share one buffer, so the host must read the history within
+// TEMPERATURE_HISTORY_LENGTH / <number of sensors> sample intervals to avoid losing samples.
+#define PM_TEMPERATURE_HISTORY_SAMPLE_SIZE                6
+
 // Request Information Order
 #define PARAM_REQUEST_INFO_FIRMWARE_NAME                  0x0
 #define PARAM_REQUEST_INFO_BOARD_SERIAL_NUMBER            0x1
@@ -195,6 +269,9 @@
 #define PARAM_REQUEST_INFO_HARDWARE_REVISION              0xb
 #define PARAM_REQUEST_INFO_MAXIMUM_STEP_RATE              0xc
 #define PARAM_REQUEST_INFO_HOST_TIMEOUT                   0xd
+#define PARAM_REQUEST_INFO_MAXIMUM_FRAME_LENGTH           0xe
+#define PARAM_REQUEST_INFO_CONFIG_SNAPSHOT_HASH           0xf
+#define PARAM_REQUEST_INFO_CONFIG_HASH                    0x10
 
 // Get Heater Configuration
 #define PARAM_HEATER_CONFIG_INTERNAL_SENSOR_CONFIG        0x0
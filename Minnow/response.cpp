@@ -24,6 +24,8 @@
 #include "response.h"
 #include "protocol.h"
 #include "crc8.h"
+#include "events.h"
+#include "CommandQueue.h"
 
 #include "Minnow.h"
 
@@ -40,8 +42,11 @@
 //=============================public variables=============================
 //===========================================================================
 
-uint8_t reply_header[PM_HEADER_SIZE] = { SYNC_BYTE_RESPONSE_VALUE };
-uint8_t reply_buf[MAX_RESPONSE_PARAM_LENGTH];
+// The response is built in place within the complete frame (header, parameter and 
+// optional trailer) so that it can be sent (or resent) without further copying.
+uint8_t reply_frame[PM_HEADER_SIZE + MAX_RESPONSE_PARAM_LENGTH + PM_QUEUE_STATUS_TRAILER_SIZE] 
+    = { SYNC_BYTE_RESPONSE_VALUE };
+uint8_t * const reply_buf = &reply_frame[PM_PARAMETER_OFFSET];
 
 bool reply_sent = false;
 bool reply_started = false;
@@ -50,6 +55,7 @@ uint8_t reply_expected_length_excluding_msg = 0;
 uint8_t reply_data_len = 0;
 uint8_t reply_msg_len = 0;
 bool response_squelch = false;
+bool response_queue_status_trailer = false;
 
 //===========================================================================
 //============================= ROUTINES =============================
@@ -61,9 +67,9 @@ bool response_squelch = false;
 void generate_response_start(uint8_t response_code, uint8_t expected_length_excluding_msg)
 { 
   reply_started = true;
-  reply_header[PM_ORDER_BYTE_OFFSET] = response_code;
+  reply_frame[PM_ORDER_BYTE_OFFSET] = response_code;
   reply_control_byte = (control_byte & CONTROL_BYTE_SEQUENCE_NUMBER_MASK);
-  reply_header[PM_CONTROL_BYTE_OFFSET] = reply_control_byte;
+  reply_frame[PM_CONTROL_BYTE_OFFSET] = reply_control_byte;
   reply_expected_length_excluding_msg = expected_length_excluding_msg;
   reply_data_len = 0;
   reply_msg_len = 0;
@@ -74,8 +80,8 @@ void generate_response_start(uint8_t response_code, uint8_t expected_length_excl
 void generate_response_transport_error_start(uint8_t transport_error, uint8_t local_control_byte)
 {
   reply_started = true;
-  reply_header[PM_ORDER_BYTE_OFFSET] = RSP_FRAME_RECEIPT_ERROR;
-  reply_header[PM_CONTROL_BYTE_OFFSET] = (local_control_byte & CONTROL_BYTE_SEQUENCE_NUMBER_MASK);
+  reply_frame[PM_ORDER_BYTE_OFFSET] = RSP_FRAME_RECEIPT_ERROR;
+  reply_frame[PM_CONTROL_BYTE_OFFSET] = (local_control_byte & CONTROL_BYTE_SEQUENCE_NUMBER_MASK);
   reply_buf[0] = transport_error;
   reply_expected_length_excluding_msg = 1;
   reply_data_len = 1;
@@ -125,13 +131,13 @@ void generate_response_data_add(const uint8_t *value, uint8_t length)
 }
 void generate_response_data_add(const char *str)
 {
-  while (*str != 0 && reply_data_len < sizeof(reply_buf))
+  while (*str != 0 && reply_data_len < MAX_RESPONSE_PARAM_LENGTH)
     reply_buf[reply_data_len++] = *str++;
 }
 void generate_response_data_addPGM(const char *str)
 {
   char ch;
-  while ((ch = pgm_read_byte(str++)) != '\0' && reply_data_len < sizeof(reply_buf))
+  while ((ch = pgm_read_byte(str++)) != '\0' && reply_data_len < MAX_RESPONSE_PARAM_LENGTH)
     reply_buf[reply_data_len++] = ch;
 }
 void generate_response_data_clear()
@@ -144,7 +150,7 @@ uint8_t *generate_response_data_ptr()
 }
 uint8_t generate_response_data_len()
 {
-  return sizeof(reply_buf) - reply_data_len;
+  return MAX_RESPONSE_PARAM_LENGTH - reply_data_len;
 }
 void generate_response_data_addlen(uint8_t len)
 {
@@ -154,22 +160,22 @@ void generate_response_data_addlen(uint8_t len)
 
 void generate_response_msg_addbyte(uint8_t value)
 {
-  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < sizeof(reply_buf))
+  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < MAX_RESPONSE_PARAM_LENGTH)
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value;
 }
 void generate_response_msg_add(uint8_t value)
 {
-  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < sizeof(reply_buf))
+  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < MAX_RESPONSE_PARAM_LENGTH)
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value;
 }
 void generate_response_msg_add(int8_t value)
 {
-  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < sizeof(reply_buf))
+  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < MAX_RESPONSE_PARAM_LENGTH)
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value;
 }
 void generate_response_msg_add(uint16_t value)
 {
-  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < sizeof(reply_buf)-1)
+  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < MAX_RESPONSE_PARAM_LENGTH-1)
   {
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value >> 8;
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value & 0xFF;
@@ -177,7 +183,7 @@ void generate_response_msg_add(uint16_t value)
 }
 void generate_response_msg_add(int16_t value)
 {
-  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < sizeof(reply_buf)-1)
+  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < MAX_RESPONSE_PARAM_LENGTH-1)
   {
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value >> 8;
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value & 0xFF;
@@ -185,7 +191,7 @@ void generate_response_msg_add(int16_t value)
 }
 void generate_response_msg_add(uint32_t value)
 {
-  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < sizeof(reply_buf)-3)
+  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < MAX_RESPONSE_PARAM_LENGTH-3)
   {
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value >> 24;
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = (value >> 16) & 0xFF;
@@ -195,7 +201,7 @@ void generate_response_msg_add(uint32_t value)
 }
 void generate_response_msg_add(int32_t value)
 {
-  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < sizeof(reply_buf)-3)
+  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len) < MAX_RESPONSE_PARAM_LENGTH-3)
   {
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = value >> 24;
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = (value >> 16) & 0xFF;
@@ -205,22 +211,22 @@ void generate_response_msg_add(int32_t value)
 }
 void generate_response_msg_add(const uint8_t *value, uint8_t length)
 {
-  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len + length) <= sizeof(reply_buf))
+  if ((uint16_t)(reply_expected_length_excluding_msg + reply_msg_len + length) <= MAX_RESPONSE_PARAM_LENGTH)
   {
-    uint8_t copy_length = min(length,sizeof(reply_buf)-(reply_expected_length_excluding_msg + reply_msg_len));
+    uint8_t copy_length = min(length,MAX_RESPONSE_PARAM_LENGTH-(reply_expected_length_excluding_msg + reply_msg_len));
     memcpy(&reply_buf[reply_expected_length_excluding_msg + reply_msg_len], value, copy_length);
     reply_msg_len += copy_length;
   }
 }
 void generate_response_msg_add(const char *str)
 {
-  while (*str != 0 && reply_expected_length_excluding_msg + reply_msg_len < sizeof(reply_buf))
+  while (*str != 0 && reply_expected_length_excluding_msg + reply_msg_len < MAX_RESPONSE_PARAM_LENGTH)
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = *str++;
 }
 void generate_response_msg_addPGM(const char *str)
 {
   char ch;
-  while ((ch = pgm_read_byte(str++)) != '\0' && reply_expected_length_excluding_msg + reply_msg_len < sizeof(reply_buf))
+  while ((ch = pgm_read_byte(str++)) != '\0' && reply_expected_length_excluding_msg + reply_msg_len < MAX_RESPONSE_PARAM_LENGTH)
     reply_buf[reply_expected_length_excluding_msg + reply_msg_len++] = ch;
 }
 void generate_response_msg_clear()
@@ -263,7 +269,7 @@ uint8_t *generate_response_msg_ptr()
 }
 uint8_t generate_response_msg_len()
 {
-  return sizeof(reply_buf) - (reply_expected_length_excluding_msg + reply_msg_len);
+  return MAX_RESPONSE_PARAM_LENGTH - (reply_expected_length_excluding_msg + reply_msg_len);
 }
 void generate_response_msg_addlen(uint8_t len)
 {
@@ -274,7 +280,7 @@ void generate_response_msg_addlen(uint8_t len)
 void generate_response_send()
 {
   uint8_t param_length;
-  uint8_t i;
+  uint8_t trailer_length = 0;
   
   if (response_squelch)
     return;
@@ -284,19 +290,39 @@ void generate_response_send()
   else
     param_length = reply_expected_length_excluding_msg + reply_msg_len;
   
-  reply_header[PM_LENGTH_BYTE_OFFSET] = param_length + 2;
+  // transport errors are never given a trailer as the order may not have been read
+  if (response_queue_status_trailer 
+      && reply_frame[PM_ORDER_BYTE_OFFSET] != RSP_FRAME_RECEIPT_ERROR)
+  {
+    uint16_t remaining_slots, current_command_count, total_command_count;
+    CommandQueue::GetQueueInfo(remaining_slots, current_command_count, total_command_count);
+    uint8_t *trailer = &reply_buf[param_length];
+    trailer[0] = remaining_slots >> 8;
+    trailer[1] = remaining_slots & 0xFF;
+    trailer[2] = current_command_count >> 8;
+    trailer[3] = current_command_count & 0xFF;
+    trailer[4] = total_command_count >> 8;
+    trailer[5] = total_command_count & 0xFF;
+    trailer_length = PM_QUEUE_STATUS_TRAILER_SIZE;
+  }
+  
+  reply_frame[PM_LENGTH_BYTE_OFFSET] = param_length + trailer_length + 2;
 
-  // TODO set event flag if required
+  // flag to the host that an unsolicited event frame will follow
+  if (events_pending())
+    reply_frame[PM_CONTROL_BYTE_OFFSET] |= CONTROL_BYTE_RESPONSE_EVENT_BIT;
+  else
+    reply_frame[PM_CONTROL_BYTE_OFFSET] &= ~CONTROL_BYTE_RESPONSE_EVENT_BIT;
 
 #if TRACE_RESPONSE
   DEBUGPGM("\nResp(");  
-  DEBUG_F(reply_header[PM_ORDER_BYTE_OFFSET], HEX);  
+  DEBUG_F(reply_frame[PM_ORDER_BYTE_OFFSET], HEX);  
   DEBUGPGM(", plen=");  
   DEBUG_F(param_length, DEC);  
   DEBUGPGM(", cb=");  
-  DEBUG_F(reply_header[PM_CONTROL_BYTE_OFFSET], DEC);  
+  DEBUG_F(reply_frame[PM_CONTROL_BYTE_OFFSET], DEC);  
   DEBUGPGM("):");  
-  for (i = 0; i < param_length; i++)
+  for (uint8_t i = 0; i < param_length; i++)
   {
     DEBUG_CH(' '); 
     DEBUG_F(reply_buf[i], HEX);  
@@ -304,20 +330,28 @@ void generate_response_send()
   DEBUG_EOL();
 #endif  
 
-  for (i = 0; i < PM_HEADER_SIZE; i++)
-    PSERIAL.write(reply_header[i]);
-  for (i = 0; i < param_length; i++)
-    PSERIAL.write(reply_buf[i]);
-    
   // take crc over header and parameter (except sync byte)
-  uint8_t crc = crc8(&reply_header[1], PM_HEADER_SIZE-1);
-  if (param_length > 0)
-    crc = crc8_continue(reply_buf, param_length, crc);
+  PSERIAL.write(reply_frame[PM_SYNC_BYTE_OFFSET]);
+  uint8_t crc = write_frame_bytes(&reply_frame[PM_LENGTH_BYTE_OFFSET], 
+      PM_HEADER_SIZE - 1 + param_length + trailer_length, 0);
   PSERIAL.write(crc);
   reply_started = false;
   reply_sent = true;
 }
 
+uint8_t write_frame_bytes(const uint8_t *data, uint16_t length, uint8_t crc)
+{
+  // the crc of each byte is calculated while the previous byte is being 
+  // transmitted rather than in a separate pass.
+  while (length-- > 0)
+  {
+    const uint8_t value = *data++;
+    PSERIAL.write(value);
+    crc = crc8_update(crc, value);
+  }
+  return crc;
+}
+
 //
 // Convenience functions
 //
@@ -328,12 +362,12 @@ void send_OK_response()
   generate_response_send();
 }
 
-void send_insufficient_bytes_error_response(uint8_t expected_num_bytes)
+void send_insufficient_bytes_error_response(uint16_t expected_num_bytes)
 {
   send_insufficient_bytes_error_response(expected_num_bytes, parameter_length);
 }
 
-void send_insufficient_bytes_error_response(uint8_t expected_num_bytes, uint8_t actual_bytes)
+void send_insufficient_bytes_error_response(uint16_t expected_num_bytes, uint16_t actual_bytes)
 {
   generate_response_start(RSP_APPLICATION_ERROR, 1);
   generate_response_data_addbyte(PARAM_APP_ERROR_TYPE_BAD_PARAMETER_FORMAT);
@@ -345,7 +379,7 @@ void send_insufficient_bytes_error_response(uint8_t expected_num_bytes, uint8_t
   generate_response_send();
 }
 
-void send_app_error_at_offset_response(uint8_t error_type, uint8_t parameter_offset)
+void send_app_error_at_offset_response(uint8_t error_type, uint16_t parameter_offset)
 {
   generate_response_start(RSP_APPLICATION_ERROR, 1);
   generate_response_data_addbyte(error_type);
@@ -82,14 +82,19 @@ uint8_t generate_response_msg_len();
 //
 void generate_response_send();
 
+//
+// Writes frame bytes to the host and returns the updated crc8 value
+//
+uint8_t write_frame_bytes(const uint8_t *data, uint16_t length, uint8_t crc);
+
 //
 // Convenience Functions
 //
 
 void send_OK_response();
-void send_insufficient_bytes_error_response(uint8_t expected_num_bytes);
-void send_insufficient_bytes_error_response(uint8_t expected_num_bytes, uint8_t rcvd_num_bytes);
-void send_app_error_at_offset_response(uint8_t error_type, uint8_t parameter_offset);
+void send_insufficient_bytes_error_response(uint16_t expected_num_bytes);
+void send_insufficient_bytes_error_response(uint16_t expected_num_bytes, uint16_t rcvd_num_bytes);
+void send_app_error_at_offset_response(uint8_t error_type, uint16_t parameter_offset);
 void send_app_error_response(uint8_t error_type, const char *msg_pstr);
 void send_app_error_response(uint8_t error_type, const char *msg_pstr, int32_t msg_num_value);
 void send_app_error_response(uint8_t error_type, const char *msg_pstr, const char *msg_str_value);
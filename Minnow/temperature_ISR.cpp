@@ -47,6 +47,7 @@ uint8_t *Device_TemperatureSensor::temperature_sensor_pins;
 int8_t *Device_TemperatureSensor::temperature_sensor_types;
 uint16_t *Device_TemperatureSensor::temperature_sensor_isr_raw_values;
 uint16_t *Device_TemperatureSensor::temperature_sensor_raw_values;
+uint8_t *Device_TemperatureSensor::temperature_sensor_oversampling;
  
 // Function declarations
 FORCE_INLINE void updateSoftPwm(); // needs to be non-static due to friend usage elsewhere
@@ -64,6 +65,11 @@ void temperature_ISR_init()
 ISR(TIMER0_COMPB_vect)
 {
   updateSoftPwm();
+}
+
+// The ADC runs free (see Device_TemperatureSensor::Init) and interrupts on every completed conversion
+ISR(ADC_vect)
+{
   updateTemperatureSensorRawValues();
 }
 
@@ -97,14 +103,16 @@ FORCE_INLINE void updateSoftPwm()
       if ((device_bitmask & 1) != 0)
       {
         volatile uint8_t *output_reg = state->output_reg[i];
-        if(state->pwm_isr_count == 0)
+        // each device's period starts at its own phase so the devices don't all switch on together
+        const uint8_t pwm_device_count = (state->pwm_isr_count - state->pwm_phase[i]) & 0x7f;
+        if (pwm_device_count == 0)
         {
           if ((state->pwm_count[i] = state->pwm_power[i]) > 0)
             *output_reg |= state->output_bit[i];
         }
         else
         {
-          if (state->pwm_count[i] <= state->pwm_isr_count)
+          if (state->pwm_count[i] <= pwm_device_count)
             *output_reg &= ~state->output_bit[i];
         }
       }
@@ -121,119 +129,71 @@ FORCE_INLINE void updateSoftPwm()
 
 FORCE_INLINE void updateTemperatureSensorRawValues()
 {
-  static uint8_t temp_count = 0;
-  static uint8_t temp_index = 0;
+  // The sensors are read back to back: each sensor gets one discarded conversion after its 
+  // channel is selected followed by (1 << oversampling shift) accumulated conversions. 
+  // In free-running mode the conversion which is already underway when the multiplexer is 
+  // switched still samples the old channel, so the first result after a switch is never used 
+  // (this also gives the sample and hold capacitor time to settle on the new channel).
+  static uint8_t sensor = 0;
+  static uint8_t sample_count = 0; // 0 == discard conversion
+  static uint8_t sample_shift = 0;
+  static uint16_t sample_sum = 0;
 
+  const uint16_t adc_value = ADC;
   const uint8_t num_sensors = Device_TemperatureSensor::num_temperature_sensors;
-  if (num_sensors <= 4)
+  if (num_sensors == 0)
+    return;
+  
+  if (sample_count == 0)
   {
-    // if there are 4 or less sensors then we prepare and read the sensors on alternate interrupt cycles
-    const uint8_t sensor = temp_index / 2;
-    if (sensor < num_sensors)
-    {
-      const int8_t type = Device_TemperatureSensor::temperature_sensor_types[sensor];
-      if (type != TEMP_SENSOR_TYPE_INVALID)
-      {
-        if ((temp_index & 1) == 0)
-        {
-          // prepare temperature reading
-          const uint8_t pin = Device_TemperatureSensor::temperature_sensor_pins[sensor];
-#ifdef MUX5
-          if (pin > 7)
-            ADCSRB = 1<<MUX5;
-          else
-#endif          
-            ADCSRB = 0;
-          ADMUX = ((1 << REFS0) | (pin & 0x07));
-          ADCSRA |= 1<<ADSC; // Start conversion
-        }
-        else
-        {
-          // retrieve measurement
-          Device_TemperatureSensor::temperature_sensor_isr_raw_values[sensor] += ADC;
-        }
-      }
-      else
-      {
-        // TODO handle other sensor types
-      }
-    }
-    // we loop through sensors every 8ms
-    if (++temp_index >= 8)
-    {
-      temp_count += 1;
-      temp_index = 0;
-    }
+    sample_shift = Device_TemperatureSensor::temperature_sensor_oversampling[sensor];
+    sample_sum = 0;
   }
   else
   {
-    // if there are more than 4 sensors then we both read and prepare on each interrupt cycle (but for consecutive sensors)
-    
-    // first, retrieve previous measurement (time slot 0 is only used if there are >=8 sensors)
-    if (num_sensors >= 8 || (temp_index > 0 && temp_index <= num_sensors))
-    {
-      const uint8_t sensor = (temp_index > 0) ? temp_index - 1 : num_sensors - 1;
-      const int8_t type = Device_TemperatureSensor::temperature_sensor_types[sensor];
-      if (type != TEMP_SENSOR_TYPE_INVALID)
-      {
-        Device_TemperatureSensor::temperature_sensor_isr_raw_values[sensor] += ADC;
-      }
-      else
-      {
-        // TODO handle other types
-      }
-    }
-    // second, prepare next measurement
-    if (temp_index < num_sensors) 
-    {
-      // sensor == temp_index in this case
-      const int8_t type = Device_TemperatureSensor::temperature_sensor_types[temp_index];
-      if (type != TEMP_SENSOR_TYPE_INVALID)
-      {
-        const uint8_t pin = Device_TemperatureSensor::temperature_sensor_pins[temp_index];
-#ifdef MUX5
-        if (pin > 7)
-          ADCSRB = 1<<MUX5;
-        else
-#endif        
-          ADCSRB = 0;
-        ADMUX = ((1 << REFS0) | (pin & 0x07));
-        ADCSRA |= 1<<ADSC; // Start conversion
-      }
-      else
-      {
-        // TODO handle other sensor types
-      }
-    }
-    // we loop through sensors no faster than every 8 ms
-    if (++temp_index >= max(num_sensors,8))
-    {
-      temp_count++;
-      temp_index = 0;
-    }
+    sample_sum += adc_value;
+  }
+  
+  if (sample_count++ < (1 << sample_shift))
+    return;
+
+  // all samples for this sensor have been taken - store the result scaled to OVERSAMPLENR samples
+  if (Device_TemperatureSensor::temperature_sensor_types[sensor] != TEMP_SENSOR_TYPE_INVALID)
+  {
+    if (sample_shift <= OVERSAMPLENR_SHIFT)
+      Device_TemperatureSensor::temperature_sensor_isr_raw_values[sensor] = sample_sum << (OVERSAMPLENR_SHIFT - sample_shift);
+    else
+      Device_TemperatureSensor::temperature_sensor_isr_raw_values[sensor] = sample_sum >> (sample_shift - OVERSAMPLENR_SHIFT);
+  }
+  else
+  {
+    // TODO handle other sensor types
   }
+  sample_count = 0;
   
-  // We oversample 16 times, so with 8 or fewer temperature sensors we update raw temperature readings every 8ms * 16 = 128ms
-    
-  if(temp_count >= OVERSAMPLENR) 
+  if (++sensor >= num_sensors)
   {
+    sensor = 0;
     //Only update the raw values if they have been read. Else we could be updating them during reading.
     if (!temp_meas_ready) 
     {
       for (uint8_t i=0; i<num_sensors; i++)
-      {
         Device_TemperatureSensor::temperature_sensor_raw_values[i] = Device_TemperatureSensor::temperature_sensor_isr_raw_values[i];
-        Device_TemperatureSensor::temperature_sensor_isr_raw_values[i] = 0;
-      }
-    }
-    else
-    {
-      for (uint8_t i=0; i<num_sensors; i++)
-      {
-        Device_TemperatureSensor::temperature_sensor_isr_raw_values[i] = 0;
-      }
     }
     temp_meas_ready = true;
-    temp_count = 0;
+  }
+
+  // select the next sensor's channel (unused sensors keep their time slot so that the 
+  // sampling period stays constant but leave the multiplexer unchanged)
+  if (Device_TemperatureSensor::temperature_sensor_types[sensor] != TEMP_SENSOR_TYPE_INVALID)
+  {
+    const uint8_t pin = Device_TemperatureSensor::temperature_sensor_pins[sensor];
+#ifdef MUX5
+    if (pin > 7)
+      ADCSRB = 1<<MUX5;
+    else
+#endif          
+      ADCSRB = 0;
+    ADMUX = ((1 << REFS0) | (pin & 0x07));
   }
 }
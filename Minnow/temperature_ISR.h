@@ -26,7 +26,10 @@
 
 void temperature_ISR_init();
 
-// Number of times that the ADC temperature measurement is oversampled.
+// Scale of the raw temperature values (i.e., raw values are the sum of this many 10-bit 
+// ADC samples). This is also the default oversampling count of each sensor, sensors 
+// configured with other oversampling counts have their sums rescaled to match.
 #define OVERSAMPLENR 16
+#define OVERSAMPLENR_SHIFT 4
 
 #endif
\ No newline at end of file
@@ -0,0 +1,133 @@
+/*
+ Minnow Pacemaker client firmware.
+    
+ Copyright (C) 2013 Robert Fairlie-Cuninghame
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Temperature history ring buffer
+//
+// A decimated history of the temperature sensor readings is kept so that the host 
+// can read all of the samples since its previous request in a single order (rather 
+// than polling each heater several times a second). Samples are identified by a 16 bit 
+// sequence number which the host uses as its cursor.
+//
+
+#include "temperature_history.h"
+#include "protocol.h"
+#include "response.h"
+
+#include "Minnow.h"
+#include "Device_TemperatureSensor.h"
+#include "Device_Heater.h"
+
+#if (TEMPERATURE_HISTORY_LENGTH & (TEMPERATURE_HISTORY_LENGTH - 1)) != 0 || TEMPERATURE_HISTORY_LENGTH > 128
+  #error TEMPERATURE_HISTORY_LENGTH must be a power of 2 (up to 128)
+#endif
+
+//===========================================================================
+//=============================private variables=============================
+//===========================================================================
+
+struct TemperatureHistorySample
+{
+  uint16_t time; // low 16 bits of millis()
+  uint8_t sensor;
+  uint8_t power; // of the heater using the sensor (0 if none)
+  temperature_t temp;
+};
+
+static TemperatureHistorySample history_buf[TEMPERATURE_HISTORY_LENGTH];
+static uint16_t history_sequence = 0; // sequence number of the next sample recorded
+static uint8_t history_count = 0; // number of samples available in history_buf
+static uint32_t last_history_time = 0;
+
+//===========================================================================
+//============================= ROUTINES =============================
+//===========================================================================
+
+static uint8_t get_sensor_heater_power(uint8_t sensor)
+{
+  for (uint8_t i = 0; i < Device_Heater::GetNumDevices(); i++)
+  {
+    if (Device_Heater::IsInUse(i) && Device_Heater::GetTempSensor(i) == sensor)
+      return Device_Heater::GetHeaterPower(i);
+  }
+  return 0;
+}
+
+void record_temperature_history()
+{
+  const uint32_t now = millis();
+  if (now - last_history_time < TEMPERATURE_HISTORY_INTERVAL)
+    return;
+  last_history_time = now;
+  
+  for (uint8_t sensor = 0; sensor < Device_TemperatureSensor::GetNumDevices(); sensor++)
+  {
+    if (!Device_TemperatureSensor::IsInUse(sensor))
+      continue;
+      
+    TemperatureHistorySample *sample = &history_buf[history_sequence & (TEMPERATURE_HISTORY_LENGTH - 1)];
+    sample->time = (uint16_t)now;
+    sample->sensor = sensor;
+    sample->power = get_sensor_heater_power(sensor);
+    sample->temp = Device_TemperatureSensor::ReadCurrentTemperature(sensor);
+    history_sequence++;
+    if (history_count < TEMPERATURE_HISTORY_LENGTH)
+      history_count++;
+  }
+}
+
+void handle_temperature_history_request(uint16_t cursor)
+{
+  // samples which have been overwritten since the cursor are reported as lost
+  uint16_t available = history_sequence - cursor;
+  uint16_t lost = 0;
+  if ((int16_t)available < 0)
+  {
+    // a cursor ahead of the history (e.g., from before a reset) starts from the
+    // oldest sample without reporting any as lost
+    available = history_count;
+    cursor = history_sequence - history_count;
+  }
+  else if (available > history_count)
+  {
+    lost = available - history_count;
+    available = history_count;
+    cursor = history_sequence - history_count;
+  }
+  
+  generate_response_start(RSP_OK);
+  
+  // send as many samples as fit in the response (the host continues from the returned cursor)
+  const uint8_t max_samples = (generate_response_data_len() - 4) / PM_TEMPERATURE_HISTORY_SAMPLE_SIZE;
+  const uint8_t num_samples = (available < max_samples) ? available : max_samples;
+  
+  generate_response_data_add((uint16_t)(cursor + num_samples));
+  generate_response_data_add(lost);
+  for (uint8_t i = 0; i < num_samples; i++)
+  {
+    const TemperatureHistorySample *sample = &history_buf[(cursor + i) & (TEMPERATURE_HISTORY_LENGTH - 1)];
+    const int16_t temp = (sample->temp != SENSOR_TEMPERATURE_INVALID) 
+        ? temperature_to_decidegrees(sample->temp) : PM_TEMPERATURE_INVALID;
+    generate_response_data_add(sample->time);
+    generate_response_data_addbyte(sample->sensor);
+    generate_response_data_add(temp);
+    generate_response_data_addbyte(sample->power);
+  }
+  generate_response_send();
+}
@@ -0,0 +1,43 @@
+/*
+ Minnow Pacemaker client firmware.
+    
+ Copyright (C) 2013 Robert Fairlie-Cuninghame
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Temperature history ring buffer
+//
+
+#ifndef TEMPERATURE_HISTORY_H
+#define TEMPERATURE_HISTORY_H
+
+#include <stdint.h>
+
+//
+// Records a sample of each temperature sensor (and the power level of the heater 
+// using the sensor) if TEMPERATURE_HISTORY_INTERVAL has passed since the last samples.
+// The samples of all sensors share one ring of TEMPERATURE_HISTORY_LENGTH samples.
+//
+// This must only be called from the main loop.
+//
+void record_temperature_history();
+
+//
+// Sends the samples recorded since the given cursor (see ORDER_READ_TEMPERATURE_HISTORY).
+//
+void handle_temperature_history_request(uint16_t cursor);
+
+#endif
@@ -44,7 +44,11 @@
 // 55 is 100k thermistor - ATC Semitec 104GT-2 (Used in ParCan) (1k pullup)
 
 // If you need to reduce the code size you can disable unneeded thermistor types
-// (they use around 130-250 bytes of code space each)
+// (they use around 290-1260 bytes of code space each). All of them can be disabled
+// if only parametric thermistors (type 99) are used.
+// Note: the indexed tables are about 2.5 times the size of the source tables (8 bytes
+// per segment plus a 128 byte index, in total about 5KB more for all of the types) 
+// which is the cost of converting without a search or a division.
 #define ENABLE_THERMISTOR_TYPE_1    1
 #define ENABLE_THERMISTOR_TYPE_2    1
 #define ENABLE_THERMISTOR_TYPE_3    1
@@ -64,6 +68,24 @@
 #define TT_NAME(_N) _TT_NAME(_N)
 #define _TT_NAME(_N) temptable_ ## _N
 
+// The tables below are the source data for thermistortables_indexed.h (generated by 
+// generate_thermistor_tables.py) which is what the firmware actually uses for conversion. 
+// Each table row becomes a segment with a precomputed slope and a uniform index maps 
+// (raw value >> THERMISTOR_INDEX_SHIFT) to the first candidate segment.
+struct ThermistorSegment
+{
+  int16_t raw;
+  int16_t temp; // degrees C at raw
+  int32_t slope; // degrees C per raw unit (16.16 fixed point)
+};
+
+#define THERMISTOR_INDEX_SHIFT 7
+
+#define TT_SEGMENTS(_N) _TT_SEGMENTS(_N)
+#define _TT_SEGMENTS(_N) thermistor_segments_ ## _N
+#define TT_INDEX(_N) _TT_INDEX(_N)
+#define _TT_INDEX(_N) thermistor_index_ ## _N
+
 #define ADC_OCSC_FAULT_MARGIN   (4*OVERSAMPLENR)  // Open-circuit/ short-circuit measurement margin
 
 #define THERMISTOR_RAW_HI_TEMP (0+ADC_OCSC_FAULT_MARGIN)
@@ -849,5 +871,6 @@ const int16_t temptable_60[][2] PROGMEM = {
 };
 #endif //ENABLE_THERMISTOR_TYPE_60
 
+#include "thermistortables_indexed.h"
 
 #endif //THERMISTORTABLES_H_
@@ -0,0 +1,933 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Generated by generate_thermistor_tables.py from thermistortables.h - do not edit.
+
+#ifndef THERMISTORTABLES_INDEXED_H_
+#define THERMISTORTABLES_INDEXED_H_
+
+#if OVERSAMPLENR != 16 || THERMISTOR_INDEX_SHIFT != 7
+  #error thermistortables_indexed.h is out of date, re-run generate_thermistor_tables.py
+#endif
+
+#if ENABLE_THERMISTOR_TYPE_1
+const ThermistorSegment thermistor_segments_1[] PROGMEM = {
+  {   368,  300,   -10240 },
+  {   400,  295,   -10240 },
+  {   432,  290,   -20480 },
+  {   448,  285,    -6827 },
+  {   496,  280,   -10240 },
+  {   528,  275,   -10240 },
+  {   560,  270,    -6827 },
+  {   608,  265,    -6827 },
+  {   656,  260,    -6827 },
+  {   704,  255,    -5120 },
+  {   768,  250,    -5120 },
+  {   832,  245,    -5120 },
+  {   896,  240,    -4096 },
+  {   976,  235,    -4096 },
+  {  1056,  230,    -4096 },
+  {  1136,  225,    -2926 },
+  {  1248,  220,    -3413 },
+  {  1344,  215,    -2560 },
+  {  1472,  210,    -2560 },
+  {  1600,  205,    -2276 },
+  {  1744,  200,    -1862 },
+  {  1920,  195,    -1862 },
+  {  2096,  190,    -1707 },
+  {  2288,  185,    -1575 },
+  {  2496,  180,    -1365 },
+  {  2736,  175,    -1280 },
+  {  2992,  170,    -1138 },
+  {  3280,  165,    -1078 },
+  {  3584,  160,     -975 },
+  {  3920,  155,     -890 },
+  {  4288,  150,     -819 },
+  {  4688,  145,     -759 },
+  {  5120,  140,     -731 },
+  {  5568,  135,     -661 },
+  {  6064,  130,     -640 },
+  {  6576,  125,     -602 },
+  {  7120,  120,     -585 },
+  {  7680,  115,     -569 },
+  {  8256,  110,     -554 },
+  {  8848,  105,     -539 },
+  {  9456,  100,     -554 },
+  { 10048,   95,     -554 },
+  { 10640,   90,     -554 },
+  { 11232,   85,     -585 },
+  { 11792,   80,     -621 },
+  { 12320,   75,     -661 },
+  { 12816,   70,     -706 },
+  { 13280,   65,     -759 },
+  { 13712,   60,     -853 },
+  { 14096,   55,     -931 },
+  { 14448,   50,    -1078 },
+  { 14752,   45,    -1205 },
+  { 15024,   40,    -1365 },
+  { 15264,   35,    -1707 },
+  { 15456,   30,    -1862 },
+  { 15632,   25,    -2560 },
+  { 15760,   20,    -2560 },
+  { 15888,   15,    -3413 },
+  { 15984,   10,    -4096 },
+  { 16064,    5,    -5120 },
+  { 16128,    0,        0 },
+};
+const uint8_t thermistor_index_1[] PROGMEM = {
+    0,   0,   0,   0,   4,   7,  10,  12,  13,  15,  16,  17,  18,  19,  20,  21,
+   21,  22,  23,  23,  24,  24,  25,  25,  26,  26,  27,  27,  28,  28,  28,  29,
+   29,  29,  30,  30,  30,  31,  31,  31,  32,  32,  32,  32,  33,  33,  33,  33,
+   34,  34,  34,  34,  35,  35,  35,  35,  36,  36,  36,  36,  37,  37,  37,  37,
+   37,  38,  38,  38,  38,  38,  39,  39,  39,  39,  40,  40,  40,  40,  40,  41,
+   41,  41,  41,  41,  42,  42,  42,  42,  43,  43,  43,  43,  43,  44,  44,  44,
+   44,  45,  45,  45,  45,  46,  46,  46,  47,  47,  47,  47,  48,  48,  48,  49,
+   49,  50,  50,  50,  51,  51,  52,  52,  53,  54,  54,  55,  56,  58,  60,  60,
+};
+#endif //ENABLE_THERMISTOR_TYPE_1
+
+#if ENABLE_THERMISTOR_TYPE_2
+const ThermistorSegment thermistor_segments_2[] PROGMEM = {
+  {    16,  848,   -77400 },
+  {   480,  300,   -10240 },
+  {   544,  290,    -8192 },
+  {   624,  280,    -5851 },
+  {   736,  270,    -5851 },
+  {   848,  260,    -4096 },
+  {  1008,  250,    -3724 },
+  {  1184,  240,    -3151 },
+  {  1392,  230,    -2409 },
+  {  1664,  220,    -2048 },
+  {  1984,  210,    -1707 },
+  {  2368,  200,    -1463 },
+  {  2816,  190,    -1170 },
+  {  3376,  180,     -999 },
+  {  4032,  170,     -836 },
+  {  4816,  160,     -731 },
+  {  5712,  150,     -650 },
+  {  6720,  140,     -594 },
+  {  7824,  130,     -561 },
+  {  8992,  120,     -554 },
+  { 10176,  110,     -569 },
+  { 11328,  100,     -611 },
+  { 12400,   90,     -683 },
+  { 13360,   80,     -836 },
+  { 14144,   70,    -1024 },
+  { 14784,   60,    -1321 },
+  { 15280,   50,    -1862 },
+  { 15632,   40,    -2560 },
+  { 15888,   30,    -3724 },
+  { 16064,   20,    -5120 },
+  { 16192,   10,   -10240 },
+  { 16256,    0,        0 },
+};
+const uint8_t thermistor_index_2[] PROGMEM = {
+    0,   0,   0,   0,   1,   3,   4,   5,   6,   6,   7,   8,   8,   9,   9,   9,
+   10,  10,  10,  11,  11,  11,  12,  12,  12,  12,  12,  13,  13,  13,  13,  13,
+   14,  14,  14,  14,  14,  14,  15,  15,  15,  15,  15,  15,  15,  16,  16,  16,
+   16,  16,  16,  16,  16,  17,  17,  17,  17,  17,  17,  17,  17,  17,  18,  18,
+   18,  18,  18,  18,  18,  18,  18,  19,  19,  19,  19,  19,  19,  19,  19,  19,
+   20,  20,  20,  20,  20,  20,  20,  20,  20,  21,  21,  21,  21,  21,  21,  21,
+   21,  22,  22,  22,  22,  22,  22,  22,  22,  23,  23,  23,  23,  23,  23,  24,
+   24,  24,  24,  24,  25,  25,  25,  25,  26,  26,  26,  27,  27,  28,  29,  31,
+};
+#endif //ENABLE_THERMISTOR_TYPE_2
+
+#if ENABLE_THERMISTOR_TYPE_3
+const ThermistorSegment thermistor_segments_3[] PROGMEM = {
+  {    16,  864,  -115507 },
+  {   336,  300,   -10240 },
+  {   400,  290,   -10240 },
+  {   464,  280,   -10240 },
+  {   528,  270,    -6827 },
+  {   624,  260,    -5851 },
+  {   736,  250,    -5120 },
+  {   864,  240,    -4096 },
+  {  1024,  230,    -3724 },
+  {  1200,  220,    -2731 },
+  {  1440,  210,    -2409 },
+  {  1712,  200,    -1950 },
+  {  2048,  190,    -1575 },
+  {  2464,  180,    -1365 },
+  {  2944,  170,    -1107 },
+  {  3536,  160,     -931 },
+  {  4240,  150,     -803 },
+  {  5056,  140,     -694 },
+  {  6000,  130,     -621 },
+  {  7056,  120,     -569 },
+  {  8208,  110,     -546 },
+  {  9408,  100,     -561 },
+  { 11744,   80,     -671 },
+  { 13696,   60,     -999 },
+  { 15008,   40,    -1707 },
+  { 15776,   20,    -3724 },
+  { 16128,    0,    -8192 },
+  { 16288,  -20,        0 },
+};
+const uint8_t thermistor_index_3[] PROGMEM = {
+    0,   0,   0,   1,   3,   5,   6,   7,   8,   8,   9,   9,  10,  10,  11,  11,
+   12,  12,  12,  12,  13,  13,  13,  14,  14,  14,  14,  14,  15,  15,  15,  15,
+   15,  15,  16,  16,  16,  16,  16,  16,  17,  17,  17,  17,  17,  17,  17,  18,
+   18,  18,  18,  18,  18,  18,  18,  18,  19,  19,  19,  19,  19,  19,  19,  19,
+   19,  20,  20,  20,  20,  20,  20,  20,  20,  20,  21,  21,  21,  21,  21,  21,
+   21,  21,  21,  21,  21,  21,  21,  21,  21,  21,  21,  21,  22,  22,  22,  22,
+   22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  23,  23,  23,  23,  23,
+   23,  23,  23,  23,  23,  23,  24,  24,  24,  24,  24,  24,  25,  25,  26,  26,
+};
+#endif //ENABLE_THERMISTOR_TYPE_3
+
+#if ENABLE_THERMISTOR_TYPE_4
+const ThermistorSegment thermistor_segments_4[] PROGMEM = {
+  {    16,  430,   -22644 },
+  {   864,  137,    -2318 },
+  {  1712,  107,    -1237 },
+  {  2560,   91,     -850 },
+  {  3408,   80,     -696 },
+  {  4256,   71,     -541 },
+  {  5104,   64,     -541 },
+  {  5952,   57,     -464 },
+  {  6800,   51,     -386 },
+  {  7648,   46,     -386 },
+  {  8496,   41,     -464 },
+  {  9344,   35,     -386 },
+  { 10192,   30,     -386 },
+  { 11040,   25,     -386 },
+  { 11888,   20,     -464 },
+  { 12736,   14,     -541 },
+  { 13584,    7,     -541 },
+  { 14432,    0,     -850 },
+  { 15280,  -11,    -1855 },
+  { 16128,  -35,        0 },
+};
+const uint8_t thermistor_index_4[] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   2,   2,
+    2,   2,   2,   2,   3,   3,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,
+    4,   4,   5,   5,   5,   5,   5,   5,   6,   6,   6,   6,   6,   6,   6,   7,
+    7,   7,   7,   7,   7,   7,   8,   8,   8,   8,   8,   8,   9,   9,   9,   9,
+    9,   9,   9,  10,  10,  10,  10,  10,  10,  11,  11,  11,  11,  11,  11,  11,
+   12,  12,  12,  12,  12,  12,  12,  13,  13,  13,  13,  13,  13,  14,  14,  14,
+   14,  14,  14,  14,  15,  15,  15,  15,  15,  15,  15,  16,  16,  16,  16,  16,
+   16,  17,  17,  17,  17,  17,  17,  17,  18,  18,  18,  18,  18,  18,  19,  19,
+};
+#endif //ENABLE_THERMISTOR_TYPE_4
+
+#if ENABLE_THERMISTOR_TYPE_5
+const ThermistorSegment thermistor_segments_5[] PROGMEM = {
+  {    16,  713,  -105728 },
+  {   272,  300,   -13653 },
+  {   320,  290,   -13653 },
+  {   368,  280,   -10240 },
+  {   432,  270,   -10240 },
+  {   496,  260,    -6827 },
+  {   592,  250,    -6827 },
+  {   688,  240,    -5120 },
+  {   816,  230,    -4096 },
+  {   976,  220,    -3413 },
+  {  1168,  210,    -2926 },
+  {  1392,  200,    -2156 },
+  {  1696,  190,    -1862 },
+  {  2048,  180,    -1517 },
+  {  2480,  170,    -1205 },
+  {  3024,  160,     -999 },
+  {  3680,  150,     -853 },
+  {  4448,  140,     -706 },
+  {  5376,  130,     -621 },
+  {  6432,  120,     -554 },
+  {  7616,  110,     -525 },
+  {  8864,  100,     -506 },
+  { 10160,   90,     -525 },
+  { 11408,   80,     -577 },
+  { 12544,   70,     -661 },
+  { 13536,   60,     -803 },
+  { 14352,   50,    -1024 },
+  { 14992,   40,    -1412 },
+  { 15456,   30,    -2048 },
+  { 15776,   20,    -2926 },
+  { 16000,   10,    -4096 },
+  { 16160,    0,        0 },
+};
+const uint8_t thermistor_index_5[] PROGMEM = {
+    0,   0,   0,   3,   5,   6,   7,   8,   9,   9,  10,  11,  11,  11,  12,  12,
+   13,  13,  13,  13,  14,  14,  14,  14,  15,  15,  15,  15,  15,  16,  16,  16,
+   16,  16,  16,  17,  17,  17,  17,  17,  17,  17,  18,  18,  18,  18,  18,  18,
+   18,  18,  18,  19,  19,  19,  19,  19,  19,  19,  19,  19,  20,  20,  20,  20,
+   20,  20,  20,  20,  20,  20,  21,  21,  21,  21,  21,  21,  21,  21,  21,  21,
+   22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  23,  23,  23,  23,  23,  23,
+   23,  23,  24,  24,  24,  24,  24,  24,  24,  24,  25,  25,  25,  25,  25,  25,
+   25,  26,  26,  26,  26,  26,  27,  27,  27,  28,  28,  28,  29,  30,  30,  31,
+};
+#endif //ENABLE_THERMISTOR_TYPE_5
+
+#if ENABLE_THERMISTOR_TYPE_6
+const ThermistorSegment thermistor_segments_6[] PROGMEM = {
+  {    16,  350,   -15170 },
+  {   448,  250,    -6827 },
+  {   496,  245,    -5120 },
+  {   560,  240,    -5120 },
+  {   624,  235,    -6827 },
+  {   672,  230,   -10240 },
+  {   704,  225,    -4096 },
+  {   784,  220,    -5120 },
+  {   848,  215,    -2276 },
+  {   992,  210,    -2276 },
+  {  1136,  205,    -2926 },
+  {  1248,  200,    -2560 },
+  {  1504,  190,    -2560 },
+  {  1632,  185,    -4389 },
+  {  1856,  170,    -1517 },
+  {  2288,  160,    -1024 },
+  {  2928,  150,    -1024 },
+  {  3568,  140,     -871 },
+  {  4320,  130,     -853 },
+  {  5088,  120,     -630 },
+  {  6128,  110,     -683 },
+  {  6608,  105,     -788 },
+  {  7024,  100,     -455 },
+  {  7744,   95,     -706 },
+  {  8208,   90,     -436 },
+  {  9712,   80,     -719 },
+  { 10624,   70,     -350 },
+  { 12496,   60,     -706 },
+  { 12960,   55,     -525 },
+  { 13584,   50,     -315 },
+  { 14624,   45,        0 },
+  { 14624,   40,     -975 },
+  { 14960,   35,    -1078 },
+  { 15264,   30,    -1280 },
+  { 15520,   25,    -1536 },
+  { 15648,   22,    -2594 },
+  { 16128,    3,     -819 },
+  { 16368,    0,        0 },
+};
+const uint8_t thermistor_index_6[] PROGMEM = {
+    0,   0,   0,   0,   2,   4,   6,   8,   9,  10,  11,  11,  12,  13,  13,  14,
+   14,  14,  15,  15,  15,  15,  15,  16,  16,  16,  16,  16,  17,  17,  17,  17,
+   17,  17,  18,  18,  18,  18,  18,  18,  19,  19,  19,  19,  19,  19,  19,  19,
+   20,  20,  20,  20,  21,  21,  21,  22,  22,  22,  22,  22,  22,  23,  23,  23,
+   23,  24,  24,  24,  24,  24,  24,  24,  24,  24,  24,  24,  25,  25,  25,  25,
+   25,  25,  25,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  27,  27,  27,  27,  28,  28,  28,  28,  28,  29,  29,  29,  29,  29,
+   29,  29,  29,  31,  31,  32,  32,  32,  33,  33,  34,  35,  35,  35,  36,  36,
+};
+#endif //ENABLE_THERMISTOR_TYPE_6
+
+#if ENABLE_THERMISTOR_TYPE_7
+const ThermistorSegment thermistor_segments_7[] PROGMEM = {
+  {    16,  941,  -131755 },
+  {   304,  362,   -14336 },
+  {   592,  299,    -7509 },
+  {   880,  266,    -4779 },
+  {  1168,  245,    -3641 },
+  {  1456,  229,    -2958 },
+  {  1744,  216,    -2276 },
+  {  2032,  206,    -2048 },
+  {  2320,  197,    -1593 },
+  {  2608,  190,    -1593 },
+  {  2896,  183,    -1365 },
+  {  3184,  177,    -1365 },
+  {  3472,  171,    -1138 },
+  {  3760,  166,     -910 },
+  {  4048,  162,    -1138 },
+  {  4336,  157,     -910 },
+  {  4624,  153,     -910 },
+  {  4912,  149,     -683 },
+  {  5200,  146,     -910 },
+  {  5488,  142,     -683 },
+  {  5776,  139,     -910 },
+  {  6064,  135,     -683 },
+  {  6352,  132,     -683 },
+  {  6640,  129,     -683 },
+  {  6928,  126,     -683 },
+  {  7216,  123,     -455 },
+  {  7504,  121,     -683 },
+  {  7792,  118,     -683 },
+  {  8080,  115,     -683 },
+  {  8368,  112,     -455 },
+  {  8656,  110,     -683 },
+  {  8944,  107,     -455 },
+  {  9232,  105,     -683 },
+  {  9520,  102,     -683 },
+  {  9808,   99,     -455 },
+  { 10096,   97,     -683 },
+  { 10384,   94,     -455 },
+  { 10672,   92,     -683 },
+  { 10960,   89,     -683 },
+  { 11248,   86,     -455 },
+  { 11536,   84,     -683 },
+  { 11824,   81,     -683 },
+  { 12112,   78,     -683 },
+  { 12400,   75,     -683 },
+  { 12688,   72,     -683 },
+  { 12976,   69,     -683 },
+  { 13264,   66,     -910 },
+  { 13552,   62,     -683 },
+  { 13840,   59,     -910 },
+  { 14128,   55,     -910 },
+  { 14416,   51,    -1138 },
+  { 14704,   46,    -1138 },
+  { 14992,   41,    -1365 },
+  { 15280,   35,    -1820 },
+  { 15568,   27,    -2276 },
+  { 15856,   17,    -3641 },
+  { 16144,    1,     -293 },
+  { 16368,    0,        0 },
+};
+const uint8_t thermistor_index_7[] PROGMEM = {
+    0,   0,   0,   1,   1,   2,   2,   3,   3,   3,   4,   4,   5,   5,   6,   6,
+    7,   7,   7,   8,   8,   9,   9,  10,  10,  11,  11,  11,  12,  12,  13,  13,
+   14,  14,  15,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,  19,  20,  20,
+   21,  21,  22,  22,  23,  23,  23,  24,  24,  25,  25,  26,  26,  27,  27,  27,
+   28,  28,  29,  29,  30,  30,  31,  31,  31,  32,  32,  33,  33,  34,  34,  35,
+   35,  35,  36,  36,  37,  37,  38,  38,  39,  39,  39,  40,  40,  41,  41,  42,
+   42,  43,  43,  43,  44,  44,  45,  45,  46,  46,  47,  47,  47,  48,  48,  49,
+   49,  50,  50,  51,  51,  51,  52,  52,  53,  53,  54,  54,  55,  55,  55,  56,
+};
+#endif //ENABLE_THERMISTOR_TYPE_7
+
+#if ENABLE_THERMISTOR_TYPE_71
+const ThermistorSegment thermistor_segments_71[] PROGMEM = {
+  {   560,  300,    -7680 },
+  {   816,  270,    -6827 },
+  {   864,  265,    -5120 },
+  {   928,  260,    -8192 },
+  {   944,  258,    -4096 },
+  {   976,  256,    -4096 },
+  {  1008,  254,    -8192 },
+  {  1024,  252,    -4096 },
+  {  1056,  250,    -4096 },
+  {  1072,  249,    -4096 },
+  {  1088,  248,    -4096 },
+  {  1104,  247,    -4096 },
+  {  1120,  246,    -4096 },
+  {  1136,  245,    -4096 },
+  {  1152,  244,    -4096 },
+  {  1168,  243,    -4096 },
+  {  1184,  242,    -4096 },
+  {  1200,  241,    -4096 },
+  {  1216,  240,    -4096 },
+  {  1232,  239,    -4096 },
+  {  1248,  238,    -4096 },
+  {  1264,  237,    -4096 },
+  {  1280,  236,    -4096 },
+  {  1296,  235,    -4096 },
+  {  1312,  234,    -2048 },
+  {  1344,  233,    -4096 },
+  {  1360,  232,    -4096 },
+  {  1376,  231,    -4096 },
+  {  1392,  230,    -2048 },
+  {  1424,  229,    -4096 },
+  {  1440,  228,    -4096 },
+  {  1456,  227,    -4096 },
+  {  1472,  226,    -2048 },
+  {  1504,  225,    -4096 },
+  {  1520,  224,    -2048 },
+  {  1552,  223,    -4096 },
+  {  1568,  222,    -4096 },
+  {  1584,  221,    -2048 },
+  {  1616,  220,    -4096 },
+  {  1632,  219,    -2048 },
+  {  1664,  218,    -2048 },
+  {  1696,  217,    -4096 },
+  {  1712,  216,    -2048 },
+  {  1744,  215,    -4096 },
+  {  1760,  214,    -2048 },
+  {  1792,  213,    -2048 },
+  {  1824,  212,    -4096 },
+  {  1840,  211,    -2048 },
+  {  1872,  210,    -2048 },
+  {  1904,  209,    -2048 },
+  {  1936,  208,    -2048 },
+  {  1968,  207,    -2048 },
+  {  2000,  206,    -4096 },
+  {  2016,  205,    -2048 },
+  {  2048,  204,    -2048 },
+  {  2080,  203,    -2048 },
+  {  2112,  202,    -2048 },
+  {  2144,  201,    -2048 },
+  {  2176,  200,    -1365 },
+  {  2224,  199,    -2048 },
+  {  2256,  198,    -2048 },
+  {  2288,  197,    -2048 },
+  {  2320,  196,    -2048 },
+  {  2352,  195,    -1365 },
+  {  2400,  194,    -2048 },
+  {  2432,  193,    -2048 },
+  {  2464,  192,    -1365 },
+  {  2512,  191,    -2048 },
+  {  2544,  190,    -1365 },
+  {  2592,  189,    -2048 },
+  {  2624,  188,    -1365 },
+  {  2672,  187,    -1365 },
+  {  2720,  186,    -2048 },
+  {  2752,  185,    -1365 },
+  {  2800,  184,    -1365 },
+  {  2848,  183,    -1365 },
+  {  2896,  182,    -1365 },
+  {  2944,  181,    -1365 },
+  {  2992,  180,    -1365 },
+  {  3040,  179,    -1365 },
+  {  3088,  178,    -1365 },
+  {  3136,  177,    -1365 },
+  {  3184,  176,    -1365 },
+  {  3232,  175,    -1365 },
+  {  3280,  174,    -1365 },
+  {  3328,  173,    -1024 },
+  {  3392,  172,    -1365 },
+  {  3440,  171,    -1024 },
+  {  3504,  170,    -1138 },
+  {  3792,  165,    -1078 },
+  {  4096,  160,     -931 },
+  {  4800,  150,     -803 },
+  {  5616,  140,     -688 },
+  {  7520,  120,     -602 },
+  {  8064,  115,     -602 },
+  {  8608,  110,     -585 },
+  {  8832,  108,     -585 },
+  {  9056,  106,     -585 },
+  {  9280,  104,     -585 },
+  {  9504,  102,     -585 },
+  {  9728,  100,     -585 },
+  {  9952,   98,     -585 },
+  { 10176,   96,     -585 },
+  { 10400,   94,     -585 },
+  { 10624,   92,     -585 },
+  { 10848,   90,     -602 },
+  { 11392,   85,     -621 },
+  { 11920,   80,     -630 },
+  { 12128,   78,     -683 },
+  { 12320,   76,     -630 },
+  { 12528,   74,     -683 },
+  { 12720,   72,     -745 },
+  { 12896,   70,     -683 },
+  { 13088,   68,     -745 },
+  { 13264,   66,     -745 },
+  { 13440,   64,     -819 },
+  { 13600,   62,     -819 },
+  { 13760,   60,     -819 },
+  { 13920,   58,     -910 },
+  { 14064,   56,     -910 },
+  { 14208,   54,     -910 },
+  { 14352,   52,    -1024 },
+  { 14480,   50,    -1078 },
+  { 14784,   45,    -1280 },
+  { 15040,   40,    -1365 },
+  { 15280,   35,    -1707 },
+  { 15472,   30,    -1365 },
+  { 15520,   29,    -2048 },
+  { 15552,   28,    -2048 },
+  { 15584,   27,    -2048 },
+  { 15616,   26,    -2048 },
+  { 15648,   25,    -2048 },
+  { 15680,   24,    -2048 },
+  { 15712,   23,    -2048 },
+  { 15744,   22,    -4096 },
+  { 15760,   21,    -2048 },
+  { 15792,   20,    -2560 },
+  { 15920,   15,    -3413 },
+  { 16016,   10,    -4096 },
+  { 16096,    5,    -5120 },
+  { 16160,    0,        0 },
+};
+const uint8_t thermistor_index_71[] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   2,   7,  14,  22,  28,  34,  40,  45,  49,
+   54,  58,  61,  65,  68,  71,  74,  77,  79,  82,  85,  87,  88,  88,  89,  89,
+   90,  90,  90,  90,  90,  90,  91,  91,  91,  91,  91,  91,  92,  92,  92,  92,
+   92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  93,  93,  93,  93,  94,
+   94,  94,  94,  94,  95,  96,  96,  97,  97,  98,  98,  99, 100, 100, 101, 101,
+  102, 102, 103, 104, 104, 105, 105, 105, 105, 106, 106, 106, 106, 106, 107, 108,
+  108, 109, 110, 110, 111, 112, 112, 113, 114, 115, 115, 116, 117, 118, 119, 120,
+  120, 121, 122, 122, 123, 123, 124, 124, 125, 126, 130, 134, 136, 137, 139, 140,
+};
+#endif //ENABLE_THERMISTOR_TYPE_71
+
+#if ENABLE_THERMISTOR_TYPE_8
+const ThermistorSegment thermistor_segments_8[] PROGMEM = {
+  {    16,  704,   -37714 },
+  {   864,  216,    -3169 },
+  {  1712,  175,    -1778 },
+  {  2560,  152,    -1159 },
+  {  3408,  137,     -927 },
+  {  4256,  125,     -773 },
+  {  5104,  115,     -696 },
+  {  5952,  106,     -541 },
+  {  6800,   99,     -618 },
+  {  7648,   91,     -464 },
+  {  8496,   85,     -541 },
+  {  9344,   78,     -541 },
+  { 10192,   71,     -464 },
+  { 11040,   65,     -541 },
+  { 11888,   58,     -618 },
+  { 12736,   50,     -618 },
+  { 13584,   42,     -850 },
+  { 14432,   31,    -1082 },
+  { 15280,   17,    -1314 },
+  { 16128,    0,        0 },
+};
+const uint8_t thermistor_index_8[] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   2,   2,
+    2,   2,   2,   2,   3,   3,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,
+    4,   4,   5,   5,   5,   5,   5,   5,   6,   6,   6,   6,   6,   6,   6,   7,
+    7,   7,   7,   7,   7,   7,   8,   8,   8,   8,   8,   8,   9,   9,   9,   9,
+    9,   9,   9,  10,  10,  10,  10,  10,  10,  11,  11,  11,  11,  11,  11,  11,
+   12,  12,  12,  12,  12,  12,  12,  13,  13,  13,  13,  13,  13,  14,  14,  14,
+   14,  14,  14,  14,  15,  15,  15,  15,  15,  15,  15,  16,  16,  16,  16,  16,
+   16,  17,  17,  17,  17,  17,  17,  17,  18,  18,  18,  18,  18,  18,  19,  19,
+};
+#endif //ENABLE_THERMISTOR_TYPE_8
+
+#if ENABLE_THERMISTOR_TYPE_9
+const ThermistorSegment thermistor_segments_9[] PROGMEM = {
+  {    16,  936,   -74430 },
+  {   576,  300,    -6320 },
+  {  1136,  246,    -3277 },
+  {  1696,  218,    -2224 },
+  {  2256,  199,    -1638 },
+  {  2816,  185,    -1404 },
+  {  3376,  173,    -1170 },
+  {  3936,  163,     -936 },
+  {  4496,  155,     -936 },
+  {  5056,  147,     -819 },
+  {  5616,  140,     -702 },
+  {  6176,  134,     -702 },
+  {  6736,  128,     -702 },
+  {  7296,  122,     -585 },
+  {  7856,  117,     -585 },
+  {  8416,  112,     -585 },
+  {  8976,  107,     -585 },
+  {  9536,  102,     -585 },
+  { 10096,   97,     -585 },
+  { 10656,   92,     -585 },
+  { 11216,   87,     -702 },
+  { 11776,   81,     -585 },
+  { 12336,   76,     -702 },
+  { 12896,   70,     -819 },
+  { 13456,   63,     -819 },
+  { 14016,   56,     -936 },
+  { 14576,   48,    -1170 },
+  { 15136,   38,    -1755 },
+  { 15696,   23,    -3072 },
+  { 16080,    5,    -1862 },
+  { 16256,    0,        0 },
+};
+const uint8_t thermistor_index_9[] PROGMEM = {
+    0,   0,   0,   0,   0,   1,   1,   1,   1,   2,   2,   2,   2,   2,   3,   3,
+    3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,   6,   6,   7,
+    7,   7,   7,   7,   8,   8,   8,   8,   9,   9,   9,   9,  10,  10,  10,  10,
+   10,  11,  11,  11,  11,  12,  12,  12,  12,  13,  13,  13,  13,  13,  14,  14,
+   14,  14,  15,  15,  15,  15,  15,  16,  16,  16,  16,  17,  17,  17,  17,  18,
+   18,  18,  18,  18,  19,  19,  19,  19,  20,  20,  20,  20,  21,  21,  21,  21,
+   21,  22,  22,  22,  22,  23,  23,  23,  23,  23,  24,  24,  24,  24,  25,  25,
+   25,  25,  26,  26,  26,  26,  26,  27,  27,  27,  27,  28,  28,  28,  29,  30,
+};
+#endif //ENABLE_THERMISTOR_TYPE_9
+
+#if ENABLE_THERMISTOR_TYPE_10
+const ThermistorSegment thermistor_segments_10[] PROGMEM = {
+  {    16,  929,   -73728 },
+  {   576,  299,    -6203 },
+  {  1136,  246,    -3394 },
+  {  1696,  217,    -2224 },
+  {  2256,  198,    -1638 },
+  {  2816,  184,    -1287 },
+  {  3376,  173,    -1170 },
+  {  3936,  163,    -1053 },
+  {  4496,  154,     -819 },
+  {  5056,  147,     -819 },
+  {  5616,  140,     -702 },
+  {  6176,  134,     -702 },
+  {  6736,  128,     -702 },
+  {  7296,  122,     -585 },
+  {  7856,  117,     -585 },
+  {  8416,  112,     -585 },
+  {  8976,  107,     -585 },
+  {  9536,  102,     -585 },
+  { 10096,   97,     -702 },
+  { 10656,   91,     -585 },
+  { 11216,   86,     -585 },
+  { 11776,   81,     -585 },
+  { 12336,   76,     -702 },
+  { 12896,   70,     -819 },
+  { 13456,   63,     -819 },
+  { 14016,   56,     -936 },
+  { 14576,   48,    -1170 },
+  { 15136,   38,    -1755 },
+  { 15696,   23,    -3072 },
+  { 16080,    5,    -1862 },
+  { 16256,    0,        0 },
+};
+const uint8_t thermistor_index_10[] PROGMEM = {
+    0,   0,   0,   0,   0,   1,   1,   1,   1,   2,   2,   2,   2,   2,   3,   3,
+    3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,   6,   6,   7,
+    7,   7,   7,   7,   8,   8,   8,   8,   9,   9,   9,   9,  10,  10,  10,  10,
+   10,  11,  11,  11,  11,  12,  12,  12,  12,  13,  13,  13,  13,  13,  14,  14,
+   14,  14,  15,  15,  15,  15,  15,  16,  16,  16,  16,  17,  17,  17,  17,  18,
+   18,  18,  18,  18,  19,  19,  19,  19,  20,  20,  20,  20,  21,  21,  21,  21,
+   21,  22,  22,  22,  22,  23,  23,  23,  23,  23,  24,  24,  24,  24,  25,  25,
+   25,  25,  26,  26,  26,  26,  26,  27,  27,  27,  27,  28,  28,  28,  29,  30,
+};
+#endif //ENABLE_THERMISTOR_TYPE_10
+
+#if ENABLE_THERMISTOR_TYPE_51
+const ThermistorSegment thermistor_segments_51[] PROGMEM = {
+  {    16,  350,    -2167 },
+  {  3040,  250,    -1575 },
+  {  3248,  245,    -1463 },
+  {  3472,  240,    -1365 },
+  {  3712,  235,    -1280 },
+  {  3968,  230,    -1205 },
+  {  4240,  225,    -1138 },
+  {  4528,  220,    -1078 },
+  {  4832,  215,    -1024 },
+  {  5152,  210,     -931 },
+  {  5504,  205,     -931 },
+  {  5856,  200,     -853 },
+  {  6240,  195,     -819 },
+  {  6640,  190,     -819 },
+  {  7040,  185,     -759 },
+  {  7472,  180,     -759 },
+  {  7904,  175,     -731 },
+  {  8352,  170,     -706 },
+  {  8816,  165,     -706 },
+  {  9280,  160,     -706 },
+  {  9744,  155,     -706 },
+  { 10208,  150,     -731 },
+  { 10656,  145,     -706 },
+  { 11120,  140,     -759 },
+  { 11552,  135,     -759 },
+  { 11984,  130,     -788 },
+  { 12400,  125,     -819 },
+  { 12800,  120,     -890 },
+  { 13168,  115,     -931 },
+  { 13520,  110,    -1024 },
+  { 13840,  105,    -1078 },
+  { 14144,  100,    -1205 },
+  { 14416,   95,    -1280 },
+  { 14672,   90,    -1365 },
+  { 14912,   85,    -1707 },
+  { 15104,   80,    -1707 },
+  { 15296,   75,    -2048 },
+  { 15456,   70,    -2276 },
+  { 15600,   65,    -2926 },
+  { 15712,   60,    -2926 },
+  { 15824,   55,    -3413 },
+  { 15920,   50,    -4096 },
+  { 16000,   45,    -5120 },
+  { 16064,   40,    -6827 },
+  { 16112,   35,    -6827 },
+  { 16160,   30,    -6827 },
+  { 16208,   25,   -10240 },
+  { 16240,   20,   -10240 },
+  { 16272,   15,   -20480 },
+  { 16288,   10,   -20480 },
+  { 16304,    5,   -20480 },
+  { 16320,    0,   -20480 },
+  { 16336,   -5,        0 },
+};
+const uint8_t thermistor_index_51[] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   2,   2,   3,   4,   4,   5,
+    5,   5,   6,   6,   7,   7,   8,   8,   8,   9,   9,  10,  10,  10,  11,  11,
+   11,  12,  12,  12,  13,  13,  13,  14,  14,  14,  14,  15,  15,  15,  16,  16,
+   16,  16,  17,  17,  17,  18,  18,  18,  18,  19,  19,  19,  19,  20,  20,  20,
+   21,  21,  21,  21,  22,  22,  22,  23,  23,  23,  23,  24,  24,  24,  25,  25,
+   25,  26,  26,  26,  27,  27,  27,  28,  28,  28,  29,  29,  29,  30,  30,  31,
+   31,  32,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  40,  42,  44,  47,
+};
+#endif //ENABLE_THERMISTOR_TYPE_51
+
+#if ENABLE_THERMISTOR_TYPE_52
+const ThermistorSegment thermistor_segments_52[] PROGMEM = {
+  {    16,  500,    -6606 },
+  {  2000,  300,    -2409 },
+  {  2272,  290,    -2048 },
+  {  2592,  280,    -1781 },
+  {  2960,  270,    -1575 },
+  {  3376,  260,    -1412 },
+  {  3840,  250,    -1205 },
+  {  4384,  240,    -1078 },
+  {  4992,  230,     -953 },
+  {  5680,  220,     -890 },
+  {  6416,  210,     -803 },
+  {  7232,  200,     -759 },
+  {  8096,  190,     -719 },
+  {  9008,  180,     -719 },
+  {  9920,  170,     -719 },
+  { 10832,  160,     -745 },
+  { 11712,  150,     -803 },
+  { 12528,  140,     -871 },
+  { 13280,  130,     -999 },
+  { 13936,  120,    -1170 },
+  { 14496,  110,    -1412 },
+  { 14960,  100,    -1781 },
+  { 15328,   90,    -2276 },
+  { 15616,   80,    -2926 },
+  { 15840,   70,    -4096 },
+  { 16000,   60,    -5120 },
+  { 16128,   50,    -8192 },
+  { 16208,   40,   -10240 },
+  { 16272,   30,   -20480 },
+  { 16304,   20,   -20480 },
+  { 16336,   10,   -40960 },
+  { 16352,    0,        0 },
+};
+const uint8_t thermistor_index_52[] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    1,   1,   2,   2,   2,   3,   3,   3,   4,   4,   4,   5,   5,   5,   6,   6,
+    6,   6,   6,   7,   7,   7,   7,   8,   8,   8,   8,   8,   8,   9,   9,   9,
+    9,   9,   9,  10,  10,  10,  10,  10,  10,  11,  11,  11,  11,  11,  11,  11,
+   12,  12,  12,  12,  12,  12,  12,  13,  13,  13,  13,  13,  13,  13,  14,  14,
+   14,  14,  14,  14,  14,  15,  15,  15,  15,  15,  15,  15,  16,  16,  16,  16,
+   16,  16,  17,  17,  17,  17,  17,  17,  18,  18,  18,  18,  18,  19,  19,  19,
+   19,  19,  20,  20,  20,  21,  21,  21,  22,  22,  23,  23,  24,  25,  26,  27,
+};
+#endif //ENABLE_THERMISTOR_TYPE_52
+
+#if ENABLE_THERMISTOR_TYPE_55
+const ThermistorSegment thermistor_segments_55[] PROGMEM = {
+  {    16,  500,   -10923 },
+  {  1216,  300,    -3724 },
+  {  1392,  290,    -3151 },
+  {  1600,  280,    -2926 },
+  {  1824,  270,    -2409 },
+  {  2096,  260,    -1950 },
+  {  2432,  250,    -1781 },
+  {  2800,  240,    -1517 },
+  {  3232,  230,    -1280 },
+  {  3744,  220,    -1107 },
+  {  4336,  210,     -999 },
+  {  4992,  200,     -871 },
+  {  5744,  190,     -788 },
+  {  6576,  180,     -731 },
+  {  7472,  170,     -683 },
+  {  8432,  160,     -650 },
+  {  9440,  150,     -661 },
+  { 10432,  140,     -671 },
+  { 11408,  130,     -719 },
+  { 12320,  120,     -788 },
+  { 13152,  110,     -910 },
+  { 13872,  100,    -1078 },
+  { 14480,   90,    -1321 },
+  { 14976,   80,    -1638 },
+  { 15376,   70,    -2276 },
+  { 15664,   60,    -2926 },
+  { 15888,   50,    -4096 },
+  { 16048,   40,    -5851 },
+  { 16160,   30,    -8192 },
+  { 16240,   20,   -13653 },
+  { 16288,   10,   -20480 },
+  { 16320,    0,        0 },
+};
+const uint8_t thermistor_index_55[] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   2,   2,   3,   3,   4,
+    4,   5,   5,   6,   6,   6,   7,   7,   7,   7,   8,   8,   8,   8,   9,   9,
+    9,   9,  10,  10,  10,  10,  10,  11,  11,  11,  11,  11,  11,  12,  12,  12,
+   12,  12,  12,  12,  13,  13,  13,  13,  13,  13,  13,  14,  14,  14,  14,  14,
+   14,  14,  15,  15,  15,  15,  15,  15,  15,  15,  16,  16,  16,  16,  16,  16,
+   16,  16,  17,  17,  17,  17,  17,  17,  17,  17,  18,  18,  18,  18,  18,  18,
+   18,  19,  19,  19,  19,  19,  19,  20,  20,  20,  20,  20,  20,  21,  21,  21,
+   21,  21,  22,  22,  22,  23,  23,  23,  23,  24,  24,  25,  25,  26,  27,  29,
+};
+#endif //ENABLE_THERMISTOR_TYPE_55
+
+#if ENABLE_THERMISTOR_TYPE_60
+const ThermistorSegment thermistor_segments_60[] PROGMEM = {
+  {   816,  272,    -5734 },
+  {   976,  258,    -4506 },
+  {  1136,  247,    -4096 },
+  {  1296,  237,    -3277 },
+  {  1456,  229,    -3277 },
+  {  1616,  221,    -2321 },
+  {  2096,  204,    -1911 },
+  {  2576,  190,    -1502 },
+  {  3056,  179,    -1229 },
+  {  3696,  167,    -1024 },
+  {  4336,  157,     -922 },
+  {  4976,  148,     -819 },
+  {  5616,  140,     -683 },
+  {  6096,  135,     -683 },
+  {  6576,  130,     -683 },
+  {  7056,  125,     -819 },
+  {  7216,  123,     -410 },
+  {  7376,  122,     -819 },
+  {  7536,  120,     -410 },
+  {  7696,  119,     -819 },
+  {  7856,  117,     -410 },
+  {  8016,  116,     -819 },
+  {  8176,  114,     -410 },
+  {  8336,  113,     -819 },
+  {  8496,  111,     -410 },
+  {  8656,  110,     -819 },
+  {  8816,  108,     -410 },
+  {  8976,  107,     -819 },
+  {  9136,  105,     -410 },
+  {  9296,  104,     -819 },
+  {  9456,  102,     -410 },
+  {  9616,  101,     -410 },
+  {  9776,  100,     -819 },
+  {  9936,   98,     -410 },
+  { 10096,   97,     -819 },
+  { 10256,   95,     -410 },
+  { 10416,   94,     -819 },
+  { 10576,   92,     -410 },
+  { 10736,   91,     -410 },
+  { 10896,   90,     -819 },
+  { 11056,   88,     -410 },
+  { 11216,   87,     -819 },
+  { 11376,   85,     -410 },
+  { 11536,   84,     -819 },
+  { 11696,   82,     -410 },
+  { 11856,   81,     -819 },
+  { 12016,   79,     -819 },
+  { 12176,   77,     -410 },
+  { 12336,   76,     -819 },
+  { 12496,   74,     -819 },
+  { 12656,   72,     -410 },
+  { 12816,   71,     -819 },
+  { 12976,   69,     -819 },
+  { 13136,   67,     -819 },
+  { 13296,   65,     -819 },
+  { 13456,   63,     -410 },
+  { 13616,   62,     -819 },
+  { 13776,   60,    -1229 },
+  { 13936,   57,     -819 },
+  { 14096,   55,     -819 },
+  { 14256,   53,     -819 },
+  { 14416,   51,    -1229 },
+  { 14576,   48,    -1229 },
+  { 14736,   45,    -1229 },
+  { 14896,   42,    -1229 },
+  { 15056,   39,    -1229 },
+  { 15216,   36,    -1638 },
+  { 15376,   32,    -1843 },
+  { 15696,   23,    -2458 },
+  { 15856,   17,    -3277 },
+  { 16016,    9,    -5266 },
+  { 16128,    0,        0 },
+};
+const uint8_t thermistor_index_60[] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   0,   1,   2,   2,   3,   4,   5,   5,   5,
+    5,   6,   6,   6,   6,   7,   7,   7,   8,   8,   8,   8,   8,   9,   9,   9,
+    9,   9,  10,  10,  10,  10,  10,  11,  11,  11,  11,  11,  12,  12,  12,  12,
+   13,  13,  13,  13,  14,  14,  14,  14,  15,  16,  17,  18,  18,  19,  20,  21,
+   22,  22,  23,  24,  25,  26,  26,  27,  28,  29,  30,  30,  31,  32,  33,  34,
+   34,  35,  36,  37,  38,  38,  39,  40,  41,  42,  42,  43,  44,  45,  46,  46,
+   47,  48,  49,  50,  50,  51,  52,  53,  54,  54,  55,  56,  57,  58,  58,  59,
+   60,  61,  62,  62,  63,  64,  65,  66,  66,  67,  67,  68,  69,  69,  71,  71,
+};
+#endif //ENABLE_THERMISTOR_TYPE_60
+
+#endif //THERMISTORTABLES_INDEXED_H_
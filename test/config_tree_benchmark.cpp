@@ -0,0 +1,175 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Host test and benchmark of the configuration tree name lookup (FindNode). 
+//
+// The tree is populated with a typical printer's devices and every leaf name is 
+// looked up and converted back to its name (also checking that invalid names are 
+// rejected and that a traversal can be resumed from any cursor). The time per 
+// lookup and per full traversal of the leaves is then reported.
+//
+
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ConfigTree.h"
+#include "Device_InputSwitch.h"
+#include "Device_OutputSwitch.h"
+#include "Device_PwmOutput.h"
+#include "Device_Buzzer.h"
+#include "Device_Heater.h"
+#include "Device_Stepper.h"
+#include "Device_TemperatureSensor.h"
+
+#define LOOKUP_REPETITIONS      2000
+#define TRAVERSAL_REPETITIONS   200
+#define CONFIG_NAME_BUFFER_LENGTH 64
+
+// the devices of a typical printer
+uint8_t Device_InputSwitch::num_input_switches = 10;
+uint8_t Device_OutputSwitch::num_output_switches = 8;
+uint8_t Device_PwmOutput::num_pwm_outputs = 4;
+uint8_t Device_Buzzer::num_buzzers = 1;
+uint8_t Device_TemperatureSensor::num_temperature_sensors = 4;
+uint8_t Device_Heater::num_heaters = 3;
+uint8_t Device_Stepper::num_steppers = 5;
+
+static std::vector<std::string> leaf_names;
+
+static void find_leaf_names()
+{
+  ConfigurationTree tree;
+  char name[CONFIG_NAME_BUFFER_LENGTH];
+  for (ConfigurationTreeNode *leaf = tree.FindFirstLeafNode(tree.GetRootNode()); leaf != 0;
+      leaf = tree.FindNextLeafNode(tree.GetRootNode()))
+  {
+    tree.GetFullName(leaf, name, sizeof(name));
+    leaf_names.push_back(name);
+  }
+}
+
+static bool check_lookups()
+{
+  char name[CONFIG_NAME_BUFFER_LENGTH];
+  for (size_t i = 0; i < leaf_names.size(); i++)
+  {
+    ConfigurationTree tree;
+    ConfigurationTreeNode *node = tree.FindNode(leaf_names[i].c_str());
+    if (node == 0 || !node->IsLeafNode())
+    {
+      printf("%s not found\n", leaf_names[i].c_str());
+      return false;
+    }
+    tree.GetFullName(node, name, sizeof(name));
+    if (leaf_names[i] != name)
+    {
+      printf("%s found as %s\n", leaf_names[i].c_str(), name);
+      return false;
+    }
+  }
+  
+  const char *invalid_names[] = { "devices.heater.3.pin", "devices.heater.01.pin", 
+      "devices.heater.1000.pin", "devices.heater.1.pinx", "system.foo", "" };
+  for (size_t i = 0; i < sizeof(invalid_names)/sizeof(invalid_names[0]); i++)
+  {
+    ConfigurationTree tree;
+    ConfigurationTreeNode *node = tree.FindNode(invalid_names[i]);
+    if (node != 0 && node->IsLeafNode())
+    {
+      printf("invalid name '%s' was found\n", invalid_names[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool check_cursor_resume()
+{
+  uint8_t cursor[MAX_CONFIGURATION_TREE_CURSOR_LENGTH];
+  uint8_t cursor_length = 0;
+  char name[CONFIG_NAME_BUFFER_LENGTH];
+  
+  // resume the traversal from the cursor after every leaf
+  for (size_t i = 0; i <= leaf_names.size(); i++)
+  {
+    ConfigurationTree tree;
+    ConfigurationTreeNode *leaf;
+    if (cursor_length == 0)
+      leaf = tree.FindFirstLeafNode(tree.GetRootNode());
+    else 
+      leaf = tree.SetCursor(cursor, cursor_length) ? tree.FindNextLeafNode(tree.GetRootNode()) : 0;
+    if (leaf == 0)
+    {
+      if (i == leaf_names.size())
+        return true;
+      printf("traversal resumed at leaf %zu ended early\n", i);
+      return false;
+    }
+    tree.GetFullName(leaf, name, sizeof(name));
+    if (i == leaf_names.size() || leaf_names[i] != name)
+    {
+      printf("traversal resumed at leaf %zu found %s\n", i, name);
+      return false;
+    }
+    cursor_length = tree.GetCursor(leaf, cursor, sizeof(cursor));
+    if (cursor_length == 0)
+    {
+      printf("no cursor for %s\n", name);
+      return false;
+    }
+  }
+  return false;
+}
+
+static void benchmark()
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint16_t repetition = 0; repetition < LOOKUP_REPETITIONS; repetition++)
+  {
+    for (size_t i = 0; i < leaf_names.size(); i++)
+    {
+      ConfigurationTree tree;
+      tree.FindNode(leaf_names[i].c_str());
+    }
+  }
+  double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  printf("%zu leaves, %.3f us per lookup\n", leaf_names.size(), elapsed_us / LOOKUP_REPETITIONS / leaf_names.size());
+  
+  start = std::chrono::steady_clock::now();
+  uint32_t num_leaves = 0;
+  for (uint16_t repetition = 0; repetition < TRAVERSAL_REPETITIONS; repetition++)
+  {
+    ConfigurationTree tree;
+    for (ConfigurationTreeNode *leaf = tree.FindFirstLeafNode(tree.GetRootNode()); leaf != 0; 
+        leaf = tree.FindNextLeafNode(tree.GetRootNode()))
+      num_leaves += 1;
+  }
+  elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  printf("%.1f us per full traversal (%u leaves)\n", elapsed_us / TRAVERSAL_REPETITIONS, num_leaves / TRAVERSAL_REPETITIONS);
+}
+
+int main()
+{
+  find_leaf_names();
+  if (leaf_names.empty() || !check_lookups() || !check_cursor_resume())
+    return 1;
+  benchmark();
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Device state and accessors referenced by the configuration tree schema. The 
+// config tree benchmark only resolves names so none of these are called.
+//
+
+#include "Device_InputSwitch.h"
+#include "Device_OutputSwitch.h"
+#include "Device_PwmOutput.h"
+#include "Device_Buzzer.h"
+#include "Device_Heater.h"
+#include "Device_Stepper.h"
+#include "Device_TemperatureSensor.h"
+
+uint8_t *Device_InputSwitch::input_switch_pins;
+Device_InputSwitch::InputSwitchInfoInternal *Device_InputSwitch::input_switch_info;
+uint8_t Device_InputSwitch::SetTriggerLevel(uint8_t device_number, bool trigger_level) { return 0; }
+uint8_t Device_InputSwitch::SetEnablePullup(uint8_t device_number, bool enable) { return 0; }
+bool Device_InputSwitch::GetEnablePullup(uint8_t device_number) { return false; }
+
+uint8_t *Device_OutputSwitch::output_switch_pins;
+
+uint8_t *Device_PwmOutput::pwm_output_pins;
+uint8_t Device_PwmOutput::soft_pwm_device_bitmask;
+uint8_t Device_PwmOutput::EnableSoftPwm(uint8_t device_number, bool enable) { return 0; }
+
+uint8_t *Device_Buzzer::buzzer_pins;
+
+uint8_t *Device_TemperatureSensor::temperature_sensor_pins;
+uint8_t *Device_TemperatureSensor::temperature_sensor_oversampling;
+Device_TemperatureSensor::FilterInfo *Device_TemperatureSensor::temperature_sensor_filter_info;
+Device_TemperatureSensor::ParametricThermistor **Device_TemperatureSensor::temperature_sensor_parametric;
+uint8_t Device_TemperatureSensor::SetType(uint8_t device_number, int16_t type) { return 0; }
+uint8_t Device_TemperatureSensor::SetOversampling(uint8_t device_number, uint8_t oversampling) { return 0; }
+uint8_t Device_TemperatureSensor::SetFilterMedian(uint8_t device_number, uint8_t window) { return 0; }
+uint8_t Device_TemperatureSensor::SetFilterTimeConstant(uint8_t device_number, uint8_t time_constant) { return 0; }
+uint8_t Device_TemperatureSensor::SetThermistorBeta(uint8_t device_number, float value) { return 0; }
+uint8_t Device_TemperatureSensor::SetThermistorR25(uint8_t device_number, float value) { return 0; }
+uint8_t Device_TemperatureSensor::SetThermistorShA(uint8_t device_number, float value) { return 0; }
+uint8_t Device_TemperatureSensor::SetThermistorShB(uint8_t device_number, float value) { return 0; }
+uint8_t Device_TemperatureSensor::SetThermistorShC(uint8_t device_number, float value) { return 0; }
+uint8_t Device_TemperatureSensor::SetPullupResistance(uint8_t device_number, float value) { return 0; }
+uint8_t Device_TemperatureSensor::SetSeriesResistance(uint8_t device_number, float value) { return 0; }
+
+Device_Heater::HeaterInfo *Device_Heater::heater_info_array;
+uint8_t Device_Heater::soft_pwm_device_bitmask;
+uint8_t Device_Heater::SetTempSensor(uint8_t device_number, uint8_t temp_sensor) { return 0; }
+uint8_t Device_Heater::SetPowerOnLevel(uint8_t device_number, uint8_t power) { return 0; }
+uint8_t Device_Heater::EnableSoftPwm(uint8_t device_number, bool enable) { return 0; }
+uint8_t Device_Heater::SetBangBangHysteresis(uint8_t device_number, uint8_t hysteresis) { return 0; }
+uint8_t Device_Heater::SetPidFunctionalRange(uint8_t device_number, uint8_t range) { return 0; }
+uint8_t Device_Heater::SetPidDefaultKp(uint8_t device_number, float value) { return 0; }
+uint8_t Device_Heater::SetPidDefaultKi(uint8_t device_number, float value) { return 0; }
+uint8_t Device_Heater::SetPidDefaultKd(uint8_t device_number, float value) { return 0; }
+uint8_t Device_Heater::SetRunawayPeriod(uint8_t device_number, uint8_t period) { return 0; }
+uint8_t Device_Heater::SetRunawayRise(uint8_t device_number, uint8_t temp_rise) { return 0; }
+uint8_t Device_Heater::SetRunawayDeviation(uint8_t device_number, uint8_t temp_range) { return 0; }
+uint8_t Device_Heater::SetPowerPriority(uint8_t device_number, uint8_t priority) { return 0; }
+uint8_t Device_Heater::GetPidAutotuneCycle(uint8_t device_number) { return 0; }
+float Device_Heater::GetPidAutotuneKp(uint8_t device_number) { return 0; }
+float Device_Heater::GetPidAutotuneKi(uint8_t device_number) { return 0; }
+float Device_Heater::GetPidAutotuneKd(uint8_t device_number) { return 0; }
+
+Device_Stepper::StepperInfoInternal *Device_Stepper::stepper_info_array;
+uint8_t Device_Stepper::SetEnableInvert(uint8_t device_number, bool value) { return 0; }
+bool Device_Stepper::GetEnableInvert(uint8_t device_number) { return false; }
+uint8_t Device_Stepper::SetDirectionInvert(uint8_t device_number, bool value) { return 0; }
+bool Device_Stepper::GetDirectionInvert(uint8_t device_number) { return false; }
+uint8_t Device_Stepper::SetStepInvert(uint8_t device_number, bool value) { return 0; }
+bool Device_Stepper::GetStepInvert(uint8_t device_number) { return false; }
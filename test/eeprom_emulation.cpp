@@ -0,0 +1,63 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "eeprom_emulation.h"
+
+uint8_t eeprom_contents[EEPROM_EMULATION_SIZE];
+uint32_t eeprom_cell_writes[EEPROM_EMULATION_SIZE];
+uint32_t eeprom_total_writes = 0;
+int32_t eeprom_writes_until_power_failure = -1;
+
+uint8_t eeprom_read_byte(const uint8_t *address)
+{
+  return eeprom_contents[(uintptr_t)address];
+}
+
+void eeprom_write_byte(uint8_t *address, uint8_t value)
+{
+  if (eeprom_writes_until_power_failure == 0)
+    throw EepromPowerFailure();
+  if (eeprom_writes_until_power_failure > 0)
+    eeprom_writes_until_power_failure -= 1;
+  eeprom_contents[(uintptr_t)address] = value;
+  eeprom_cell_writes[(uintptr_t)address] += 1;
+  eeprom_total_writes += 1;
+}
+
+void eeprom_emulation_erase()
+{
+  memset(eeprom_contents, 0xFF, sizeof(eeprom_contents));
+  eeprom_emulation_clear_write_counts();
+}
+
+void eeprom_emulation_clear_write_counts()
+{
+  memset(eeprom_cell_writes, 0, sizeof(eeprom_cell_writes));
+  eeprom_total_writes = 0;
+}
+
+uint32_t eeprom_emulation_max_cell_writes()
+{
+  uint32_t max_writes = 0;
+  for (uint16_t i = 0; i < EEPROM_EMULATION_SIZE; i++)
+  {
+    if (eeprom_cell_writes[i] > max_writes)
+      max_writes = eeprom_cell_writes[i];
+  }
+  return max_writes;
+}
@@ -0,0 +1,48 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Host emulation of the AVR EEPROM which counts the writes to each cell and can
+// simulate a power failure after a given number of writes.
+//
+
+#ifndef EEPROM_EMULATION_H
+#define EEPROM_EMULATION_H
+
+#include <stdint.h>
+#include <avr/eeprom.h>
+
+#define EEPROM_EMULATION_SIZE (E2END + 1)
+
+// thrown by eeprom_write_byte() when the power fails
+struct EepromPowerFailure
+{
+};
+
+extern uint8_t eeprom_contents[EEPROM_EMULATION_SIZE];
+extern uint32_t eeprom_cell_writes[EEPROM_EMULATION_SIZE];
+extern uint32_t eeprom_total_writes;
+
+// the number of writes which succeed before the power fails (-1 = never)
+extern int32_t eeprom_writes_until_power_failure;
+
+// erases the EEPROM and clears the write counts
+void eeprom_emulation_erase();
+void eeprom_emulation_clear_write_counts();
+uint32_t eeprom_emulation_max_cell_writes();
+
+#endif // EEPROM_EMULATION_H
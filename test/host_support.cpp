@@ -0,0 +1,79 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include "Arduino.h"
+#include "host_support.h"
+
+unsigned long host_time_ms = 0;
+
+volatile uint8_t SREG, MCUSR;
+volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR2;
+volatile uint16_t ADC, ADCW;
+volatile uint8_t TIMSK0, TIMSK1, TCCR0A, TCCR0B, TCCR1A, TCCR1B, TCNT0, OCR0B;
+volatile uint16_t TCNT1, OCR1A;
+volatile uint8_t host_usart0[6];
+
+unsigned long millis()
+{
+  return host_time_ms;
+}
+
+unsigned long micros()
+{
+  return host_time_ms * 1000;
+}
+
+void delay(unsigned long ms)
+{
+  host_time_ms += ms;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+  return LOW;
+}
+
+extern "C" char *ltoa(long value, char *s, int radix)
+{
+  sprintf(s, (radix == 16) ? "%lx" : "%ld", value);
+  return s;
+}
+
+extern "C" char *ultoa(unsigned long value, char *s, int radix)
+{
+  sprintf(s, (radix == 16) ? "%lx" : "%lu", value);
+  return s;
+}
+
+extern "C" char *itoa(int value, char *s, int radix)
+{
+  return ltoa(value, s, radix);
+}
+
+extern "C" char *utoa(unsigned value, char *s, int radix)
+{
+  return ultoa(value, s, radix);
+}
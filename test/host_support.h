@@ -0,0 +1,28 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Support for running firmware sources on the host (see stubs/Arduino.h)
+//
+
+#ifndef HOST_SUPPORT_H
+#define HOST_SUPPORT_H
+
+// the value returned by millis() (and micros() / 1000), advanced by the tests
+extern unsigned long host_time_ms;
+
+#endif // HOST_SUPPORT_H
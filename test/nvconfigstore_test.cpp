@@ -0,0 +1,295 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Host test and benchmark of the NVConfigStore EEPROM journal:
+//
+// - wear: the configuration snapshot is saved repeatedly (with one value changed 
+//   each time) while the journal is written and compacted in the background. The 
+//   largest number of bytes written by one save and the most writes to any single 
+//   EEPROM cell are reported (a store which updates values in place writes the 
+//   changed cell once per save).
+//
+// - power failure: random operations are interrupted after a random number of 
+//   EEPROM writes and after a restart each value must be either the old or the new 
+//   value (a snapshot may also be invalid, but never corrupt).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <string>
+
+#include "eeprom_emulation.h"
+
+// the store is included directly so that a restart can also reset its RAM state
+#include "NVConfigStore.cpp"
+
+#define WEAR_TEST_SAVES                 20000
+#define WEAR_TEST_STEPS_PER_SAVE        400 // main loop iterations between saves
+#define WEAR_TEST_MAX_CELL_WRITES       (WEAR_TEST_SAVES / 10)
+#define POWER_FAILURE_TEST_OPERATIONS   20000
+#define SNAPSHOT_TEST_LENGTH            300
+
+struct ExpectedContents
+{
+  std::map<uint16_t, std::string> device_names; // key is (device type << 8) | device number
+  std::map<uint8_t, uint8_t> pin_states; // pins which are not high impedance
+  std::string snapshot;
+};
+
+static ExpectedContents expected;
+
+static void restart_store()
+{
+  pending_write_count = 0;
+  compacting = false;
+  snapshot_chunk_number = 0xFF;
+  NVConfigStore::Initialize();
+}
+
+static bool check_store(const char *stage, bool report)
+{
+  char name[MAX_DEVICE_NAME_LENGTH + 1];
+  for (std::map<uint16_t, std::string>::const_iterator it = expected.device_names.begin(); 
+      it != expected.device_names.end(); ++it)
+  {
+    int8_t length = NVConfigStore::GetDeviceName(it->first >> 8, it->first & 0xFF, name, sizeof(name));
+    name[(length > 0) ? length : 0] = '\0';
+    if (it->second != name)
+    {
+      if (report)
+        printf("%s: device name %04x is '%s' (expected '%s')\n", stage, it->first, name, it->second.c_str());
+      return false;
+    }
+  }
+  
+  for (uint8_t pin = 0; pin < NUM_DIGITAL_PINS; pin++)
+  {
+    const uint8_t state = expected.pin_states.count(pin) ? expected.pin_states[pin] : INITIAL_PIN_STATE_HIGHZ;
+    if (NVConfigStore::GetInitialPinState(pin) != state)
+    {
+      if (report)
+        printf("%s: initial state of pin %d\n", stage, pin);
+      return false;
+    }
+  }
+  uint8_t index = 0, state;
+  size_t num_pin_states = 0;
+  while (NVConfigStore::GetNextInitialPinState(&index, &state) != 0xFF)
+    num_pin_states += 1;
+  if (num_pin_states != expected.pin_states.size())
+  {
+    if (report)
+      printf("%s: %zu initial pin states (expected %zu)\n", stage, num_pin_states, expected.pin_states.size());
+    return false;
+  }
+  
+  const uint16_t length = NVConfigStore::GetConfigSnapshotLength();
+  if (length != expected.snapshot.size())
+  {
+    if (report)
+      printf("%s: snapshot length %d (expected %zu)\n", stage, length, expected.snapshot.size());
+    return false;
+  }
+  std::string snapshot(length, '\0');
+  for (uint16_t offset = 0; offset < length; offset += 7)
+    NVConfigStore::ReadConfigSnapshot(offset, (uint8_t *)&snapshot[offset], min(7, length - offset));
+  if (snapshot != expected.snapshot)
+  {
+    if (report)
+      printf("%s: snapshot contents\n", stage);
+    return false;
+  }
+  return true;
+}
+
+static void save_snapshot(const std::string &snapshot)
+{
+  // written in small pieces (as generate_configuration_snapshot does)
+  NVConfigStore::CommitConfigSnapshot(0, 0);
+  for (uint16_t offset = 0; offset < snapshot.size(); offset += 5)
+    NVConfigStore::WriteConfigSnapshot(offset, (const uint8_t *)&snapshot[offset], min(5, snapshot.size() - offset));
+  NVConfigStore::CommitConfigSnapshot(snapshot.size(), 0x1234);
+}
+
+static void initialize_store()
+{
+  eeprom_emulation_erase();
+  restart_store();
+  
+  char name[MAX_DEVICE_NAME_LENGTH + 1];
+  for (uint8_t i = 0; i < 20; i++)
+  {
+    sprintf(name, "dev%d", i);
+    const uint16_t key = ((1 + i % 7) << 8) | i;
+    expected.device_names[key] = name;
+    NVConfigStore::SetDeviceName(key >> 8, key & 0xFF, name);
+  }
+  for (uint8_t pin = 2; pin < 12; pin++)
+  {
+    expected.pin_states[pin] = INITIAL_PIN_STATE_LOW;
+    NVConfigStore::SetInitialPinState(pin, INITIAL_PIN_STATE_LOW);
+  }
+  expected.snapshot.resize(SNAPSHOT_TEST_LENGTH);
+  for (uint16_t i = 0; i < SNAPSHOT_TEST_LENGTH; i++)
+    expected.snapshot[i] = i * 7;
+  save_snapshot(expected.snapshot);
+  NVConfigStore::Flush();
+}
+
+static bool run_wear_test()
+{
+  eeprom_emulation_clear_write_counts();
+  uint32_t max_save_writes = 0;
+  
+  for (uint16_t i = 0; i < WEAR_TEST_SAVES; i++)
+  {
+    expected.snapshot[(i * 13) % SNAPSHOT_TEST_LENGTH] ^= 0x5A; // one value changes per save
+    
+    const uint32_t writes_before = eeprom_total_writes + pending_write_count;
+    save_snapshot(expected.snapshot);
+    NVConfigStore::SetConfigHash(i);
+    const uint32_t save_writes = eeprom_total_writes + pending_write_count - writes_before;
+    if (save_writes > max_save_writes)
+      max_save_writes = save_writes;
+    
+    for (uint16_t step = 0; step < WEAR_TEST_STEPS_PER_SAVE; step++)
+      NVConfigStore::WritePendingData();
+      
+    if (i % 1000 == 0)
+    {
+      NVConfigStore::Flush();
+      restart_store();
+      if (!check_store("wear", true))
+        return false;
+      if (NVConfigStore::GetConfigHash() != i)
+      {
+        printf("wear: config hash %d (expected %d)\n", NVConfigStore::GetConfigHash(), i);
+        return false;
+      }
+    }
+  }
+  
+  const uint32_t max_cell_writes = eeprom_emulation_max_cell_writes();
+  printf("wear: most bytes written by one save: %u\n", max_save_writes);
+  printf("wear: %d saves made %u byte writes, most writes to one cell: %u\n", 
+      WEAR_TEST_SAVES, eeprom_total_writes, max_cell_writes);
+  if (max_cell_writes > WEAR_TEST_MAX_CELL_WRITES)
+  {
+    printf("wear: more than %d writes to one cell\n", WEAR_TEST_MAX_CELL_WRITES);
+    return false;
+  }
+  return true;
+}
+
+static void apply_random_operation(uint8_t operation)
+{
+  if (operation == 0)
+  {
+    std::map<uint16_t, std::string>::iterator it = expected.device_names.begin();
+    std::advance(it, rand() % expected.device_names.size());
+    char name[MAX_DEVICE_NAME_LENGTH + 1];
+    sprintf(name, "n%d", rand() % 100000);
+    it->second = name;
+    NVConfigStore::SetDeviceName(it->first >> 8, it->first & 0xFF, name);
+  }
+  else if (operation == 1)
+  {
+    const uint8_t pin = 2 + rand() % 20;
+    const uint8_t state = (rand() % 2) ? INITIAL_PIN_STATE_HIGHZ : INITIAL_PIN_STATE_HIGH;
+    if (state == INITIAL_PIN_STATE_HIGHZ)
+      expected.pin_states.erase(pin);
+    else
+      expected.pin_states[pin] = state;
+    NVConfigStore::SetInitialPinState(pin, state);
+  }
+  else
+  {
+    expected.snapshot[rand() % SNAPSHOT_TEST_LENGTH] = rand();
+    save_snapshot(expected.snapshot);
+  }
+  for (uint16_t step = rand() % 300; step > 0; step--)
+    NVConfigStore::WritePendingData();
+  NVConfigStore::Flush();
+}
+
+static bool run_power_failure_test()
+{
+  uint16_t num_failures = 0;
+  srand(1);
+  
+  for (uint16_t i = 0; i < POWER_FAILURE_TEST_OPERATIONS; i++)
+  {
+    const uint8_t operation = rand() % 3;
+    const ExpectedContents old_contents = expected;
+    
+    eeprom_writes_until_power_failure = rand() % 200;
+    try
+    {
+      apply_random_operation(operation);
+      eeprom_writes_until_power_failure = -1;
+    }
+    catch (EepromPowerFailure &)
+    {
+      eeprom_writes_until_power_failure = -1;
+      num_failures += 1;
+      restart_store();
+      
+      // the interrupted operation may or may not have completed
+      if (!check_store("power failure", false))
+      {
+        expected = old_contents;
+        if (operation == 2 && NVConfigStore::GetConfigSnapshotLength() == 0)
+          expected.snapshot.clear(); // an interrupted snapshot may be discarded
+        if (!check_store("power failure", true))
+        {
+          printf("power failure: operation %d failed to recover (test %d)\n", operation, i);
+          return false;
+        }
+      }
+      if (expected.snapshot.empty())
+      {
+        expected.snapshot.assign(SNAPSHOT_TEST_LENGTH, 1);
+        save_snapshot(expected.snapshot);
+        NVConfigStore::Flush();
+      }
+      continue;
+    }
+    
+    if (!check_store("cached", true))
+      return false;
+    restart_store();
+    if (!check_store("restart", true))
+      return false;
+  }
+  printf("power failure: %d interrupted operations recovered\n", num_failures);
+  return true;
+}
+
+int main()
+{
+  initialize_store();
+  restart_store();
+  if (!check_store("initialize", true))
+    return 1;
+  if (!run_wear_test())
+    return 1;
+  if (!run_power_failure_test())
+    return 1;
+  return 0;
+}
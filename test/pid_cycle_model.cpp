@@ -0,0 +1,283 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Host cycle count model of the heater control pipeline (sensor conversion and 
+// PID) with float temperatures (as used before temperature_t) and with the fixed 
+// point temperatures and PID used by the firmware.
+//
+// There is no AVR simulator in the host build, so the arithmetic operations of 
+// each pipeline are counted and weighted with approximate avr-gcc/libgcc cycle 
+// costs for an ATmega (hardware 8x8 multiplier, no FPU). Both pipelines control 
+// a simulated 40W hotend for 600 seconds (200C, then 215C half way) and the 
+// average cycles per heater update and the largest difference between the two 
+// simulated hotend temperatures are reported.
+//
+
+#include <stdio.h>
+#include <math.h>
+
+#include "Device_Heater.h"
+#include "thermistortables.h"
+
+#define SIMULATION_TIME           600.0   // seconds
+#define FIRST_TARGET              200     // degrees C, then after half the time
+#define SECOND_TARGET             215     // degrees C
+#define SAMPLING_PERIOD           0.00707 // 4 sensors x 17 conversions x 104us
+#define MAX_HOTEND_DIVERGENCE     0.5     // degrees C (the 1/16 degree steps of temperature_t
+                                          // shift the trajectories while heating)
+#define MAX_SETTLED_ERROR         0.25    // degrees C from the target at the end
+
+// approximate AVR cycle costs of the operations
+#define CYCLES_FLOAT_ADD          110
+#define CYCLES_FLOAT_MUL          150
+#define CYCLES_FLOAT_CMP          50
+#define CYCLES_INT_TO_FLOAT       70
+#define CYCLES_FLOAT_TO_INT       80
+#define CYCLES_MUL32              60
+#define CYCLES_ADD32              4
+#define CYCLES_CMP32              4
+#define CYCLES_SHIFT32            12
+#define CYCLES_ADD16              2
+#define CYCLES_CMP16              2
+#define CYCLES_PGM_READ_WORD      6
+#define CYCLES_PGM_READ_DWORD     12
+
+static uint32_t cycles = 0;
+
+// a float which counts the cycles of its operations
+struct CountedFloat
+{
+  float value;
+  CountedFloat(float v = 0) : value(v) {}
+};
+
+static CountedFloat operator+(CountedFloat a, CountedFloat b) { cycles += CYCLES_FLOAT_ADD; return a.value + b.value; }
+static CountedFloat operator-(CountedFloat a, CountedFloat b) { cycles += CYCLES_FLOAT_ADD; return a.value - b.value; }
+static CountedFloat operator*(CountedFloat a, CountedFloat b) { cycles += CYCLES_FLOAT_MUL; return a.value * b.value; }
+static bool operator>(CountedFloat a, CountedFloat b) { cycles += CYCLES_FLOAT_CMP; return a.value > b.value; }
+static bool operator<(CountedFloat a, CountedFloat b) { cycles += CYCLES_FLOAT_CMP; return a.value < b.value; }
+static bool operator>=(CountedFloat a, CountedFloat b) { cycles += CYCLES_FLOAT_CMP; return a.value >= b.value; }
+static bool operator<=(CountedFloat a, CountedFloat b) { cycles += CYCLES_FLOAT_CMP; return a.value <= b.value; }
+
+static CountedFloat int_to_float(int32_t value) { cycles += CYCLES_INT_TO_FLOAT; return (float)value; }
+static int32_t float_to_int(CountedFloat value) { cycles += CYCLES_FLOAT_TO_INT; return (int32_t)value.value; }
+static int32_t mul32(int32_t a, int32_t b) { cycles += CYCLES_MUL32; return a * b; }
+static int32_t shift_right32(int32_t value, uint8_t bits) { cycles += CYCLES_SHIFT32; return value >> bits; }
+
+// the type 1 thermistor table is used by both pipelines
+static const ThermistorSegment *segments = thermistor_segments_1;
+static const uint8_t *segment_index = thermistor_index_1;
+static const uint8_t num_segments = NUM_ARRAY_ELEMENTS(thermistor_segments_1);
+
+// the indexed segment conversion in 16.16 fixed point degrees
+static int32_t convert_raw_value(uint16_t raw_value)
+{
+  uint8_t i = segment_index[raw_value >> THERMISTOR_INDEX_SHIFT];
+  cycles += CYCLES_PGM_READ_WORD;
+  while (i < num_segments - 1 && segments[i+1].raw <= (int16_t)raw_value)
+  {
+    cycles += CYCLES_PGM_READ_WORD + CYCLES_CMP16;
+    i++;
+  }
+  cycles += CYCLES_CMP16 + 2 * CYCLES_PGM_READ_WORD + CYCLES_PGM_READ_DWORD + CYCLES_ADD16 + CYCLES_ADD32;
+  return ((int32_t)segments[i].temp << 16) + mul32(segments[i].slope, (int16_t)raw_value - segments[i].raw);
+}
+
+// the raw value the sensor reads at a temperature (not counted)
+static uint16_t temperature_to_raw_value(double temp)
+{
+  for (uint16_t raw_value = THERMISTOR_RAW_HI_TEMP; raw_value < THERMISTOR_RAW_LO_TEMP; raw_value++)
+  {
+    uint8_t i = 0;
+    while (i < num_segments - 1 && segments[i+1].raw <= (int16_t)raw_value)
+      i++;
+    if (segments[i].temp + segments[i].slope / 65536.0 * (raw_value - segments[i].raw) <= temp)
+      return raw_value;
+  }
+  return THERMISTOR_RAW_LO_TEMP;
+}
+
+// a 40W hotend with a first order loss to a 25 degree ambient and a thermistor 
+// which lags the heater block by a few seconds
+struct Hotend
+{
+  double block_temp, temp;
+  Hotend() : block_temp(25.0), temp(25.0) {}
+  void Step(uint8_t power, double dt) 
+  { 
+    block_temp += dt * (power / 255.0 * 40.0 - (block_temp - 25.0) * 0.2) / 12.0; 
+    temp += dt * (block_temp - temp) / 3.0;
+  }
+};
+
+static const float Kp = 22.2, Ki = 1.08, Kd = 114, K1 = DEFAULT_PID_K1;
+static const uint8_t functional_range = 10;
+
+// the float PID used before temperature_t
+struct FloatPid
+{
+  CountedFloat iState, dTerm, last_temp;
+  CountedFloat Ki_dT, KdK2, iState_max;
+  FloatPid() : iState(0), dTerm(0), last_temp(25)
+  {
+    Ki_dT = Ki * SAMPLING_PERIOD;
+    KdK2 = Kd / SAMPLING_PERIOD * (1 - K1);
+    iState_max = 255 / Ki_dT.value;
+  }
+  
+  uint8_t Update(temperature_t target, uint16_t raw_value)
+  {
+    const CountedFloat target_temp = target / (float)TEMPERATURE_ONE_DEGREE;
+    const CountedFloat current_temp = int_to_float(convert_raw_value(raw_value)) * CountedFloat(1.0 / 65536.0);
+    cycles += 2 * CYCLES_FLOAT_CMP; // invalid and max temperature checks
+    uint8_t power;
+    const CountedFloat error = target_temp - current_temp;
+    if (error > CountedFloat(functional_range))
+    {
+      power = 255;
+      iState = 0;
+    }
+    else if (error < CountedFloat(-functional_range))
+    {
+      power = 0;
+      iState = 0;
+    }
+    else
+    {
+      iState = iState + error;
+      if (iState > iState_max)
+        iState = iState_max;
+      else if (iState < CountedFloat(0))
+        iState = 0;
+      dTerm = (current_temp - last_temp) * KdK2 + CountedFloat(K1) * dTerm;
+      const CountedFloat output = CountedFloat(Kp) * error + Ki_dT * iState - dTerm;
+      if (output >= CountedFloat(255))
+        power = 255;
+      else if (output <= CountedFloat(0))
+        power = 0;
+      else
+        power = float_to_int(output);
+    }
+    last_temp = current_temp;
+    return power;
+  }
+};
+
+// the fixed point PID of Device_Heater::UpdateHeaters
+struct FixedPid
+{
+  int32_t Kp_fixed, Ki_fixed, KdK2_fixed;
+  uint16_t K1_fixed;
+  int32_t iState, dTerm, iState_max;
+  temperature_t last_temp;
+  FixedPid() : iState(0), dTerm(0), last_temp(DEGREES_TO_TEMPERATURE(25))
+  {
+    const float output_scale = (float)(1L << PID_OUTPUT_FRACTION_BITS) / TEMPERATURE_ONE_DEGREE;
+    const float integral_scale = (float)(1L << PID_INTEGRAL_FRACTION_BITS) / TEMPERATURE_ONE_DEGREE;
+    Kp_fixed = lround(Kp * output_scale);
+    Ki_fixed = lround(Ki * SAMPLING_PERIOD * integral_scale);
+    KdK2_fixed = lround(Kd * (1 - K1) / SAMPLING_PERIOD * output_scale);
+    K1_fixed = lround(K1 * 65536);
+    iState_max = 255L << PID_INTEGRAL_FRACTION_BITS;
+  }
+  
+  uint8_t Update(temperature_t target, uint16_t raw_value)
+  {
+    const temperature_t current_temp = shift_right32(convert_raw_value(raw_value) 
+        + (1L << (15 - TEMPERATURE_FRACTION_BITS)), 16 - TEMPERATURE_FRACTION_BITS);
+    cycles += 2 * CYCLES_CMP16; // invalid and max temperature checks
+    uint8_t power;
+    const int16_t range = (int16_t)functional_range << TEMPERATURE_FRACTION_BITS;
+    const int16_t error = target - current_temp;
+    cycles += CYCLES_ADD16 + 2 * CYCLES_CMP16;
+    if (error > range)
+    {
+      power = 255;
+      iState = 0;
+    }
+    else if (error < -range)
+    {
+      power = 0;
+      iState = 0;
+    }
+    else
+    {
+      iState += mul32(Ki_fixed, error);
+      cycles += CYCLES_ADD32 + 2 * CYCLES_CMP32;
+      if (iState > iState_max)
+        iState = iState_max;
+      else if (iState < 0)
+        iState = 0;
+        
+      const int16_t temp_change = current_temp - last_temp;
+      cycles += CYCLES_ADD16 + 2 * CYCLES_CMP16;
+      int32_t d = mul32(KdK2_fixed, temp_change) + shift_right32(mul32(shift_right32(dTerm, 8), K1_fixed), 8);
+      cycles += CYCLES_ADD32 + 2 * CYCLES_CMP32;
+      if (d > PID_MAX_DTERM)
+        d = PID_MAX_DTERM;
+      else if (d < -PID_MAX_DTERM)
+        d = -PID_MAX_DTERM;
+      dTerm = d;
+      
+      const int32_t output = shift_right32(mul32(Kp_fixed, error) 
+          + shift_right32(iState, PID_INTEGRAL_FRACTION_BITS - PID_OUTPUT_FRACTION_BITS) - dTerm, 
+          PID_OUTPUT_FRACTION_BITS);
+      cycles += 2 * CYCLES_ADD32 + 2 * CYCLES_CMP32;
+      power = (output >= 255) ? 255 : ((output <= 0) ? 0 : output);
+    }
+    last_temp = current_temp;
+    return power;
+  }
+};
+
+int main()
+{
+  Hotend float_hotend, fixed_hotend;
+  FloatPid float_pid;
+  FixedPid fixed_pid;
+  uint64_t float_cycles = 0, fixed_cycles = 0;
+  uint32_t num_updates = 0;
+  double max_divergence = 0;
+  
+  for (double t = 0; t < SIMULATION_TIME; t += SAMPLING_PERIOD, num_updates++)
+  {
+    const temperature_t target = DEGREES_TO_TEMPERATURE((t < SIMULATION_TIME / 2) ? FIRST_TARGET : SECOND_TARGET);
+    
+    cycles = 0;
+    float_hotend.Step(float_pid.Update(target, temperature_to_raw_value(float_hotend.temp)), SAMPLING_PERIOD);
+    float_cycles += cycles;
+    
+    cycles = 0;
+    fixed_hotend.Step(fixed_pid.Update(target, temperature_to_raw_value(fixed_hotend.temp)), SAMPLING_PERIOD);
+    fixed_cycles += cycles;
+    
+    if (fabs(float_hotend.temp - fixed_hotend.temp) > max_divergence)
+      max_divergence = fabs(float_hotend.temp - fixed_hotend.temp);
+  }
+  
+  printf("%u heater updates: float %.0f cycles per update, fixed point %.0f cycles per update (%.1fx)\n", 
+      num_updates, (double)float_cycles / num_updates, (double)fixed_cycles / num_updates, 
+      (double)float_cycles / fixed_cycles);
+  printf("hotend temperature: float %.2f C, fixed point %.2f C, max divergence %.2f C\n", 
+      float_hotend.temp, fixed_hotend.temp, max_divergence);
+  
+  if (max_divergence > MAX_HOTEND_DIVERGENCE || fixed_cycles >= float_cycles
+      || fabs(fixed_hotend.temp - SECOND_TARGET) > MAX_SETTLED_ERROR)
+    return 1;
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Host replacement for the ATmega2560 register definitions. The registers are 
+// plain variables (defined in host_support.cpp) so the firmware headers compile.
+//
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#define __AVR_ATmega2560__ 1
+#define F_CPU 16000000L
+#define RAMEND 0x21FF
+
+#define _BV(b) (1 << (b))
+#define _SFR_BYTE(sfr) (sfr)
+
+extern volatile uint8_t SREG, MCUSR;
+extern volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR2;
+extern volatile uint16_t ADC, ADCW;
+extern volatile uint8_t TIMSK0, TIMSK1, TCCR0A, TCCR0B, TCCR1A, TCCR1B, TCNT0, OCR0B;
+extern volatile uint16_t TCNT1, OCR1A;
+
+enum { ADEN = 7, ADSC = 6, ADATE = 5, ADIF = 4, ADIE = 3, ADPS2 = 2, ADPS1 = 1, ADPS0 = 0 };
+enum { MUX5 = 3, REFS0 = 6, REFS1 = 7, ADLAR = 5 };
+enum { OCIE0B = 2, OCIE1A = 1, CS10 = 0, CS11 = 1, CS12 = 2 };
+enum { WGM10 = 0, WGM11 = 1, WGM12 = 3, WGM13 = 4 };
+enum { COM1A0 = 6, COM1A1 = 7, COM1B0 = 4, COM1B1 = 5 };
+
+// USART 0 (macros as the firmware detects the ports with defined())
+extern volatile uint8_t host_usart0[6];
+#define UCSR0A host_usart0[0]
+#define UCSR0B host_usart0[1]
+#define UCSR0C host_usart0[2]
+#define UDR0   host_usart0[3]
+#define UBRR0H host_usart0[4]
+#define UBRR0L host_usart0[5]
+enum { RXEN0 = 4, TXEN0 = 3, RXCIE0 = 7, UDRIE0 = 5, U2X0 = 1, RXC0 = 7, UDRE0 = 5, TXC0 = 6 };
+
+#define TIMER1_COMPA_vect __vector_17
+#define TIMER0_COMPB_vect __vector_22
+#define USART0_RX_vect __vector_25
+#define USART0_UDRE_vect __vector_26
+#define ADC_vect __vector_29
+
+#endif // HOST_AVR_IO_H
@@ -0,0 +1,62 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Firmware state and functions used by the temperature sensor module which are
+// not part of the host tests (the interrupt handler, heaters, responses and debug
+// output).
+//
+
+#include "Minnow.h"
+#include "Device_TemperatureSensor.h"
+#include "Device_Heater.h"
+#include "response.h"
+
+volatile bool temp_meas_ready;
+
+uint8_t Device_TemperatureSensor::num_temperature_sensors = 0;
+uint8_t *Device_TemperatureSensor::temperature_sensor_pins;
+int8_t *Device_TemperatureSensor::temperature_sensor_types;
+uint16_t *Device_TemperatureSensor::temperature_sensor_isr_raw_values;
+uint16_t *Device_TemperatureSensor::temperature_sensor_raw_values;
+uint8_t *Device_TemperatureSensor::temperature_sensor_oversampling;
+
+void Device_Heater::UpdateSamplingPeriod()
+{
+}
+
+void Device_Heater::InvalidateRawThresholds()
+{
+}
+
+void generate_response_msg_addPGM(const char *msg_pstr)
+{
+}
+
+DebugSerial DSerial;
+
+DebugSerial::DebugSerial()
+{
+}
+
+void DebugSerial::flush()
+{
+}
+
+void DebugSerial::printSignedNumber(bool error, long n, uint8_t base)
+{
+}
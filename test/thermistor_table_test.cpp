@@ -0,0 +1,182 @@
+/*
+ Minnow Pacemaker client firmware.
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Host test and benchmark of the built-in thermistor table conversion.
+//
+// For every table, the indexed segment conversion used by the firmware 
+// (thermistortables_indexed.h) is compared with the original linear search and 
+// float interpolation of the source table (thermistortables.h) across the whole 
+// raw range. The largest difference, the number of segments walked after the index 
+// lookup (which is what the AVR cycle count depends on), the flash used by each 
+// table and the host time per conversion are reported.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+// the conversion is a static function of the sensor module
+#include "Device_TemperatureSensor.cpp"
+
+#define MAX_CONVERSION_DIFFERENCE   0.05 // degrees C (the fixed point conversion rounds to 1/16 degree)
+#define MAX_INDEX_WALK              8    // segments walked after the index lookup
+#define BENCHMARK_REPETITIONS       20
+
+struct ThermistorTableInfo
+{
+  int8_t type;
+  const int16_t (*table)[2];
+  uint8_t table_length;
+  const ThermistorSegment *segments;
+  uint8_t num_segments;
+  const uint8_t *index;
+  uint16_t index_length;
+};
+
+#define THERMISTOR_TABLE_INFO(_N) \
+  { _N, TT_NAME(_N), NUM_ARRAY_ELEMENTS(TT_NAME(_N)), TT_SEGMENTS(_N), \
+    NUM_ARRAY_ELEMENTS(TT_SEGMENTS(_N)), TT_INDEX(_N), NUM_ARRAY_ELEMENTS(TT_INDEX(_N)) }
+
+static const ThermistorTableInfo thermistor_tables[] = {
+  THERMISTOR_TABLE_INFO(1), THERMISTOR_TABLE_INFO(2), THERMISTOR_TABLE_INFO(3), 
+  THERMISTOR_TABLE_INFO(4), THERMISTOR_TABLE_INFO(5), THERMISTOR_TABLE_INFO(6), 
+  THERMISTOR_TABLE_INFO(7), THERMISTOR_TABLE_INFO(8), THERMISTOR_TABLE_INFO(9), 
+  THERMISTOR_TABLE_INFO(10), THERMISTOR_TABLE_INFO(51), THERMISTOR_TABLE_INFO(52), 
+  THERMISTOR_TABLE_INFO(55), THERMISTOR_TABLE_INFO(60), THERMISTOR_TABLE_INFO(71)
+};
+
+// the conversion used before the tables were indexed (derived from RepRap FiveD 
+// extruder::getTemperature())
+static float linear_search_conversion(const ThermistorTableInfo &info, uint16_t raw_value)
+{
+  if (raw_value < THERMISTOR_RAW_HI_TEMP || raw_value > THERMISTOR_RAW_LO_TEMP) 
+    return NAN;
+  
+  const int16_t (*tt)[2] = info.table;
+  uint8_t i;
+  for (i = 1; i < info.table_length; i++)
+  {
+    if (tt[i][0] > (int16_t)raw_value)
+    {
+      return tt[i-1][1] + (raw_value - tt[i-1][0]) * 
+          (float)(tt[i][1] - tt[i-1][1]) / (float)(tt[i][0] - tt[i-1][0]);
+    }
+  }
+  return tt[i-1][1];
+}
+
+// the number of segments the indexed conversion walks past after the index lookup
+static uint8_t index_walk_length(const ThermistorTableInfo &info, uint16_t raw_value)
+{
+  const uint8_t first = info.index[raw_value >> THERMISTOR_INDEX_SHIFT];
+  uint8_t i = first;
+  while (i < info.num_segments - 1 && info.segments[i+1].raw <= (int16_t)raw_value)
+    i++;
+  return i - first;
+}
+
+static bool check_table(const ThermistorTableInfo &info)
+{
+  double max_difference = 0;
+  uint8_t max_walk = 0;
+  uint32_t total_walk = 0;
+  
+  for (uint16_t raw_value = 0; raw_value < 1024 * OVERSAMPLENR; raw_value++)
+  {
+    const float expected = linear_search_conversion(info, raw_value);
+    const temperature_t temp = convert_raw_temp_value(info.type, raw_value);
+    if (isnan(expected))
+    {
+      if (temp != SENSOR_TEMPERATURE_INVALID)
+      {
+        printf("type %d: raw %d should be invalid\n", info.type, raw_value);
+        return false;
+      }
+      continue;
+    }
+      
+    const double difference = fabs(TEMPERATURE_TO_DEGREES(temp) - expected);
+    if (difference > max_difference)
+      max_difference = difference;
+    
+    const uint8_t walk = index_walk_length(info, raw_value);
+    if (walk > max_walk)
+      max_walk = walk;
+    total_walk += walk;
+  }
+  
+  const uint16_t table_bytes = info.table_length * sizeof(info.table[0]);
+  const uint16_t indexed_bytes = info.num_segments * sizeof(ThermistorSegment) + info.index_length;
+  printf("type %2d: max difference %.3f C, segments walked max %d avg %.2f, flash %4d bytes (was %3d)\n",
+      info.type, max_difference, max_walk, 
+      (double)total_walk / (THERMISTOR_RAW_LO_TEMP - THERMISTOR_RAW_HI_TEMP + 1), indexed_bytes, table_bytes);
+  
+  if (max_difference > MAX_CONVERSION_DIFFERENCE || max_walk > MAX_INDEX_WALK)
+  {
+    printf("type %d: conversion differs by more than %.2f C or walks more than %d segments\n", 
+        info.type, MAX_CONVERSION_DIFFERENCE, MAX_INDEX_WALK);
+    return false;
+  }
+  return true;
+}
+
+static void benchmark()
+{
+  volatile float sink_float = 0;
+  volatile temperature_t sink_temp = 0;
+  uint32_t num_conversions = 0;
+  
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint8_t repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++)
+  {
+    for (uint8_t t = 0; t < NUM_ARRAY_ELEMENTS(thermistor_tables); t++)
+    {
+      for (uint16_t raw_value = THERMISTOR_RAW_HI_TEMP; raw_value <= THERMISTOR_RAW_LO_TEMP; raw_value++)
+        sink_float = linear_search_conversion(thermistor_tables[t], raw_value);
+    }
+  }
+  const double linear_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  
+  start = std::chrono::steady_clock::now();
+  for (uint8_t repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++)
+  {
+    for (uint8_t t = 0; t < NUM_ARRAY_ELEMENTS(thermistor_tables); t++)
+    {
+      for (uint16_t raw_value = THERMISTOR_RAW_HI_TEMP; raw_value <= THERMISTOR_RAW_LO_TEMP; raw_value++)
+      {
+        sink_temp = convert_raw_temp_value(thermistor_tables[t].type, raw_value);
+        num_conversions += 1;
+      }
+    }
+  }
+  const double indexed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  
+  printf("host time per conversion: linear search %.1f ns, indexed %.1f ns\n", 
+      linear_ns / num_conversions, indexed_ns / num_conversions);
+}
+
+int main()
+{
+  for (uint8_t t = 0; t < NUM_ARRAY_ELEMENTS(thermistor_tables); t++)
+  {
+    if (!check_table(thermistor_tables[t]))
+      return 1;
+  }
+  benchmark();
+  return 0;
+}